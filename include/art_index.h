@@ -0,0 +1,191 @@
+#pragma once
+
+#include "cache_entry.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+/**
+ * 自适应基数树（Adaptive Radix Tree）
+ * 按键的字节逐层分支的有序索引，用作本地存储分片的可选键空间索引
+ *
+ * 设计特点：
+ * - 自适应节点：按子节点数量在4/16/48/256四种节点之间升级和降级，稀疏的层不浪费空间
+ * - 路径压缩：只有一个分支的连续字节合并保存在节点前缀里，共同前缀（如tenant:region:user:）只存一份
+ * - 叶子只保存从所在位置到键末尾的剩余字节，和条目分配在同一块内存里，不再单独分配键
+ * - 有序：按键的字节序遍历，前缀查询和前缀删除只访问前缀对应的子树
+ *
+ * 不是线程安全的，由调用方（本地存储的分片锁）保护
+ */
+class ArtIndex {
+public:
+    /**
+     * 遍历回调，返回false时停止遍历
+     */
+    using Visitor = std::function<bool(const std::string& key, CacheEntry& entry)>;
+
+    ArtIndex();
+    ~ArtIndex();
+
+    ArtIndex(const ArtIndex&) = delete;
+    ArtIndex& operator=(const ArtIndex&) = delete;
+
+    /**
+     * 查找条目
+     * @param key 缓存键
+     * @return 条目指针，不存在时为空
+     */
+    CacheEntry* find(const std::string& key);
+
+    /**
+     * 查找条目，不存在时插入一个默认构造的条目
+     * 插入不会移动其他已有条目
+     * @param key 缓存键
+     * @return 条目
+     */
+    CacheEntry& findOrInsert(const std::string& key);
+
+    /**
+     * 删除条目
+     * @param key 缓存键
+     * @return 键存在时返回true
+     */
+    bool erase(const std::string& key);
+
+    /**
+     * 按键的字节序遍历不小于start的键
+     * @param start 起始键（包含）
+     * @param visit 遍历回调，返回false时停止
+     * @return 遍历完所有键时返回true，被回调提前停止时返回false
+     */
+    bool forEachFrom(const std::string& start, const Visitor& visit);
+
+    /**
+     * 键数量
+     * @return 键数量
+     */
+    size_t size() const { return size_; }
+
+private:
+    struct Leaf;
+    struct Node;
+    struct Node4;
+    struct Node16;
+    struct Node48;
+    struct Node256;
+
+    uintptr_t root_;   // 根，最低位为1时指向叶子，为0时树为空
+    size_t size_;      // 键数量
+
+    // 子节点引用：叶子地址的最低位置1以便和内部节点区分
+    static bool isLeaf(uintptr_t ref) { return (ref & 1) != 0; }
+    static Leaf* asLeaf(uintptr_t ref) { return reinterpret_cast<Leaf*>(ref & ~uintptr_t(1)); }
+    static Node* asNode(uintptr_t ref) { return reinterpret_cast<Node*>(ref); }
+    static uintptr_t refOf(Leaf* leaf) { return reinterpret_cast<uintptr_t>(leaf) | 1; }
+    static uintptr_t refOf(Node* node) { return reinterpret_cast<uintptr_t>(node); }
+
+    /**
+     * 分配叶子，剩余键字节紧跟在叶子结构之后
+     * @param bytes 剩余键字节
+     * @param length 剩余键字节数
+     * @return 新叶子
+     */
+    static Leaf* newLeaf(const char* bytes, size_t length);
+
+    /**
+     * 释放叶子及其中的条目
+     * @param leaf 叶子
+     */
+    static void freeLeaf(Leaf* leaf);
+
+    /**
+     * 释放内部节点本身（不包括子节点和终止叶子）
+     * @param node 内部节点
+     */
+    static void freeNode(Node* node);
+
+    /**
+     * 释放整棵子树
+     * @param ref 子树的根
+     * @return 子树中的键数量
+     */
+    static size_t destroy(uintptr_t ref);
+
+    /**
+     * 设置节点的压缩前缀，不超过8字节时保存在节点内
+     * @param node 内部节点
+     * @param bytes 前缀字节，不能指向节点自身的前缀
+     * @param length 前缀字节数
+     */
+    static void setPrefix(Node* node, const char* bytes, size_t length);
+
+    /**
+     * 把前缀和终止叶子从旧节点转移到新节点
+     * @param from 旧节点
+     * @param to 新节点
+     */
+    static void moveHeader(Node* from, Node* to);
+
+    /**
+     * 查找子节点
+     * @param node 内部节点
+     * @param byte 分支字节
+     * @return 指向子节点引用的指针，不存在时为空
+     */
+    static uintptr_t* findChild(Node* node, uint8_t byte);
+
+    /**
+     * 添加子节点，节点已满时升级为更大的节点
+     * @param slot 指向该节点的引用，升级时被替换
+     * @param node 内部节点
+     * @param byte 分支字节
+     * @param child 子节点引用
+     */
+    static void addChild(uintptr_t& slot, Node* node, uint8_t byte, uintptr_t child);
+
+    /**
+     * 移除子节点，子节点数量过少时降级为更小的节点
+     * @param slot 指向该节点的引用，降级时被替换
+     * @param node 内部节点
+     * @param byte 分支字节
+     */
+    static void removeChild(uintptr_t& slot, Node* node, uint8_t byte);
+
+    /**
+     * 按分支字节从小到大列出子节点
+     * @param node 内部节点
+     * @param bytes 输出参数，分支字节，容量至少256
+     * @param children 输出参数，子节点引用，容量至少256
+     * @return 子节点数量
+     */
+    static size_t listChildren(Node* node, uint8_t* bytes, uintptr_t* children);
+
+    /**
+     * 删除键之后收缩节点：没有子节点时换成终止叶子或直接删除，
+     * 只剩一个子节点且没有终止叶子时与子节点合并
+     * @param slot 指向该节点的引用
+     */
+    static void compact(uintptr_t& slot);
+
+    /**
+     * 在子树中删除键
+     * @param slot 子树的根引用
+     * @param key 完整的键
+     * @param depth 子树根所在的深度（已经匹配的字节数）
+     * @return 键存在时返回true
+     */
+    static bool eraseAt(uintptr_t& slot, const std::string& key, size_t depth);
+
+    /**
+     * 有序遍历子树
+     * @param ref 子树的根
+     * @param path 输入输出参数，到子树根为止的键字节，返回时恢复原状
+     * @param start 起始键
+     * @param bounded 子树中是否可能有小于start的键
+     * @param visit 遍历回调
+     * @return 回调要求停止时返回false
+     */
+    static bool walk(uintptr_t ref, std::string& path, const std::string& start, bool bounded,
+                     const Visitor& visit);
+};
\ No newline at end of file
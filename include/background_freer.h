@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * 后台释放器
+ * 持锁的路径只把要释放的对象摘下来交给这里，由后台线程分批析构，
+ * 删除或覆盖一个大值的耗时不再取决于值有多大
+ *
+ * 设计特点：
+ * - 类型擦除：任何可移动的对象都可以交给后台析构（条目、整张表、整棵子树）
+ * - 分批：后台线程每次取走整个队列，在锁外逐个析构
+ * - 有界：排队对象超过上限时调用方直接就地释放，避免释放跟不上时内存无限增长
+ */
+class BackgroundFreer {
+public:
+    static constexpr size_t kMaxPending = 65536;   // 排队对象的上限
+
+    BackgroundFreer();
+
+    /**
+     * 析构时停止后台线程并释放队列中剩余的对象
+     */
+    ~BackgroundFreer();
+
+    BackgroundFreer(const BackgroundFreer&) = delete;
+    BackgroundFreer& operator=(const BackgroundFreer&) = delete;
+
+    /**
+     * 把对象交给后台线程析构
+     * @param object 要释放的对象，移入后由后台线程持有
+     */
+    template <typename T>
+    void retire(T&& object) {
+        push(std::shared_ptr<void>(new std::decay_t<T>(std::move(object))));
+    }
+
+    /**
+     * 等待后台释放的对象数量
+     * @return 对象数量
+     */
+    size_t pending() const { return pending_.load(std::memory_order_relaxed); }
+
+    /**
+     * 已经在后台释放的对象数量
+     * @return 对象数量
+     */
+    uint64_t freed() const { return freed_.load(std::memory_order_relaxed); }
+
+private:
+    std::mutex mutex_;                              // 保护queue_和stopping_
+    std::condition_variable cv_;                    // 有新对象或停止时唤醒后台线程
+    std::vector<std::shared_ptr<void>> queue_;      // 等待释放的对象
+    bool stopping_;                                 // 是否正在停止
+    std::atomic<size_t> pending_;                   // 等待释放的对象数量
+    std::atomic<uint64_t> freed_;                   // 已经释放的对象数量
+    std::thread thread_;                            // 后台释放线程
+
+    /**
+     * 把类型擦除后的对象加入队列
+     * @param garbage 要释放的对象
+     */
+    void push(std::shared_ptr<void> garbage);
+
+    /**
+     * 后台线程主循环
+     */
+    void run();
+};
\ No newline at end of file
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "hash_value.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/**
+ * 写入时指定的过期参数
+ * 全部为0表示永不过期
+ */
+struct EntryTtl {
+    int64_t ttl_ms;          // 硬过期时间（毫秒），到期后键视为不存在，0表示不过期
+    int64_t soft_ttl_ms;     // 软过期时间（毫秒），到期后读取返回旧值并要求一个调用方刷新，0表示与硬过期相同
+    int64_t recompute_ms;    // 预计刷新耗时（毫秒），决定提前刷新的概率，0表示取软过期时间的十分之一
+
+    EntryTtl() : ttl_ms(0), soft_ttl_ms(0), recompute_ms(0) {}
+};
+
+/**
+ * 读取时返回的元数据
+ */
+struct ReadMeta {
+    bool stale;         // 已超过软过期时间，值可能是旧的
+    bool refresh;       // 本次调用方被选中负责刷新
+    int64_t ttl_ms;     // 距硬过期的剩余毫秒，-1表示不过期
+    uint64_t version;   // 值的版本，用于比较并交换；0表示未知（值来自副本或近端缓存）
+
+    ReadMeta() : stale(false), refresh(false), ttl_ms(-1), version(0) {}
+};
+
+/**
+ * 读-改-写操作的结果
+ */
+enum class OpStatus {
+    Ok,            // 成功
+    NotFound,      // 键不存在
+    Conflict,      // 版本不匹配
+    Invalid,       // 值的类型或参数不合法（例如对非整数执行自增）
+    Unavailable,   // 负责节点无法访问
+    CrossNode      // 多键操作的键不属于同一个节点
+};
+
+/**
+ * 批量写入的前提条件
+ */
+enum class WriteCondition {
+    Always,        // 无条件写入
+    IfNoneExist,   // 所有键都不存在时才写入
+    IfAllExist     // 所有键都存在时才写入
+};
+
+/**
+ * 租约获取结果
+ * 键存在时found为true；否则token非0表示调用方获得了租约，应回源后用该租约写入；
+ * wait为true表示租约被他人持有，调用方应稍后重试或使用旧值
+ */
+struct LeaseResult {
+    bool found;          // 是否找到键值
+    std::string value;   // 当前值（found为true时）或旧值（stale为true时）
+    uint64_t token;      // 发放的租约，0表示没有获得租约
+    bool wait;           // 租约被他人持有
+    bool stale;          // value是否为最近删除的旧值
+
+    LeaseResult() : found(false), token(0), wait(false), stale(false) {}
+};
+
+/**
+ * 本地缓存条目
+ * 支持软、硬两级过期：硬过期后键不存在；软过期前后用XFetch算法概率性地选出一个调用方刷新，
+ * 其余调用方继续读到旧值，避免同时过期的键在同一时刻集中未命中
+ *
+ * XFetch：now + recompute * beta * (-ln(rand)) >= soft_expires_at 时触发刷新，
+ * 越接近软过期、刷新越慢，触发概率越高；超过软过期后必然触发
+ */
+struct CacheEntry {
+    static constexpr double kXFetchBeta = 1.0;                 // XFetch的beta参数，越大越倾向于提前刷新
+    static constexpr int64_t kMinClaimNanos = 1000000000LL;    // 刷新任务的最短领取期限：1秒
+
+    std::string value;              // 缓存值（字符串类型）
+    std::unique_ptr<HashValue> hash;   // 非空表示哈希类型，此时value不使用
+    uint64_t version;               // 版本，每次修改都会变化，0表示尚未分配
+    int64_t soft_expires_at;        // 软过期时间（steady_clock纳秒），0表示不过期
+    int64_t hard_expires_at;        // 硬过期时间（steady_clock纳秒），0表示不过期
+    int64_t recompute_ns;           // 预计刷新耗时（纳秒）
+    int64_t refresh_claimed_at;     // 刷新任务被领取的时间，0表示尚未领取
+    uint32_t accessed_at;           // 最近一次访问的时钟刻度（约1毫秒），供配额淘汰比较新旧
+
+    CacheEntry();
+
+    /**
+     * 按过期参数创建条目
+     * @param value 缓存值
+     * @param ttl 过期参数
+     * @param now 当前时间（steady_clock纳秒）
+     */
+    CacheEntry(const std::string& value, const EntryTtl& ttl, int64_t now);
+
+    /**
+     * 是否已经硬过期
+     * @param now 当前时间（steady_clock纳秒）
+     * @return 已硬过期时返回true
+     */
+    bool expired(int64_t now) const {
+        return hard_expires_at != 0 && now >= hard_expires_at;
+    }
+
+    /**
+     * 按字符串读取时的值，哈希类型序列化为JSON对象
+     * @return 值
+     */
+    std::string stringValue() const {
+        return hash ? hash->toJson() : value;
+    }
+
+    /**
+     * 计算读取时的过期状态
+     * @param now 当前时间（steady_clock纳秒）
+     * @param claim 是否允许本次读取领取刷新任务；同一时间只有一个调用方能领取
+     * @param meta 输出参数，过期状态
+     */
+    void inspect(int64_t now, bool claim, ReadMeta& meta);
+
+    /**
+     * 当前时间
+     * @return steady_clock纳秒
+     */
+    static int64_t nowNanos();
+
+    /**
+     * 访问时钟的刻度，约1毫秒，32位约52天回绕一次
+     * 比较新旧时用无符号减法求距今的刻度数，回绕不影响结果
+     * @param now 当前时间（steady_clock纳秒）
+     * @return 刻度
+     */
+    static uint32_t accessTick(int64_t now) {
+        return static_cast<uint32_t>(now >> 20);
+    }
+
+    /**
+     * 线程本地的(0, 1]均匀随机数
+     * @return 随机数
+     */
+    static double uniformRandom();
+};
\ No newline at end of file
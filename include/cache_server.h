@@ -5,10 +5,70 @@
 #include "consistent_hash.h"
 #include "grpc_client.h"
 #include "http_handler.h"
+#include "metrics.h"
+#include "hot_keys.h"
+#include "ttl_cache.h"
+#include "single_flight.h"
+#include "negative_cache.h"
+#include "cache_entry.h"
+#include "local_store.h"
+#include "core_engine.h"
 #include <unordered_map>
 #include <string>
+#include <vector>
 #include <memory>
 #include <mutex>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <chrono>
+#include <deque>
+
+/**
+ * 缓存服务器运行配置
+ * HTTP和gRPC使用相互独立的线程和并发配额，客户端HTTP流量过载时不会拖垮节点间的gRPC通信
+ */
+struct ServerOptions {
+    HttpLimits http;                    // HTTP准入控制配置
+    int grpc_max_threads;               // gRPC服务器可使用的最大线程数
+    int grpc_max_concurrent_streams;    // 每个gRPC连接允许的最大并发请求数
+    int hot_key_capacity;               // 热点键统计的计数槽数量
+    int hot_key_sample_rate;            // 热点键统计的采样率，每N次访问记录一次
+    bool hot_key_replication;           // 是否把本节点负责的热点键复制到其他节点
+    int replica_ttl_ms;                 // 热点副本的存活时间（毫秒）
+    int replication_interval_ms;        // 检测并推送热点副本的周期（毫秒）
+    int replica_min_count;              // 估算访问次数达到该值的键才会被复制
+    int replica_max_keys;               // 每轮最多复制的键数量
+    int replica_capacity;               // 本节点最多保存的其他节点副本数量
+    bool near_cache;                    // 是否缓存本节点转发读取到的其他节点的键
+    int near_cache_ttl_ms;              // 近端缓存条目的存活时间（毫秒）
+    int near_cache_capacity;            // 近端缓存最多保存的键数量
+    bool negative_cache;                // 是否记录转发读取确认不存在的键
+    int negative_cache_ttl_ms;          // 负缓存条目的存活时间（毫秒）
+    int negative_cache_capacity;        // 负缓存最多保存的键数量
+    int lease_ttl_ms;                   // 租约有效期（毫秒），期间同一个键不再发放新租约
+    int stale_ttl_ms;                   // 删除后的旧值保留时间（毫秒），供租约未命中时使用
+    int stale_capacity;                 // 最多保留的旧值数量
+    int store_shards;                   // 本地存储的分片数量，每个分片一把锁
+    bool store_art_index;               // 本地存储用自适应基数树代替哈希表索引键
+    int lazy_free_bytes;                // 值达到该字节数时删除和覆盖交给后台线程释放，0表示就地释放
+    std::string namespaces;             // 启动时创建的命名空间，格式为"名称=配额MB,..."，_default设置默认命名空间的配额
+    int thread_per_core;                // 每核一线程模式的核心线程数，0表示关闭；各线程独占一部分分片，单键操作交给所属线程执行
+    bool numa_bind;                     // 每核一线程模式下核心线程轮流分布到各NUMA节点，分片的内存分配在所属线程的节点上
+    int huge_pages;                     // 本地存储哈希表使用的大页大小（MB），2或1024，0表示不使用大页
+    
+    // 默认配置
+    ServerOptions() : grpc_max_threads(64), grpc_max_concurrent_streams(256),
+                      hot_key_capacity(256), hot_key_sample_rate(16),
+                      hot_key_replication(true), replica_ttl_ms(2000), replication_interval_ms(1000),
+                      replica_min_count(1000), replica_max_keys(32), replica_capacity(1024),
+                      near_cache(false), near_cache_ttl_ms(1000), near_cache_capacity(4096),
+                      negative_cache(false), negative_cache_ttl_ms(500), negative_cache_capacity(65536),
+                      lease_ttl_ms(10000), stale_ttl_ms(10000), stale_capacity(4096),
+                      store_shards(16), store_art_index(false), lazy_free_bytes(64 * 1024), thread_per_core(0),
+                      numa_bind(false), huge_pages(0) {}
+};
 
 /**
  * 分布式缓存服务器类
@@ -27,9 +87,10 @@ public:
      * @param host 服务器主机地址
      * @param grpc_port gRPC服务端口
      * @param http_port HTTP服务端口
+     * @param options 运行配置
      */
     CacheServer(const std::string& node_id, const std::string& host, 
-                int grpc_port, int http_port);
+                int grpc_port, int http_port, const ServerOptions& options = ServerOptions());
     
     /**
      * 析构函数，确保资源正确释放
@@ -52,17 +113,19 @@ public:
      * 获取缓存值
      * @param key 缓存键
      * @param value 输出参数，存储获取到的值
+     * @param meta 输出参数（可为空），值的过期状态；非空时本次读取可能被选中负责刷新
      * @return 是否成功获取
      */
-    bool get(const std::string& key, std::string& value);
+    bool get(const std::string& key, std::string& value, ReadMeta* meta = nullptr);
     
     /**
      * 设置缓存值
      * @param key 缓存键
      * @param value 要设置的值
+     * @param ttl 过期参数，默认永不过期
      * @return 是否成功设置
      */
-    bool set(const std::string& key, const std::string& value);
+    bool set(const std::string& key, const std::string& value, const EntryTtl& ttl = EntryTtl());
     
     /**
      * 删除缓存值
@@ -71,6 +134,208 @@ public:
      */
     bool del(const std::string& key);
     
+    /**
+     * 批量获取缓存值
+     * 按负责节点对键分组，每个节点只发送一次批量请求，并行等待各节点结果
+     * @param keys 缓存键列表
+     * @param on_batch 每个节点的结果到达时调用一次，调用之间互斥，可直接用于流式输出
+     */
+    void mget(const std::vector<std::string>& keys,
+              const std::function<void(const std::vector<KeyValueResult>&)>& on_batch);
+    
+    /**
+     * 设置读穿透加载函数
+     * 本节点负责的键在本地未命中时调用加载函数，加载到的值写入本地缓存后返回；
+     * 同一个键的并发未命中只调用一次加载函数。必须在start()之前设置，加载函数不应抛出异常
+     * @param loader 加载函数，参数为键和输出的值，返回是否加载到
+     */
+    void setLoader(std::function<bool(const std::string&, std::string&)> loader);
+    
+    /**
+     * 租约获取
+     * 键存在时返回当前值；未命中时第一个调用方获得租约，负责回源并用租约写入，
+     * 租约有效期内的其他调用方被告知等待，并在有旧值时拿到最近删除的旧值
+     * @param key 缓存键
+     * @param result 输出参数，存储租约获取结果
+     * @return 负责节点无法访问时返回false
+     */
+    bool leaseGet(const std::string& key, LeaseResult& result);
+    
+    /**
+     * 租约写入
+     * 只有租约仍然有效时才接受，键在租约发放后被写入或删除时租约失效
+     * @param key 缓存键
+     * @param value 缓存值
+     * @param token LeaseGet发放的租约
+     * @return 租约有效并已写入时返回true
+     */
+    bool leaseSet(const std::string& key, const std::string& value, uint64_t token);
+    
+    /**
+     * 原子自增
+     * 值按十进制整数解析，键不存在时视为0并创建，保留原有的过期时间
+     * @param key 缓存键
+     * @param delta 增量，可以为负
+     * @param result 输出参数，自增后的值
+     * @return Ok；值不是整数或运算溢出时返回Invalid；负责节点无法访问时返回Unavailable
+     */
+    OpStatus incr(const std::string& key, int64_t delta, int64_t& result);
+    
+    /**
+     * 比较并交换
+     * 键的当前版本等于期望版本时写入，写入的值不带过期时间
+     * @param key 缓存键
+     * @param value 要写入的值
+     * @param expected_version 期望的版本（get返回的版本），0表示要求键不存在
+     * @param version 输出参数，成功时为新版本，冲突时为当前版本（键不存在时为0）
+     * @return Ok、Conflict；负责节点无法访问时返回Unavailable
+     */
+    OpStatus compareAndSwap(const std::string& key, const std::string& value,
+                            uint64_t expected_version, uint64_t& version);
+    
+    /**
+     * 在值的末尾追加数据，键不存在时视为空值，保留原有的过期时间
+     * @param key 缓存键
+     * @param data 追加的数据
+     * @param length 输出参数，追加后的值长度
+     * @return Ok；超过长度上限时返回Invalid；负责节点无法访问时返回Unavailable
+     */
+    OpStatus append(const std::string& key, const std::string& data, size_t& length);
+    
+    /**
+     * 读取值的一段
+     * @param key 缓存键
+     * @param start 起始位置（包含），负数表示从末尾倒数
+     * @param end 结束位置（包含），负数表示从末尾倒数
+     * @param value 输出参数，读取到的片段，范围为空时为空串
+     * @param length 输出参数，完整值的长度
+     * @return 键存在时返回true
+     */
+    bool getRange(const std::string& key, int64_t start, int64_t end, std::string& value, size_t& length);
+    
+    /**
+     * 从offset开始覆盖写入数据，值不够长时先用零字节补齐，保留原有的过期时间
+     * @param key 缓存键
+     * @param offset 写入位置
+     * @param data 写入的数据
+     * @param length 输出参数，写入后的值长度
+     * @return Ok；超过长度上限时返回Invalid；负责节点无法访问时返回Unavailable
+     */
+    OpStatus setRange(const std::string& key, size_t offset, const std::string& data, size_t& length);
+    
+    /**
+     * 读取哈希字段
+     * @param key 缓存键
+     * @param fields 输入要读取的字段名，为空表示全部字段；输出各字段是否存在及字段值
+     * @return Ok；键不存在时返回NotFound；键不是哈希类型时返回Invalid；负责节点无法访问时返回Unavailable
+     */
+    OpStatus hashGet(const std::string& key, std::vector<FieldValue>& fields);
+    
+    /**
+     * 写入哈希字段，键不存在时创建，其余字段不动
+     * @param key 缓存键
+     * @param fields 要写入的字段
+     * @param added 输出参数，新增的字段数量
+     * @return Ok；键不是哈希类型时返回Invalid；负责节点无法访问时返回Unavailable
+     */
+    OpStatus hashSet(const std::string& key, const std::vector<FieldValue>& fields, size_t& added);
+    
+    /**
+     * 删除哈希字段，最后一个字段删除后键也被删除
+     * @param key 缓存键
+     * @param fields 要删除的字段名
+     * @param removed 输出参数，实际删除的字段数量
+     * @return Ok；键不存在时返回NotFound；键不是哈希类型时返回Invalid；负责节点无法访问时返回Unavailable
+     */
+    OpStatus hashDel(const std::string& key, const std::vector<std::string>& fields, size_t& removed);
+    
+    /**
+     * 原子地写入多个键，所有键必须属于同一个节点（通常用相同的哈希标签保证）
+     * @param entries 键值对
+     * @param ttl 过期参数，作用于所有键
+     * @param condition 写入的前提条件，不满足时一个键都不写
+     * @return Ok；条件不满足时返回Conflict；键跨越多个节点时返回CrossNode；
+     *         批量为空时返回Invalid；负责节点无法访问时返回Unavailable
+     */
+    OpStatus multiSet(const std::vector<std::pair<std::string, std::string>>& entries, const EntryTtl& ttl,
+                      WriteCondition condition);
+    
+    /**
+     * 原子地删除多个键，所有键必须属于同一个节点
+     * @param keys 要删除的键
+     * @param deleted 输出参数，实际删除的键数量
+     * @return Ok；键跨越多个节点时返回CrossNode；批量为空时返回Invalid；负责节点无法访问时返回Unavailable
+     */
+    OpStatus multiDel(const std::vector<std::string>& keys, size_t& deleted);
+    
+    /**
+     * 按游标分批遍历集群中的键，按节点ID顺序逐个节点遍历
+     * 游标格式为"节点ID:节点内游标"，节点下线后从ID更大的下一个节点继续
+     * @param cursor 游标，"0"表示从头开始
+     * @param count 本次最多检查的条目数
+     * @param match glob模式，为空时不过滤
+     * @param keys 输出参数，本次找到的键，可能为空但遍历尚未结束
+     * @param next 输出参数，下一次的游标，遍历结束时为"0"
+     * @return Ok；游标格式不正确时返回Invalid；当前节点无法访问时返回Unavailable
+     */
+    OpStatus scan(const std::string& cursor, size_t count, const std::string& match,
+                  std::vector<std::string>& keys, std::string& next);
+    
+    /**
+     * 按游标分批遍历本节点存储中的键
+     * @param cursor 游标，"0"表示从头开始
+     * @param count 本次最多检查的条目数
+     * @param match glob模式，为空时不过滤
+     * @param keys 输出参数，本次找到的键
+     * @param next 输出参数，下一次的游标，遍历结束时为"0"
+     * @return 游标格式不正确时返回false
+     */
+    bool scanLocal(const std::string& cursor, size_t count, const std::string& match,
+                   std::vector<std::string>& keys, std::string& next);
+    
+    /**
+     * 删除集群中所有匹配的键
+     * 向所有节点（包括本节点）提交后台删除任务后立即返回，各节点分批删除自己负责的键；
+     * 提交之后才写入的匹配键可能被保留
+     * @param match glob模式，为空时删除全部
+     * @param failed 输出参数，无法提交任务的节点ID
+     * @return Ok；有节点无法访问时返回Unavailable，其他节点上的任务照常执行
+     */
+    OpStatus deleteMatching(const std::string& match, std::vector<std::string>& failed);
+    
+    /**
+     * 在本节点提交按模式删除的后台任务，与排队中的相同模式合并
+     * @param match glob模式，为空时删除全部
+     */
+    void deleteMatchingLocal(const std::string& match);
+    
+    /**
+     * 在集群所有节点上创建、修改或删除命名空间
+     * 配额按节点计算，每个节点上该命名空间的键最多占用quota_bytes
+     * @param name 命名空间名称
+     * @param quota_bytes 每个节点上的内存配额（字节），0表示不限制
+     * @param remove 是否删除命名空间，删除后其中的键归入默认命名空间
+     * @param failed 输出参数，无法访问的节点ID
+     * @return Ok；名称不合法时返回Invalid；删除不存在的命名空间时返回NotFound；有节点无法访问时返回Unavailable
+     */
+    OpStatus configureNamespace(const std::string& name, uint64_t quota_bytes, bool remove,
+                                std::vector<std::string>& failed);
+    
+    /**
+     * 在本节点创建、修改或删除命名空间
+     * @param name 命名空间名称
+     * @param quota_bytes 内存配额（字节），0表示不限制
+     * @param remove 是否删除命名空间
+     * @return Ok；名称不合法时返回Invalid；删除不存在的命名空间时返回NotFound
+     */
+    OpStatus configureNamespaceLocal(const std::string& name, uint64_t quota_bytes, bool remove);
+    
+    /**
+     * 本节点各命名空间的统计
+     * @return 统计列表，默认命名空间在最前
+     */
+    std::vector<NamespaceStats> namespaceStats() { return store_->namespaceStats(); }
+    
     // 节点管理
     /**
      * 向集群添加节点
@@ -91,6 +356,32 @@ public:
      */
     const std::string& getNodeId() const { return node_id_; }
     
+    /**
+     * 以Prometheus文本格式输出本节点的缓存指标
+     * @return Prometheus文本
+     */
+    std::string renderMetrics();
+    
+    /**
+     * 以JSON格式输出本节点发往各个节点的gRPC调用概况
+     * @return JSON文本
+     */
+    std::string renderPeers();
+    
+    /**
+     * 获取本节点的热点键
+     * @param limit 最多返回的键数量
+     * @return 按估算访问次数从高到低排列的热点键
+     */
+    std::vector<HotKey> getHotKeys(size_t limit);
+    
+    /**
+     * 获取集群中每个节点的热点键
+     * @param limit 每个节点最多返回的键数量
+     * @return 节点ID到该节点热点键的映射，无法访问的节点不出现在结果中
+     */
+    std::vector<std::pair<std::string, std::vector<HotKey>>> getClusterHotKeys(size_t limit);
+    
     // gRPC服务接口实现
     /**
      * gRPC获取服务实现
@@ -136,16 +427,231 @@ public:
                         const cache::HealthRequest* request,
                         cache::HealthResponse* response) override;
     
+    /**
+     * gRPC批量获取服务实现
+     * @param context gRPC服务器上下文
+     * @param request 批量获取请求
+     * @param response 批量获取响应
+     * @return gRPC状态
+     */
+    grpc::Status MGet(grpc::ServerContext* context,
+                      const cache::MGetRequest* request,
+                      cache::MGetResponse* response) override;
+    
+    /**
+     * gRPC热点键服务实现
+     * @param context gRPC服务器上下文
+     * @param request 热点键请求
+     * @param response 热点键响应
+     * @return gRPC状态
+     */
+    grpc::Status HotKeys(grpc::ServerContext* context,
+                         const cache::HotKeysRequest* request,
+                         cache::HotKeysResponse* response) override;
+    
+    /**
+     * gRPC推送副本服务实现
+     * @param context gRPC服务器上下文
+     * @param request 推送副本请求
+     * @param response 推送副本响应
+     * @return gRPC状态
+     */
+    grpc::Status PushReplicas(grpc::ServerContext* context,
+                              const cache::PushReplicasRequest* request,
+                              cache::PushReplicasResponse* response) override;
+    
+    /**
+     * gRPC失效通知服务实现
+     * @param context gRPC服务器上下文
+     * @param request 失效通知请求
+     * @param response 失效通知响应
+     * @return gRPC状态
+     */
+    grpc::Status Invalidate(grpc::ServerContext* context,
+                            const cache::InvalidateRequest* request,
+                            cache::InvalidateResponse* response) override;
+    
+    /**
+     * gRPC租约获取服务实现
+     * @param context gRPC服务器上下文
+     * @param request 租约获取请求
+     * @param response 租约获取响应
+     * @return gRPC状态
+     */
+    grpc::Status LeaseGet(grpc::ServerContext* context,
+                          const cache::LeaseGetRequest* request,
+                          cache::LeaseGetResponse* response) override;
+    
+    /**
+     * gRPC租约写入服务实现
+     * @param context gRPC服务器上下文
+     * @param request 租约写入请求
+     * @param response 租约写入响应
+     * @return gRPC状态
+     */
+    grpc::Status LeaseSet(grpc::ServerContext* context,
+                          const cache::LeaseSetRequest* request,
+                          cache::LeaseSetResponse* response) override;
+    
+    /**
+     * gRPC原子自增服务实现
+     * @param context gRPC服务器上下文
+     * @param request 原子自增请求
+     * @param response 原子自增响应
+     * @return gRPC状态
+     */
+    grpc::Status Incr(grpc::ServerContext* context,
+                      const cache::IncrRequest* request,
+                      cache::IncrResponse* response) override;
+    
+    /**
+     * gRPC比较并交换服务实现
+     * @param context gRPC服务器上下文
+     * @param request 比较并交换请求
+     * @param response 比较并交换响应
+     * @return gRPC状态
+     */
+    grpc::Status CompareAndSwap(grpc::ServerContext* context,
+                                const cache::CompareAndSwapRequest* request,
+                                cache::CompareAndSwapResponse* response) override;
+    
+    /**
+     * gRPC追加服务实现
+     * @param context gRPC服务器上下文
+     * @param request 追加请求
+     * @param response 追加响应
+     * @return gRPC状态
+     */
+    grpc::Status Append(grpc::ServerContext* context,
+                        const cache::AppendRequest* request,
+                        cache::AppendResponse* response) override;
+    
+    /**
+     * gRPC范围读取服务实现
+     * @param context gRPC服务器上下文
+     * @param request 范围读取请求
+     * @param response 范围读取响应
+     * @return gRPC状态
+     */
+    grpc::Status GetRange(grpc::ServerContext* context,
+                          const cache::GetRangeRequest* request,
+                          cache::GetRangeResponse* response) override;
+    
+    /**
+     * gRPC范围写入服务实现
+     * @param context gRPC服务器上下文
+     * @param request 范围写入请求
+     * @param response 范围写入响应
+     * @return gRPC状态
+     */
+    grpc::Status SetRange(grpc::ServerContext* context,
+                          const cache::SetRangeRequest* request,
+                          cache::SetRangeResponse* response) override;
+    
+    /**
+     * gRPC哈希读取服务实现
+     * @param context gRPC服务器上下文
+     * @param request 哈希读取请求
+     * @param response 哈希读取响应
+     * @return gRPC状态
+     */
+    grpc::Status HashGet(grpc::ServerContext* context,
+                         const cache::HashGetRequest* request,
+                         cache::HashGetResponse* response) override;
+    
+    /**
+     * gRPC哈希写入服务实现
+     * @param context gRPC服务器上下文
+     * @param request 哈希写入请求
+     * @param response 哈希写入响应
+     * @return gRPC状态
+     */
+    grpc::Status HashSet(grpc::ServerContext* context,
+                         const cache::HashSetRequest* request,
+                         cache::HashSetResponse* response) override;
+    
+    /**
+     * gRPC哈希删除服务实现
+     * @param context gRPC服务器上下文
+     * @param request 哈希删除请求
+     * @param response 哈希删除响应
+     * @return gRPC状态
+     */
+    grpc::Status HashDel(grpc::ServerContext* context,
+                         const cache::HashDelRequest* request,
+                         cache::HashDelResponse* response) override;
+    
+    /**
+     * gRPC批量写入服务实现
+     * @param context gRPC服务器上下文
+     * @param request 批量写入请求
+     * @param response 批量写入响应
+     * @return gRPC状态
+     */
+    grpc::Status MultiSet(grpc::ServerContext* context,
+                          const cache::MultiSetRequest* request,
+                          cache::MultiSetResponse* response) override;
+    
+    /**
+     * gRPC批量删除服务实现
+     * @param context gRPC服务器上下文
+     * @param request 批量删除请求
+     * @param response 批量删除响应
+     * @return gRPC状态
+     */
+    grpc::Status MultiDel(grpc::ServerContext* context,
+                          const cache::MultiDelRequest* request,
+                          cache::MultiDelResponse* response) override;
+    
+    /**
+     * gRPC遍历服务实现
+     * @param context gRPC服务器上下文
+     * @param request 遍历请求
+     * @param response 遍历响应
+     * @return gRPC状态
+     */
+    grpc::Status Scan(grpc::ServerContext* context,
+                      const cache::ScanRequest* request,
+                      cache::ScanResponse* response) override;
+    
+    /**
+     * gRPC按模式删除服务实现
+     * @param context gRPC服务器上下文
+     * @param request 按模式删除请求
+     * @param response 按模式删除响应
+     * @return gRPC状态
+     */
+    grpc::Status DeleteMatching(grpc::ServerContext* context,
+                                const cache::DeleteMatchingRequest* request,
+                                cache::DeleteMatchingResponse* response) override;
+    
+    /**
+     * gRPC命名空间配置服务实现
+     * @param context gRPC服务器上下文
+     * @param request 命名空间配置请求
+     * @param response 命名空间配置响应
+     * @return gRPC状态
+     */
+    grpc::Status ConfigureNamespace(grpc::ServerContext* context,
+                                    const cache::ConfigureNamespaceRequest* request,
+                                    cache::ConfigureNamespaceResponse* response) override;
+    
 private:
     // 节点基本信息
     std::string node_id_;    // 节点唯一标识符
     std::string host_;       // 服务器主机地址
     int grpc_port_;          // gRPC服务端口
     int http_port_;          // HTTP服务端口
+    ServerOptions options_;  // 运行配置
+    
+    // 本地存储（按键分片加锁，键值和租约在同一分片内修改）
+    std::unique_ptr<LocalStore> store_;         // 本地键值和租约
+    std::unique_ptr<TtlCache> stale_values_;    // 最近删除的旧值
+    std::unique_ptr<CoreEngine> cores_;         // 每核一线程模式的核心线程，未启用时为空
     
-    // 本地存储
-    std::unordered_map<std::string, std::string> local_cache_;  // 本地缓存存储
-    std::mutex cache_mutex_;                                     // 缓存访问互斥锁
+    // 可观测性
+    std::unique_ptr<Metrics> metrics_;            // 指标注册表
+    std::unique_ptr<HotKeyTracker> hot_keys_;     // 热点键追踪器
     
     // 分布式组件
     std::unique_ptr<ConsistentHash> hash_ring_;   // 一致性哈希环
@@ -155,6 +661,55 @@ private:
     // gRPC服务器
     std::unique_ptr<grpc::Server> grpc_server_;   // gRPC服务器实例
     
+    /**
+     * 已推送到其他节点的热点键
+     */
+    struct ReplicatedKey {
+        std::chrono::steady_clock::time_point expires_at;  // 副本的最晚过期时间
+        uint64_t writes;                                   // 推送后发生的写入次数
+    };
+    
+    // 热点键复制
+    std::unique_ptr<TtlCache> replicas_;                              // 其他节点推送来的热点副本
+    std::unordered_map<std::string, ReplicatedKey> replicated_keys_;  // 本节点已推送副本的键
+    std::mutex replication_mutex_;                                    // 保护replicated_keys_的互斥锁
+    
+    // 近端缓存
+    std::unique_ptr<TtlCache> near_cache_;     // 转发读取到的其他节点的键，未启用时为空
+    std::unique_ptr<NegativeCache> negative_cache_;  // 转发读取确认不存在的键，未启用时为空
+    uint64_t invalidation_epoch_;              // 收到失效通知的次数，用于丢弃与失效并发的回填
+    std::mutex near_cache_mutex_;              // 保护回填判断和invalidation_epoch_的互斥锁
+    std::unordered_map<std::string,
+        std::unordered_map<std::string, std::chrono::steady_clock::time_point>> fetchers_;  // 键 -> 缓存了该键的节点及其缓存过期时间
+    std::mutex fetchers_mutex_;                // 保护fetchers_的互斥锁
+    
+    /**
+     * 一次转发读取的结果
+     */
+    struct RemoteRead {
+        KeyValueResult result;  // 查询结果
+        ReadMeta meta;          // 值的过期状态
+    };
+    
+    // 请求合并
+    SingleFlight<RemoteRead> remote_flights_;                     // 合并同一个键的并发转发读取
+    SingleFlight<KeyValueResult> load_flights_;                       // 合并同一个键的并发读穿透加载
+    std::function<bool(const std::string&, std::string&)> loader_;    // 读穿透加载函数，未设置时为空
+    
+    // 后台线程
+    std::thread background_thread_;                                   // 后台线程，负责热点复制和过期登记清理
+    std::atomic<bool> running_;                                       // 后台线程运行标志
+    std::mutex background_mutex_;                                     // 配合条件变量使用的互斥锁
+    std::condition_variable background_cv_;                           // 用于唤醒后台线程退出
+    
+    // 按模式删除
+    static constexpr size_t kBulkDeleteBatch = 1000;                  // 每批最多检查的条目数
+    std::thread bulk_delete_thread_;                                  // 执行按模式删除任务的线程
+    std::deque<std::string> bulk_delete_jobs_;                        // 排队中的删除模式，队首为正在执行的任务
+    std::mutex bulk_delete_mutex_;                                    // 保护bulk_delete_jobs_的互斥锁
+    std::condition_variable bulk_delete_cv_;                          // 有新任务或停止时唤醒删除线程
+    std::atomic<uint64_t> bulk_deleted_;                              // 按模式删除的键数量
+    
     // 辅助方法
     /**
      * 判断键值是否属于本地节点
@@ -163,21 +718,31 @@ private:
      */
     bool isLocalKey(const std::string& key) const;
     
+    /**
+     * 记录一批批量查询结果的命中、路由和字节数指标
+     * @param results 查询结果
+     * @param route 本地处理（LocalOps）还是转发（Forwarded）
+     */
+    void recordBatch(const std::vector<KeyValueResult>& results, MetricCounter route);
+    
     /**
      * 从本地缓存获取值
      * @param key 缓存键
      * @param value 输出参数，存储获取到的值
+     * @param meta 输出参数（可为空），值的过期状态
+     * @param claim_refresh 是否允许本次读取领取刷新任务
      * @return 是否成功获取
      */
-    bool getLocal(const std::string& key, std::string& value);
+    bool getLocal(const std::string& key, std::string& value, ReadMeta* meta = nullptr, bool claim_refresh = false);
     
     /**
      * 向本地缓存设置值
      * @param key 缓存键
      * @param value 要设置的值
+     * @param ttl 过期参数
      * @return 是否成功设置
      */
-    bool setLocal(const std::string& key, const std::string& value);
+    bool setLocal(const std::string& key, const std::string& value, const EntryTtl& ttl = EntryTtl());
     
     /**
      * 从本地缓存删除值
@@ -185,4 +750,194 @@ private:
      * @return 是否成功删除
      */
     bool delLocal(const std::string& key);
+    
+    /**
+     * 后台线程主循环，周期性推送热点副本并清理过期的近端缓存登记
+     */
+    void backgroundLoop();
+    
+    /**
+     * 按模式删除线程主循环，逐个执行排队的任务，每批只持有一个分片的锁
+     */
+    void bulkDeleteLoop();
+    
+    /**
+     * 在键所在分片的核心线程上执行本地存储操作
+     * 未启用每核一线程模式时直接在当前线程执行
+     * @param key 缓存键
+     * @param fn 本地存储操作
+     * @return 操作的返回值
+     */
+    template <typename F>
+    auto onOwner(const std::string& key, F&& fn) -> decltype(fn()) {
+        if (!cores_) {
+            return fn();
+        }
+        return cores_->run(store_->shardOf(key) % cores_->size(), fn);
+    }
+    
+    /**
+     * 从远程节点获取值，启用近端缓存时先查近端缓存并在获取后回填
+     * @param key 缓存键
+     * @param value 输出参数，存储获取到的值
+     * @param meta 输出参数（可为空），值的过期状态
+     * @return 是否成功获取
+     */
+    bool getRemote(const std::string& key, std::string& value, ReadMeta* meta);
+    
+    /**
+     * 从本地缓存获取值，未命中且设置了加载函数时读穿透加载
+     * @param key 缓存键
+     * @param value 输出参数，存储获取到的值
+     * @param meta 输出参数（可为空），值的过期状态；非空时本次读取可能被选中负责刷新
+     * @return 是否成功获取
+     */
+    bool getOrLoadLocal(const std::string& key, std::string& value, ReadMeta* meta = nullptr);
+    
+    /**
+     * 清理已经过期的近端缓存登记
+     */
+    void purgeFetchers();
+    
+    /**
+     * 丢弃本节点保存的其他节点键的副本（热点副本、近端缓存、负缓存）
+     * @param key 缓存键
+     */
+    void dropRemoteCopies(const std::string& key);
+    
+    /**
+     * 在本地执行租约获取
+     * @param key 缓存键
+     * @param result 输出参数，存储租约获取结果
+     */
+    void leaseGetLocal(const std::string& key, LeaseResult& result);
+    
+    /**
+     * 在本地执行租约写入
+     * @param key 缓存键
+     * @param value 缓存值
+     * @param token LeaseGet发放的租约
+     * @return 租约有效并已写入时返回true
+     */
+    bool leaseSetLocal(const std::string& key, const std::string& value, uint64_t token);
+    
+    /**
+     * 在本地执行原子自增
+     * @param key 缓存键
+     * @param delta 增量
+     * @param result 输出参数，自增后的值
+     * @return 操作结果
+     */
+    OpStatus incrLocal(const std::string& key, int64_t delta, int64_t& result);
+    
+    /**
+     * 在本地执行比较并交换
+     * @param key 缓存键
+     * @param value 要写入的值
+     * @param expected_version 期望的版本
+     * @param version 输出参数，成功时为新版本，冲突时为当前版本
+     * @return 操作结果
+     */
+    OpStatus compareAndSwapLocal(const std::string& key, const std::string& value,
+                                 uint64_t expected_version, uint64_t& version);
+    
+    /**
+     * 在本地执行追加
+     * @param key 缓存键
+     * @param data 追加的数据
+     * @param length 输出参数，追加后的值长度
+     * @return 操作结果
+     */
+    OpStatus appendLocal(const std::string& key, const std::string& data, size_t& length);
+    
+    /**
+     * 在本地执行范围写入
+     * @param key 缓存键
+     * @param offset 写入位置
+     * @param data 写入的数据
+     * @param length 输出参数，写入后的值长度
+     * @return 操作结果
+     */
+    OpStatus setRangeLocal(const std::string& key, size_t offset, const std::string& data, size_t& length);
+    
+    /**
+     * 在本地写入哈希字段
+     * @param key 缓存键
+     * @param fields 要写入的字段
+     * @param added 输出参数，新增的字段数量
+     * @return 操作结果
+     */
+    OpStatus hashSetLocal(const std::string& key, const std::vector<FieldValue>& fields, size_t& added);
+    
+    /**
+     * 在本地删除哈希字段
+     * @param key 缓存键
+     * @param fields 要删除的字段名
+     * @param removed 输出参数，实际删除的字段数量
+     * @return 操作结果
+     */
+    OpStatus hashDelLocal(const std::string& key, const std::vector<std::string>& fields, size_t& removed);
+    
+    /**
+     * 在本地原子地写入多个键
+     * @param entries 键值对
+     * @param ttl 过期参数
+     * @param condition 写入的前提条件
+     * @return 操作结果；有键不归本节点负责时返回CrossNode
+     */
+    OpStatus multiSetLocal(const std::vector<std::pair<std::string, std::string>>& entries, const EntryTtl& ttl,
+                           WriteCondition condition);
+    
+    /**
+     * 在本地原子地删除多个键
+     * @param keys 要删除的键
+     * @param deleted 输出参数，实际删除的键数量
+     * @return 操作结果；有键不归本节点负责时返回CrossNode
+     */
+    OpStatus multiDelLocal(const std::vector<std::string>& keys, size_t& deleted);
+    
+    /**
+     * 检查一组键是否都属于同一个节点
+     * @param keys 缓存键
+     * @param owner 输出参数，负责这些键的节点
+     * @return 都属于同一个节点时返回true
+     */
+    bool sameOwner(const std::vector<std::string>& keys, Node& owner) const;
+    
+    /**
+     * 把操作结果转换为协议中的取值
+     * @param status 操作结果
+     * @return 协议中的操作结果
+     */
+    static cache::OpStatusCode toStatusCode(OpStatus status);
+    
+    /**
+     * 把本节点负责的热点键推送到其他所有节点
+     */
+    void replicateHotKeys();
+    
+    /**
+     * 本地键被修改后调用，向持有该键副本或近端缓存的节点发送失效通知
+     * @param key 被修改的键
+     */
+    void notifyKeyChanged(const std::string& key);
+    
+    /**
+     * 一批本地键被修改后调用，每个目标节点只发送一次失效通知
+     * @param keys 被修改的键
+     */
+    void notifyKeysChanged(const std::vector<std::string>& keys);
+    
+    /**
+     * 向一组节点并行发送失效通知
+     * @param targets 目标节点
+     * @param keys 已被修改的键
+     */
+    void sendInvalidation(const std::vector<Node>& targets, const std::vector<std::string>& keys);
+    
+    /**
+     * 获取除本节点以外的所有节点
+     * @return 其他节点列表
+     */
+    std::vector<Node> otherNodes() const;
 };
\ No newline at end of file
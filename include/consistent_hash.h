@@ -41,6 +41,7 @@ struct Node {
  * 2. 支持节点的动态增删
  * 3. 基于MD5哈希算法保证良好的分布性
  * 4. 环形结构实现顺时针查找
+ * 5. 支持哈希标签：键中包含{tag}时只对tag计算哈希，标签相同的键落在同一个节点
  */
 class ConsistentHash {
 public:
@@ -82,6 +83,15 @@ public:
      */
     bool hasNode(const std::string& node_id) const;
     
+    /**
+     * 获取键中参与哈希计算的部分
+     * 规则与Redis Cluster相同：取第一个'{'与其后第一个'}'之间的内容，
+     * 内容非空时只对它计算哈希，否则对整个键计算哈希
+     * @param key 缓存键
+     * @return 参与哈希计算的部分
+     */
+    static std::string hashTag(const std::string& key);
+    
 private:
     int virtual_nodes_;                              // 每个物理节点的虚拟节点数量
     std::map<uint32_t, std::string> ring_;          // 哈希环，键为哈希值，值为节点ID
@@ -0,0 +1,218 @@
+#pragma once
+
+#include "spsc_queue.h"
+#include "numa_topology.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * 跨线程提交任务的NUMA统计
+ * 提交线程与核心线程在同一个节点上为本地，否则为远程；耗时从入队到执行完毕
+ */
+struct NumaDispatchStats {
+    uint64_t local_tasks;    // 本地提交的任务数量
+    uint64_t remote_tasks;   // 远程提交的任务数量
+    uint64_t local_nanos;    // 本地提交的任务总耗时（纳秒）
+    uint64_t remote_nanos;   // 远程提交的任务总耗时（纳秒）
+};
+
+/**
+ * 每核一线程的无共享执行引擎
+ * 每个核心线程绑定一个CPU并独占本地键空间的一个分区，对分区的操作都交给拥有它的核心线程执行，
+ * 分区的数据只在一个CPU的缓存中来回，不会在核心之间反复迁移缓存行
+ *
+ * 设计特点：
+ * - 无共享：提交线程和核心线程之间只通过单生产者单消费者队列传递任务，不争用共享的锁
+ * - 队列网格：每个提交线程对每个核心各有一条队列，提交线程首次提交时领取一组队列，退出时归还
+ * - 同步执行：提交后等待核心线程执行完毕，任务和结果都在提交线程的栈上，不分配内存
+ * - 就地执行：核心线程提交给自己的任务直接执行；提交线程超过kMaxProducers时也退回就地执行
+ * - 先自旋后休眠：核心线程空闲一段时间后才休眠，提交时只在核心线程休眠时唤醒
+ * - NUMA感知（可选）：核心线程轮流分布到各个NUMA节点，只绑定到所在节点的CPU，
+ *   分配内存时优先使用所在节点，分区的数据和访问它的线程在同一个节点上
+ */
+class CoreEngine {
+public:
+    static constexpr size_t kMaxProducers = 256;    // 同时领取队列的提交线程上限
+    static constexpr size_t kQueueCapacity = 4;     // 每条队列的容量，每个提交线程同时只有一个任务
+
+    /**
+     * 构造函数，启动核心线程
+     * @param cores 核心线程数量，第i个线程绑定到第i个可用CPU（CPU不足时循环使用）
+     * @param numa 是否按NUMA节点分布核心线程：第i个线程放在第i % 节点数个节点上，并优先使用该节点的内存
+     */
+    explicit CoreEngine(size_t cores, bool numa = false);
+
+    /**
+     * 析构函数，执行完已提交的任务后停止核心线程
+     */
+    ~CoreEngine();
+
+    CoreEngine(const CoreEngine&) = delete;
+    CoreEngine& operator=(const CoreEngine&) = delete;
+
+    /**
+     * 在指定核心线程上执行函数并等待结果
+     * @param core 核心编号
+     * @param fn 要执行的函数
+     * @return 函数的返回值
+     */
+    template <typename F>
+    auto run(size_t core, F&& fn) -> decltype(fn()) {
+        using Result = decltype(fn());
+        if constexpr (std::is_void_v<Result>) {
+            execute(core, fn);
+        } else {
+            Result result{};
+            auto call = [&]() { result = fn(); };
+            execute(core, call);
+            return result;
+        }
+    }
+
+    /**
+     * 核心线程数量
+     * @return 核心线程数量
+     */
+    size_t size() const { return cores_.size(); }
+
+    /**
+     * 各核心线程执行的任务数量
+     * @return 每个核心一项
+     */
+    std::vector<uint64_t> executed() const;
+
+    /**
+     * 因提交线程过多而在提交线程上就地执行的任务数量
+     * @return 任务数量
+     */
+    uint64_t inlined() const { return inlined_.load(std::memory_order_relaxed); }
+
+    /**
+     * NUMA节点数量（只计算有可用CPU的节点）
+     * @return 节点数量
+     */
+    size_t nodeCount() const { return topology_.nodeCount(); }
+
+    /**
+     * 核心线程所在的NUMA节点
+     * @param core 核心编号
+     * @return 节点的系统编号
+     */
+    int nodeOf(size_t core) const { return topology_.nodeId(cores_[core]->node); }
+
+    /**
+     * 跨线程提交任务的本地/远程统计，只在按NUMA节点分布时统计
+     * @return 统计
+     */
+    NumaDispatchStats numaStats() const;
+
+private:
+    /**
+     * 一个提交线程的状态
+     */
+    struct Producer {
+        std::atomic<bool> in_use{false};    // 是否已被某个线程领取
+        std::atomic<bool> done{false};      // 当前任务是否执行完毕
+        std::atomic<bool> waiting{false};   // 提交线程是否正在休眠等待
+        std::mutex mutex;                   // 配合cv等待任务完成
+        std::condition_variable cv;         // 任务完成时唤醒提交线程
+        // NUMA统计，只由领取该编号的线程写入，归还后保留累计值
+        std::atomic<uint64_t> local_tasks{0};
+        std::atomic<uint64_t> remote_tasks{0};
+        std::atomic<uint64_t> local_nanos{0};
+        std::atomic<uint64_t> remote_nanos{0};
+    };
+
+    /**
+     * 一个任务，由提交线程在栈上构造，核心线程执行后置位完成标志
+     */
+    struct Task {
+        void (*invoke)(void*);   // 调用context指向的函数
+        void* context;           // 提交线程栈上的函数对象
+        Producer* producer;      // 提交任务的线程，执行完毕后通知它
+    };
+
+    /**
+     * 一个核心线程的状态
+     */
+    struct alignas(64) Core {
+        std::vector<std::unique_ptr<SpscQueue<Task*>>> queues;   // 来自各个提交线程的队列，下标为提交线程编号
+        std::atomic<bool> sleeping{false};   // 是否正在休眠
+        std::mutex mutex;                    // 配合cv休眠
+        std::condition_variable cv;          // 有新任务时唤醒
+        bool wake = false;                   // 是否有待处理的唤醒
+        std::atomic<uint64_t> executed{0};   // 执行的任务数量
+        int cpu = 0;                         // 绑定的CPU
+        size_t node = 0;                     // 所在的NUMA节点下标
+        std::thread thread;                  // 核心线程
+    };
+
+    /**
+     * 提交线程的注册信息，线程退出时析构并归还领取的队列
+     */
+    struct Registration;
+
+    static std::atomic<uint64_t> next_id_;       // 上一个分配的引擎编号
+    uint64_t id_;                                // 引擎编号，区分先后创建在同一地址上的引擎
+    std::vector<std::unique_ptr<Core>> cores_;   // 核心线程
+    std::shared_ptr<Producer[]> producers_;      // 提交线程状态，线程退出时可能晚于引擎析构，因此共享所有权
+    std::atomic<size_t> producer_limit_;         // 曾经领取过的最大提交线程编号加一，核心线程只检查这个范围
+    std::atomic<bool> running_;                  // 是否正在运行
+    std::atomic<uint64_t> inlined_;              // 就地执行的任务数量
+    NumaTopology topology_;                      // NUMA拓扑
+    bool numa_;                                  // 是否按NUMA节点分布核心线程
+
+    /**
+     * 把函数包装成任务并提交
+     * @param core 核心编号
+     * @param fn 要执行的函数
+     */
+    template <typename Fn>
+    void execute(size_t core, Fn& fn) {
+        Task task{[](void* context) { (*static_cast<Fn*>(context))(); }, &fn, nullptr};
+        submit(core, task);
+    }
+
+    /**
+     * 提交任务并等待执行完毕
+     * 当前线程就是目标核心线程或领取不到队列时就地执行
+     * @param core 核心编号
+     * @param task 任务
+     */
+    void submit(size_t core, Task& task);
+
+    /**
+     * 等待提交线程的当前任务执行完毕
+     * @param producer 提交线程状态
+     */
+    void wait(Producer& producer);
+
+    /**
+     * 获取当前线程领取的提交线程编号，首次调用时领取
+     * @return 提交线程编号，领取不到时返回kMaxProducers
+     */
+    size_t producerIndex();
+
+    /**
+     * 核心线程主循环
+     * @param index 核心编号
+     */
+    void coreLoop(size_t index);
+
+    static thread_local Registration registration_;     // 当前线程领取的提交线程编号
+    static thread_local const CoreEngine* current_engine_;  // 当前线程所属的引擎，不是核心线程时为空
+    static thread_local size_t current_core_;            // 当前线程的核心编号
+
+    /**
+     * 把当前线程绑定到指定CPU
+     * @param cpu CPU编号
+     */
+    static void pinToCpu(int cpu);
+};
\ No newline at end of file
@@ -3,9 +3,47 @@
 #include <grpcpp/grpcpp.h>
 #include "cache.grpc.pb.h"
 #include "consistent_hash.h"
+#include "cache_entry.h"
+#include "metrics.h"
+#include "hot_keys.h"
 #include <memory>
 #include <unordered_map>
 #include <mutex>
+#include <vector>
+#include <chrono>
+#include <sstream>
+
+/**
+ * 单个键的批量查询结果
+ */
+struct KeyValueResult {
+    std::string key;     // 缓存键
+    bool found;          // 是否找到对应的缓存项
+    std::string value;   // 缓存值（仅在found为true时有效）
+    bool error;          // 负责节点是否无法访问
+    
+    KeyValueResult() : found(false), error(false) {}
+};
+
+/**
+ * 单个目标节点的调用指标
+ * 按调用类型记录耗时，另外记录在途请求数、状态码分布和收发字节数，全部为原子变量
+ */
+struct PeerStats {
+    static constexpr int kStatusCodes = 17;   // gRPC状态码数量
+    
+    LatencyHistogram latency[static_cast<int>(MetricOp::Count)];   // 各调用类型的耗时直方图
+    std::atomic<int64_t> inflight;                                  // 在途请求数
+    std::atomic<uint64_t> status_codes[kStatusCodes];              // 各状态码出现次数
+    std::atomic<uint64_t> bytes_sent;                               // 请求消息字节数
+    std::atomic<uint64_t> bytes_received;                           // 响应消息字节数
+    
+    PeerStats() : inflight(0), bytes_sent(0), bytes_received(0) {
+        for (auto& count : status_codes) {
+            count.store(0, std::memory_order_relaxed);
+        }
+    }
+};
 
 /**
  * gRPC客户端类
@@ -21,14 +59,16 @@
  * - 连接复用：为每个节点维护长连接，避免频繁建立连接的开销
  * - 线程安全：使用互斥锁保护连接池的并发访问
  * - 错误处理：优雅处理网络异常和节点故障
+ * - 可观测性：每次调用按目标节点记录耗时、在途数、状态码和收发字节数
  */
 class GrpcClient {
 public:
     /**
      * 构造函数
      * 初始化gRPC客户端和连接池
+     * @param metrics 指标注册表，为空时不记录指标
      */
-    GrpcClient();
+    explicit GrpcClient(Metrics* metrics = nullptr);
     
     // 缓存操作接口
     /**
@@ -36,18 +76,35 @@ public:
      * @param node 目标节点信息
      * @param key 缓存键
      * @param value 输出参数，存储获取到的值
+     * @param meta 输出参数（可为空），值的过期状态
      * @return 是否成功获取
      */
-    bool get(const Node& node, const std::string& key, std::string& value);
+    bool get(const Node& node, const std::string& key, std::string& value, ReadMeta* meta = nullptr);
+    
+    /**
+     * 从远程节点获取缓存值，并登记本节点会缓存结果
+     * 负责节点在cache_ttl_ms内键被修改时向本节点发送失效通知；
+     * 与get不同，结果区分"键不存在"和"调用失败"，调用失败的结果不能缓存
+     * @param node 目标节点信息
+     * @param key 缓存键
+     * @param requester_id 本节点ID
+     * @param cache_ttl_ms 本节点缓存结果的时间（毫秒）
+     * @param result 输出参数，found表示键存在，error表示调用失败
+     * @param meta 输出参数（可为空），值的过期状态
+     */
+    void fetch(const Node& node, const std::string& key, const std::string& requester_id,
+               int cache_ttl_ms, KeyValueResult& result, ReadMeta* meta = nullptr);
     
     /**
      * 向远程节点设置缓存值
      * @param node 目标节点信息
      * @param key 缓存键
      * @param value 缓存值
+     * @param ttl 过期参数
      * @return 是否成功设置
      */
-    bool set(const Node& node, const std::string& key, const std::string& value);
+    bool set(const Node& node, const std::string& key, const std::string& value,
+             const EntryTtl& ttl = EntryTtl());
     
     /**
      * 从远程节点删除缓存项
@@ -57,6 +114,15 @@ public:
      */
     bool del(const Node& node, const std::string& key);
     
+    /**
+     * 从远程节点批量获取缓存值
+     * @param node 目标节点信息
+     * @param keys 属于该节点的缓存键列表
+     * @param results 输出参数，按键的顺序追加查询结果，RPC失败时每个键标记为error
+     * @return RPC是否成功
+     */
+    bool mget(const Node& node, const std::vector<std::string>& keys, std::vector<KeyValueResult>& results);
+    
     /**
      * 检查远程节点健康状态
      * @param node 目标节点信息
@@ -64,18 +130,286 @@ public:
      */
     bool health(const Node& node);
     
+    /**
+     * 获取远程节点的热点键
+     * @param node 目标节点信息
+     * @param limit 最多返回的键数量
+     * @param hot_keys 输出参数，按估算访问次数从高到低排列的热点键
+     * @return 是否成功获取
+     */
+    bool hotKeys(const Node& node, size_t limit, std::vector<HotKey>& hot_keys);
+    
+    /**
+     * 在远程节点上执行租约获取
+     * @param node 目标节点信息
+     * @param key 缓存键
+     * @param result 输出参数，存储租约获取结果
+     * @return 调用是否成功
+     */
+    bool leaseGet(const Node& node, const std::string& key, LeaseResult& result);
+    
+    /**
+     * 在远程节点上执行租约写入
+     * @param node 目标节点信息
+     * @param key 缓存键
+     * @param value 缓存值
+     * @param token LeaseGet发放的租约
+     * @return 租约有效并已写入时返回true
+     */
+    bool leaseSet(const Node& node, const std::string& key, const std::string& value, uint64_t token);
+    
+    /**
+     * 在远程节点上执行原子自增
+     * @param node 目标节点信息
+     * @param key 缓存键
+     * @param delta 增量，可以为负
+     * @param result 输出参数，自增后的值
+     * @return 操作结果，调用失败时返回Unavailable
+     */
+    OpStatus incr(const Node& node, const std::string& key, int64_t delta, int64_t& result);
+    
+    /**
+     * 在远程节点上执行比较并交换
+     * @param node 目标节点信息
+     * @param key 缓存键
+     * @param value 要写入的值
+     * @param expected_version 期望的版本，0表示要求键不存在
+     * @param version 输出参数，成功时为新版本，冲突时为当前版本
+     * @return 操作结果，调用失败时返回Unavailable
+     */
+    OpStatus compareAndSwap(const Node& node, const std::string& key, const std::string& value,
+                            uint64_t expected_version, uint64_t& version);
+    
+    /**
+     * 在远程节点上执行追加
+     * @param node 目标节点信息
+     * @param key 缓存键
+     * @param data 追加的数据
+     * @param length 输出参数，追加后的值长度
+     * @return 操作结果，调用失败时返回Unavailable
+     */
+    OpStatus append(const Node& node, const std::string& key, const std::string& data, size_t& length);
+    
+    /**
+     * 从远程节点读取值的一段
+     * @param node 目标节点信息
+     * @param key 缓存键
+     * @param start 起始位置（包含），负数表示从末尾倒数
+     * @param end 结束位置（包含），负数表示从末尾倒数
+     * @param value 输出参数，读取到的片段
+     * @param length 输出参数，完整值的长度
+     * @return 键存在时返回true，不存在或调用失败时返回false
+     */
+    bool getRange(const Node& node, const std::string& key, int64_t start, int64_t end,
+                  std::string& value, size_t& length);
+    
+    /**
+     * 在远程节点上执行范围写入
+     * @param node 目标节点信息
+     * @param key 缓存键
+     * @param offset 写入位置
+     * @param data 写入的数据
+     * @param length 输出参数，写入后的值长度
+     * @return 操作结果，调用失败时返回Unavailable
+     */
+    OpStatus setRange(const Node& node, const std::string& key, size_t offset, const std::string& data,
+                      size_t& length);
+    
+    /**
+     * 从远程节点读取哈希字段
+     * @param node 目标节点信息
+     * @param key 缓存键
+     * @param fields 输入要读取的字段名（为空表示全部），输出读取结果
+     * @return 操作结果，调用失败时返回Unavailable
+     */
+    OpStatus hashGet(const Node& node, const std::string& key, std::vector<FieldValue>& fields);
+    
+    /**
+     * 在远程节点上写入哈希字段
+     * @param node 目标节点信息
+     * @param key 缓存键
+     * @param fields 要写入的字段
+     * @param added 输出参数，新增的字段数量
+     * @return 操作结果，调用失败时返回Unavailable
+     */
+    OpStatus hashSet(const Node& node, const std::string& key, const std::vector<FieldValue>& fields, size_t& added);
+    
+    /**
+     * 在远程节点上删除哈希字段
+     * @param node 目标节点信息
+     * @param key 缓存键
+     * @param fields 要删除的字段名
+     * @param removed 输出参数，实际删除的字段数量
+     * @return 操作结果，调用失败时返回Unavailable
+     */
+    OpStatus hashDel(const Node& node, const std::string& key, const std::vector<std::string>& fields,
+                     size_t& removed);
+    
+    /**
+     * 在远程节点上原子地写入多个键
+     * @param node 目标节点信息
+     * @param entries 键值对
+     * @param ttl 过期参数，作用于所有键
+     * @param condition 写入的前提条件
+     * @return 操作结果，调用失败时返回Unavailable
+     */
+    OpStatus multiSet(const Node& node, const std::vector<std::pair<std::string, std::string>>& entries,
+                      const EntryTtl& ttl, WriteCondition condition);
+    
+    /**
+     * 在远程节点上原子地删除多个键
+     * @param node 目标节点信息
+     * @param keys 要删除的键
+     * @param deleted 输出参数，实际删除的键数量
+     * @return 操作结果，调用失败时返回Unavailable
+     */
+    OpStatus multiDel(const Node& node, const std::vector<std::string>& keys, size_t& deleted);
+    
+    /**
+     * 按游标分批遍历远程节点上的键
+     * @param node 目标节点信息
+     * @param cursor 该节点的游标，"0"表示从头开始
+     * @param count 本次最多检查的条目数
+     * @param match glob模式，为空时不过滤
+     * @param keys 输出参数，追加本次找到的键
+     * @param next 输出参数，该节点下一次的游标，遍历结束时为"0"
+     * @return 操作结果；游标格式不正确时返回Invalid，调用失败时返回Unavailable
+     */
+    OpStatus scan(const Node& node, const std::string& cursor, size_t count, const std::string& match,
+                  std::vector<std::string>& keys, std::string& next);
+    
+    /**
+     * 在远程节点上提交按模式删除的后台任务
+     * @param node 目标节点信息
+     * @param match glob模式，为空时删除全部
+     * @return 操作结果，调用失败时返回Unavailable
+     */
+    OpStatus deleteMatching(const Node& node, const std::string& match);
+    
+    /**
+     * 在远程节点上创建、修改或删除命名空间
+     * @param node 目标节点信息
+     * @param name 命名空间名称
+     * @param quota_bytes 内存配额（字节），0表示不限制
+     * @param remove 是否删除命名空间
+     * @return 操作结果，调用失败时返回Unavailable
+     */
+    OpStatus configureNamespace(const Node& node, const std::string& name, uint64_t quota_bytes, bool remove);
+    
+    /**
+     * 向远程节点推送热点键副本
+     * @param node 目标节点信息
+     * @param source_node 推送方节点ID
+     * @param entries 热点键及其当前值
+     * @param ttl_ms 副本存活时间（毫秒）
+     * @param timeout_ms 调用超时时间（毫秒）
+     * @return 是否推送成功
+     */
+    bool pushReplicas(const Node& node, const std::string& source_node,
+                      const std::vector<KeyValueResult>& entries, int ttl_ms, int timeout_ms = 500);
+    
+    /**
+     * 通知远程节点删除一组键的副本
+     * @param node 目标节点信息
+     * @param source_node 发送方节点ID
+     * @param keys 已被修改的键
+     * @param timeout_ms 调用超时时间（毫秒）
+     * @return 是否通知成功
+     */
+    bool invalidate(const Node& node, const std::string& source_node,
+                    const std::vector<std::string>& keys, int timeout_ms = 500);
+    
+    // 可观测性
+    /**
+     * 以Prometheus文本格式输出各个目标节点的指标
+     * @return Prometheus文本
+     */
+    std::string renderPeerMetrics();
+    
+    /**
+     * 以JSON格式输出各个目标节点的概况
+     * @return JSON文本
+     */
+    std::string renderPeersJson();
+    
 private:
-    // gRPC连接池：地址到服务存根的映射
-    std::unordered_map<std::string, std::unique_ptr<cache::CacheService::Stub>> stubs_;
+    /**
+     * 到一个目标节点的连接及其调用指标
+     */
+    struct Peer {
+        std::string node_id;                                  // 节点ID
+        std::string address;                                  // 节点gRPC地址
+        std::unique_ptr<cache::CacheService::Stub> stub;      // gRPC服务存根
+        PeerStats stats;                                      // 调用指标
+    };
+    
+    /**
+     * 一次gRPC调用的作用域
+     * 构造时增加在途数并记录开始时间，finish时记录耗时、状态码和字节数
+     */
+    class CallScope {
+    public:
+        CallScope(GrpcClient* client, Peer* peer, MetricOp op);
+        ~CallScope();
+        
+        /**
+         * 记录调用结果
+         * @param status gRPC调用状态
+         * @param bytes_sent 请求消息的字节数
+         * @param bytes_received 响应消息的字节数
+         */
+        void finish(const grpc::Status& status, size_t bytes_sent, size_t bytes_received);
+        
+    private:
+        GrpcClient* client_;                              // 所属的gRPC客户端
+        Peer* peer_;                                      // 目标节点，可以为空
+        MetricOp op_;                                     // 调用类型
+        bool finished_;                                   // 是否已记录结果
+        std::chrono::steady_clock::time_point start_;     // 开始时间
+    };
+    
+    Metrics* metrics_;   // 指标注册表，可以为空
+    
+    // gRPC连接池：地址到连接的映射
+    std::unordered_map<std::string, std::unique_ptr<Peer>> stubs_;
     // 保护连接池的互斥锁
     std::mutex stubs_mutex_;
     
     /**
-     * 获取或创建到指定节点的gRPC服务存根
+     * 获取或创建到指定节点的连接
      * @param node 目标节点信息
-     * @return gRPC服务存根指针
+     * @return 连接指针
+     */
+    Peer* getPeer(const Node& node);
+    
+    /**
+     * 获取当前所有目标节点
+     * @return 节点列表
+     */
+    std::vector<Peer*> listPeers();
+    
+    /**
+     * 输出某个节点某种调用的耗时直方图
+     * @param oss 输出流
+     * @param peer 目标节点
+     * @param op 调用类型
+     * @param snapshot 直方图快照
+     */
+    void appendHistogramFor(std::ostringstream& oss, Peer* peer, MetricOp op, const HistogramSnapshot& snapshot);
+    
+    /**
+     * 获取gRPC状态码的名称
+     * @param code 状态码
+     * @return 状态码名称
+     */
+    static const char* statusCodeName(int code);
+    
+    /**
+     * 把协议中的操作结果转换为OpStatus
+     * @param code 协议中的操作结果
+     * @return 对应的OpStatus
      */
-    cache::CacheService::Stub* getStub(const Node& node);
+    static OpStatus fromStatusCode(cache::OpStatusCode code);
     
     /**
      * 构建节点的gRPC连接地址
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+/**
+ * 哈希字段的读写项
+ */
+struct FieldValue {
+    std::string field;   // 字段名
+    bool found;          // 字段是否存在（读取结果）
+    std::string value;   // 字段值
+
+    FieldValue() : found(false) {}
+    FieldValue(const std::string& field, const std::string& value) : field(field), found(true), value(value) {}
+};
+
+/**
+ * 哈希类型的值：字段名到字段值的映射
+ * 字段少且都很短时使用紧凑编码，超过阈值后转换为哈希表
+ *
+ * 设计特点：
+ * - 紧凑编码：所有字段依次写入同一块连续内存，每项为 变长长度+字段名+变长长度+字段值，
+ *   没有每个字段的节点和指针开销，小哈希的查找是一次顺序扫描
+ * - 哈希表：字段数超过kCompactMaxEntries或任一字段名、字段值超过kCompactMaxBytes时转换，
+ *   转换后即使字段变少也不再转回
+ */
+class HashValue {
+public:
+    static constexpr size_t kCompactMaxEntries = 128;   // 紧凑编码最多保存的字段数
+    static constexpr size_t kCompactMaxBytes = 64;      // 紧凑编码允许的最长字段名和字段值
+    static constexpr size_t kTableEntryBytes = 2 * sizeof(std::string) + 16;   // 哈希表每个字段的节点开销（估算）
+
+    HashValue();
+
+    /**
+     * 读取字段
+     * @param field 字段名
+     * @param value 输出参数，字段值
+     * @return 字段是否存在
+     */
+    bool get(const std::string& field, std::string& value) const;
+
+    /**
+     * 写入字段，已存在时覆盖
+     * @param field 字段名
+     * @param value 字段值
+     * @return 是否新增了字段
+     */
+    bool set(const std::string& field, const std::string& value);
+
+    /**
+     * 删除字段
+     * @param field 字段名
+     * @return 字段是否存在
+     */
+    bool erase(const std::string& field);
+
+    /**
+     * 字段数量
+     * @return 字段数量
+     */
+    size_t size() const;
+
+    /**
+     * 是否使用紧凑编码
+     * @return 使用紧凑编码时返回true
+     */
+    bool compact() const { return !table_; }
+
+    /**
+     * 占用的内存（估算），用于命名空间的内存配额
+     * @return 紧凑编码的长度，或哈希表中字段名、字段值与节点开销之和
+     */
+    size_t bytes() const { return table_ ? table_bytes_ : compact_.size(); }
+
+    /**
+     * 按存储顺序遍历所有字段
+     * @param fn 回调，参数为字段名和字段值
+     */
+    void forEach(const std::function<void(const std::string&, const std::string&)>& fn) const;
+
+    /**
+     * 序列化为JSON对象，供按字符串读取哈希键时使用
+     * @return JSON文本
+     */
+    std::string toJson() const;
+
+private:
+    std::string compact_;     // 紧凑编码的字段，table_为空时使用
+    size_t compact_count_;    // 紧凑编码的字段数量
+    std::unique_ptr<std::unordered_map<std::string, std::string>> table_;   // 转换后的哈希表
+    size_t table_bytes_;      // 哈希表占用的内存（估算），随字段增删维护
+
+    /**
+     * 在紧凑编码中查找字段
+     * @param field 字段名
+     * @param entry_start 输出参数，该项的起始偏移
+     * @param value_start 输出参数，字段值的起始偏移
+     * @param value_size 输出参数，字段值的长度
+     * @return 字段是否存在
+     */
+    bool findCompact(const std::string& field, size_t& entry_start, size_t& value_start, size_t& value_size) const;
+
+    /**
+     * 把紧凑编码转换为哈希表
+     */
+    void convertToTable();
+
+    /**
+     * 追加一个变长编码的长度
+     * @param out 输出缓冲区
+     * @param length 长度
+     */
+    static void putLength(std::string& out, size_t length);
+
+    /**
+     * 读取一个变长编码的长度
+     * @param data 缓冲区
+     * @param pos 输入输出参数，读取位置
+     * @return 长度
+     */
+    static size_t getLength(const std::string& data, size_t& pos);
+};
\ No newline at end of file
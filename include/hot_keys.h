@@ -0,0 +1,97 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * 热点键统计结果
+ */
+struct HotKey {
+    std::string key;     // 缓存键
+    uint64_t count;      // 估算的访问次数（已按采样率放大）
+    uint64_t error;      // 估算误差上界，真实次数在count-error和count之间
+
+    HotKey() : count(0), error(0) {}
+};
+
+/**
+ * 热点键追踪器
+ * 基于Space-Saving算法的流式Top-K统计，在固定数量的计数槽内近似统计访问最频繁的键
+ *
+ * 设计特点：
+ * - 内存有界：最多保存capacity个键，新键替换计数最小的槽，用最小堆在O(log n)内找到它
+ * - 采样：每个线程按采样率随机抽取访问记录，未抽中的访问只有一次线程本地随机数开销
+ * - 衰减：每隔固定时间所有计数减半，统计结果反映近期热点而不是历史累计
+ */
+class HotKeyTracker {
+public:
+    /**
+     * 构造函数
+     * @param capacity 计数槽数量，决定内存上限和统计精度
+     * @param sample_rate 采样率，每sample_rate次访问记录一次，必须是2的幂
+     * @param decay_interval 计数减半的时间间隔
+     */
+    HotKeyTracker(size_t capacity = 256, uint32_t sample_rate = 16,
+                  std::chrono::seconds decay_interval = std::chrono::seconds(10));
+
+    /**
+     * 记录一次键访问（按采样率抽样）
+     * @param key 被访问的键
+     */
+    void record(const std::string& key);
+
+    /**
+     * 获取访问最频繁的键
+     * @param limit 最多返回的键数量
+     * @return 按估算访问次数从高到低排列的热点键
+     */
+    std::vector<HotKey> topK(size_t limit) const;
+
+private:
+    /**
+     * 一个计数槽
+     */
+    struct Slot {
+        std::string key;     // 缓存键
+        uint64_t count;      // 采样计数
+        uint64_t error;      // 被替换时继承的计数，即误差上界
+    };
+
+    size_t capacity_;                                       // 计数槽数量
+    uint32_t sample_mask_;                                  // 采样掩码（采样率减一）
+    std::chrono::steady_clock::duration decay_interval_;    // 计数减半的时间间隔
+    std::chrono::steady_clock::time_point last_decay_;      // 上次衰减时间
+
+    mutable std::mutex mutex_;                              // 保护计数槽的互斥锁
+    std::vector<Slot> heap_;                                // 按计数排列的最小堆
+    std::unordered_map<std::string, size_t> positions_;     // 键到堆中位置的映射
+
+    /**
+     * 把位置pos的槽向堆底移动，直到满足最小堆性质
+     * @param pos 槽在堆中的位置
+     */
+    void siftDown(size_t pos);
+
+    /**
+     * 把位置pos的槽向堆顶移动，直到满足最小堆性质
+     * @param pos 槽在堆中的位置
+     */
+    void siftUp(size_t pos);
+
+    /**
+     * 交换两个槽并更新位置映射
+     * @param a 第一个槽的位置
+     * @param b 第二个槽的位置
+     */
+    void swapSlots(size_t a, size_t b);
+
+    /**
+     * 时间到达时把所有计数减半
+     * 减半不改变槽之间的大小关系，堆结构保持有效
+     */
+    void maybeDecay();
+};
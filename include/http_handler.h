@@ -4,8 +4,49 @@
 #include <functional>
 #include <thread>
 #include <atomic>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <memory>
+#include "rate_limiter.h"
 
 class CacheServer;
+struct EntryTtl;
+
+namespace Json {
+class Value;
+}
+
+/**
+ * HTTP准入控制配置
+ * 限制并发连接数和排队请求数，超出容量或排队超时的请求直接返回503，
+ * 避免突发流量下无限制创建线程导致整机过载
+ */
+struct HttpLimits {
+    int max_connections;    // 同时打开的客户端连接上限（含排队中的连接）
+    int worker_threads;     // 处理请求的工作线程数
+    int max_queue;          // 等待工作线程处理的请求队列长度上限
+    int queue_timeout_ms;   // 请求在队列中的最长等待时间，超时直接拒绝
+    int retry_after_sec;    // 503响应中建议客户端重试的等待秒数
+    int io_timeout_ms;      // 客户端套接字读写超时，防止慢客户端长期占用工作线程
+    size_t max_body_bytes;  // 请求体大小上限，超出返回413
+    int address_rate;       // 每个客户端地址每秒允许的请求数，0表示不限制
+    int address_burst;      // 每个客户端地址允许的突发请求数，0表示等于address_rate
+    int api_key_rate;       // 每个API密钥（X-Api-Key请求头）每秒允许的请求数，0表示不限制
+    int api_key_burst;      // 每个API密钥允许的突发请求数，0表示等于api_key_rate
+    int namespace_rate;     // 每个命名空间每秒允许的请求数，0表示不限制
+    int namespace_burst;    // 每个命名空间允许的突发请求数，0表示等于namespace_rate
+    
+    // 默认配置
+    HttpLimits() : max_connections(1024), worker_threads(32), max_queue(256),
+                   queue_timeout_ms(200), retry_after_sec(1), io_timeout_ms(2000),
+                   max_body_bytes(64 * 1024 * 1024), address_rate(0), address_burst(0),
+                   api_key_rate(0), api_key_burst(0), namespace_rate(0), namespace_burst(0) {}
+};
 
 /**
  * HTTP处理器类
@@ -13,11 +54,17 @@ class CacheServer;
  * 支持的操作：
  * - GET /{key}: 获取缓存值
  * - POST /: 批量设置键值对（JSON格式）
+ * - POST /_mget: 批量获取，按节点分组转发，以NDJSON流式返回
  * - DELETE /{key}: 删除缓存项
  * - GET /health: 健康检查
+ * - GET /metrics: Prometheus格式的指标
+ * - GET /peers: 发往各个节点的gRPC调用概况（JSON）
+ * - GET /_hotkeys: 热点键列表，scope=cluster时返回所有节点
  * 
  * 特性：
- * - 多线程处理客户端请求
+ * - 固定大小的工作线程池处理客户端请求
+ * - 连接数上限和有界请求队列，过载时快速返回503和Retry-After
+ * - 按客户端地址、API密钥和命名空间限流，超出速率时在解析请求之前返回429
  * - JSON格式的请求和响应
  * - URL解码支持
  * - 优雅的错误处理
@@ -28,8 +75,9 @@ public:
      * 构造函数
      * @param server 缓存服务器实例指针
      * @param port HTTP服务监听端口
+     * @param limits 准入控制配置
      */
-    HttpHandler(CacheServer* server, int port);
+    HttpHandler(CacheServer* server, int port, const HttpLimits& limits = HttpLimits());
     
     /**
      * 析构函数，确保资源正确释放
@@ -53,35 +101,176 @@ private:
     std::thread server_thread_;     // 服务器主线程
     int server_fd_;                 // 服务器套接字文件描述符
     
+    // 准入控制
+    /**
+     * 已接受但尚未处理完成的连接
+     */
+    struct PendingConnection {
+        int fd;                                              // 客户端套接字文件描述符
+        std::chrono::steady_clock::time_point accepted_at;   // 连接被接受的时间
+    };
+    
+    HttpLimits limits_;                          // 准入控制配置
+    std::vector<std::thread> workers_;           // 工作线程池
+    std::deque<PendingConnection> queue_;        // 等待处理的连接队列
+    std::mutex queue_mutex_;                     // 保护连接队列的互斥锁
+    std::condition_variable queue_cv_;           // 通知工作线程有新连接到达
+    std::atomic<int> active_connections_;        // 当前打开的客户端连接数
+    std::atomic<uint64_t> shed_requests_;        // 因过载被拒绝的请求总数
+    
+    // 限流，未启用的维度为空
+    static constexpr size_t kRateLimitKeys = 16384;      // 每个维度最多同时跟踪的键数量
+    std::unique_ptr<RateLimiter> address_limiter_;       // 按客户端地址限流
+    std::unique_ptr<RateLimiter> api_key_limiter_;       // 按API密钥限流
+    std::unique_ptr<RateLimiter> namespace_limiter_;     // 按命名空间限流
+    
     /**
      * 服务器主循环，监听和接受客户端连接
      */
     void serverLoop();
     
+    /**
+     * 工作线程主循环，从队列中取出连接并处理
+     */
+    void workerLoop();
+    
+    /**
+     * 拒绝过载时的请求，返回503和Retry-After后关闭连接
+     * @param client_fd 客户端套接字文件描述符
+     */
+    void shedRequest(int client_fd);
+    
+    /**
+     * 拒绝超出速率的请求，返回429和Retry-After后关闭连接
+     * @param client_fd 客户端套接字文件描述符
+     * @param retry_after 令牌恢复所需的等待时间
+     */
+    void throttleRequest(int client_fd, std::chrono::nanoseconds retry_after);
+    
+    /**
+     * 按API密钥和命名空间检查请求速率
+     * 只查看请求行和请求头，不解析请求体
+     * @param request 已读取的请求数据
+     * @param header_end 请求头结束标记的位置
+     * @param retry_after 输出参数，拒绝时为令牌恢复所需的等待时间
+     * @return 放行时返回true
+     */
+    bool admitRequest(const std::string& request, size_t header_end, std::chrono::nanoseconds& retry_after);
+    
+    /**
+     * 关闭客户端连接并释放连接配额
+     * @param client_fd 客户端套接字文件描述符
+     */
+    void closeConnection(int client_fd);
+    
     /**
      * 处理单个客户端请求
      * @param client_fd 客户端套接字文件描述符
      */
     void handleRequest(int client_fd);
     
+    /**
+     * 读取完整的HTTP请求（请求头和Content-Length指定长度的请求体）
+     * @param client_fd 客户端套接字文件描述符
+     * @param request 输出参数，原始HTTP请求字符串
+     * @param retry_after 输出参数，超出速率时为令牌恢复所需的等待时间
+     * @return 读取成功返回200，请求过大返回413，超出速率返回429，连接异常返回0
+     */
+    int readRequest(int client_fd, std::string& request, std::chrono::nanoseconds& retry_after);
+    
     /**
      * 解析HTTP请求
      * @param request 原始HTTP请求字符串
      * @param method 输出参数，HTTP方法
      * @param path 输出参数，请求路径
      * @param body 输出参数，请求体
+     * @param headers 输出参数，请求头（名称统一转为小写）
      * @return 解析结果（保留用于扩展）
      */
-    std::string parseHttpRequest(const std::string& request, std::string& method, std::string& path, std::string& body);
+    std::string parseHttpRequest(const std::string& request, std::string& method, std::string& path, std::string& body,
+                                 std::unordered_map<std::string, std::string>& headers);
+    
+    /**
+     * 处理批量获取请求，按节点返回顺序以NDJSON分块流式输出
+     * @param client_fd 客户端套接字文件描述符
+     * @param body 请求体，{"keys": [...]}或键数组
+     * @return 是否已经直接向客户端输出了响应
+     */
+    bool handleMGet(int client_fd, const std::string& body);
+    
+    /**
+     * 完整发送数据，处理部分发送的情况
+     * @param client_fd 客户端套接字文件描述符
+     * @param data 要发送的数据
+     * @return 是否全部发送成功
+     */
+    bool sendAll(int client_fd, const std::string& data);
+    
+    /**
+     * 创建JSON格式的HTTP响应
+     * @param status_code HTTP状态码
+     * @param json 响应体JSON对象
+     * @return 完整的HTTP响应字符串
+     */
+    std::string createJsonResponse(int status_code, const Json::Value& json);
     
     /**
      * 创建HTTP响应
      * @param status_code HTTP状态码
      * @param content_type 内容类型
      * @param body 响应体
+     * @param extra_headers 额外的响应头，每行以\r\n结尾
      * @return 完整的HTTP响应字符串
      */
-    std::string createHttpResponse(int status_code, const std::string& content_type, const std::string& body);
+    std::string createHttpResponse(int status_code, const std::string& content_type, const std::string& body,
+                                   const std::string& extra_headers = "");
+    
+    /**
+     * 解析URL查询字符串
+     * @param query_string 问号之后的查询字符串
+     * @return 参数名到参数值的映射
+     */
+    std::unordered_map<std::string, std::string> parseQuery(const std::string& query_string);
+    
+    /**
+     * 解析十进制有符号整数，不允许空白、加号和多余的字符
+     * @param text 文本
+     * @param value 输出参数，解析结果
+     * @return 文本是合法的整数且没有溢出时返回true
+     */
+    static bool parseInt64(const std::string& text, int64_t& value);
+    
+    /**
+     * 解析十进制无符号整数，不允许空白、符号和多余的字符
+     * @param text 文本
+     * @param value 输出参数，解析结果
+     * @return 文本是合法的非负整数且没有溢出时返回true
+     */
+    static bool parseUint64(const std::string& text, uint64_t& value);
+    
+    /**
+     * 解析查询参数中的过期参数ttl_ms、soft_ttl_ms和recompute_ms，未给出的参数保持原值
+     * @param query 查询参数
+     * @param ttl 输出参数，过期参数
+     * @return 给出的参数都是合法的整数时返回true
+     */
+    static bool parseTtl(std::unordered_map<std::string, std::string>& query, EntryTtl& ttl);
+    
+    /**
+     * 解析Range请求头，只支持单个字节范围
+     * @param header Range请求头的值
+     * @param start 输出参数，起始位置（包含），后缀范围为负数
+     * @param end 输出参数，结束位置（包含），-1表示到末尾
+     * @return 是否解析成功
+     */
+    bool parseRange(const std::string& header, int64_t& start, int64_t& end);
+    
+    /**
+     * 获取HTTP状态码对应的状态文本
+     * @param status_code HTTP状态码
+     * @return 状态文本
+     */
+    std::string statusText(int status_code);
     
     /**
      * URL解码
@@ -89,4 +278,11 @@ private:
      * @return 解码后的字符串
      */
     std::string urlDecode(const std::string& str);
+    
+    /**
+     * 把前缀转换为匹配该前缀的glob模式
+     * @param prefix 键前缀
+     * @return 转义glob特殊字符后加上*的模式
+     */
+    std::string prefixPattern(const std::string& prefix);
 };
\ No newline at end of file
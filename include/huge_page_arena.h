@@ -0,0 +1,230 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+
+/**
+ * 页面的实际类型
+ */
+enum class PageKind {
+    HugeTlb1G,     // 显式1GB大页（MAP_HUGETLB）
+    HugeTlb2M,     // 显式2MB大页（MAP_HUGETLB）
+    Transparent,   // 普通映射加MADV_HUGEPAGE，由内核透明大页合并为2MB页
+    Normal,        // 普通4KB页
+    Count          // 类型数量，不是真实类型
+};
+
+/**
+ * 大页内存来源
+ * 按配置的页大小用mmap映射内存块，显式大页不可用（大页池未预留、权限不足）时依次退回到
+ * 2MB显式大页、透明大页和普通页，不会因为没有大页而失败。
+ * 随机访问覆盖很大的内存时，每个2MB或1GB页只占一个TLB项，TLB未命中大幅减少。
+ * 指定NUMA节点时，每次映射的内存在首次访问前设为优先使用该节点，与哪个线程触发映射无关
+ *
+ * 线程安全：切分内存块和映射大块的操作由互斥锁保护，只在SlabAllocator用完一个slab或中等大小的空闲链表为空时调用
+ */
+class HugePageArena {
+public:
+    static constexpr size_t kSlabBytes = 256 * 1024;              // 每次交给SlabAllocator切分小块的内存
+    static constexpr size_t kLargePageBytes = 2 * 1024 * 1024;    // 超过该大小的分配单独映射，并按2MB对齐
+    static constexpr size_t kMinChunkBytes = 32 * 1024 * 1024;    // 切分slab的内存块的最小大小
+
+    /**
+     * 构造函数
+     * @param page_bytes 首选的页大小，2MB或1GB
+     * @param node 内存所在的NUMA节点的系统编号，-1表示不指定
+     */
+    explicit HugePageArena(size_t page_bytes, int node = -1);
+
+    /**
+     * 析构函数，解除所有内存块的映射
+     */
+    ~HugePageArena();
+
+    HugePageArena(const HugePageArena&) = delete;
+    HugePageArena& operator=(const HugePageArena&) = delete;
+
+    /**
+     * 从当前内存块中切出一段内存，剩余部分不足时映射新的内存块（旧块的剩余部分舍弃）
+     * 切出的内存不会归还，由SlabAllocator的空闲链表复用
+     * @param bytes 字节数，不超过kLargePageBytes
+     * @return 按缓存行对齐的内存，映射失败时为空
+     */
+    void* carve(size_t bytes);
+
+    /**
+     * 为超过kLargePageBytes的大块内存（例如大分片的桶数组）单独映射，按2MB取整
+     * @param bytes 字节数
+     * @return 内存，映射失败时为空
+     */
+    void* allocateLarge(size_t bytes);
+
+    /**
+     * 解除大块内存的映射
+     * @param memory allocateLarge返回的内存
+     * @param bytes 分配时的字节数
+     */
+    void freeLarge(void* memory, size_t bytes);
+
+    /**
+     * 当前映射的字节数
+     * @param kind 页面类型
+     * @return 字节数
+     */
+    uint64_t mappedBytes(PageKind kind) const {
+        return mapped_[static_cast<int>(kind)].load(std::memory_order_relaxed);
+    }
+
+    /**
+     * 内存所在的NUMA节点
+     * @return 系统编号，-1表示不指定
+     */
+    int node() const { return node_; }
+
+    /**
+     * 页面类型的名称，用于指标标签
+     * @param kind 页面类型
+     * @return 名称
+     */
+    static const char* kindName(PageKind kind);
+
+private:
+    /**
+     * 一个内存块，按链表串起来以便析构时解除映射
+     */
+    struct Chunk {
+        Chunk* next;        // 下一个内存块
+        size_t bytes;       // 映射的字节数
+        PageKind kind;      // 页面类型
+    };
+
+    size_t page_bytes_;                                           // 首选的页大小
+    int node_;                                                    // 内存所在的NUMA节点，-1表示不指定
+    std::mutex mutex_;                                            // 保护下面的切分状态和large_
+    Chunk* chunks_;                                               // 已映射的内存块
+    char* next_;                                                  // 当前内存块中未切分部分的开头
+    char* chunk_end_;                                             // 当前内存块的末尾
+    std::unordered_map<void*, PageKind> large_;                   // 单独映射的大块及其页面类型
+    std::atomic<uint64_t> mapped_[static_cast<int>(PageKind::Count)];  // 各类型页面映射的字节数
+
+    /**
+     * 映射内存，按首选页大小依次尝试显式大页、透明大页和普通页，指定了节点时设置内存策略
+     * @param bytes 字节数，按实际页大小取整后写回
+     * @param page_bytes 首选的页大小
+     * @param kind 输出参数，实际的页面类型
+     * @return 内存，全部失败时为空
+     */
+    void* mapPages(size_t& bytes, size_t page_bytes, PageKind& kind) const;
+
+    /**
+     * 不考虑NUMA节点的映射，见mapPages
+     */
+    static void* mapAnyPages(size_t& bytes, size_t page_bytes, PageKind& kind);
+
+    /**
+     * 大块内存实际映射的字节数
+     * @param bytes 请求的字节数
+     * @return 按2MB取整后的字节数
+     */
+    static size_t largeBytes(size_t bytes);
+};
+
+/**
+ * 按大小分级的slab分配器
+ * - 不超过kMaxSmall的小块（哈希表节点）：从HugePageArena取得slab后按16字节分级切分
+ * - 不超过kLargePageBytes的中等块（中小分片的桶数组）：按2的幂分级，直接从内存块中切出
+ * - 更大的块单独映射
+ * 释放的小块和中等块进入对应级别的空闲链表，不归还给HugePageArena
+ *
+ * 不是线程安全的，由调用方（本地存储的分片锁）保护
+ */
+class SlabAllocator {
+public:
+    static constexpr size_t kAlignment = 16;     // 分级粒度和对齐
+    static constexpr size_t kMaxSmall = 512;     // 从slab切分的最大分配
+    static constexpr size_t kMinMedium = 1024;   // 最小的中等块，中等块的级别为kMinMedium的2的幂倍
+
+    /**
+     * 构造函数
+     * @param arena 大页内存来源
+     */
+    explicit SlabAllocator(HugePageArena* arena);
+
+    SlabAllocator(const SlabAllocator&) = delete;
+    SlabAllocator& operator=(const SlabAllocator&) = delete;
+
+    /**
+     * 分配内存
+     * @param bytes 字节数
+     * @return 内存
+     * @throw std::bad_alloc 无法映射内存时
+     */
+    void* allocate(size_t bytes);
+
+    /**
+     * 释放内存
+     * @param memory allocate返回的内存
+     * @param bytes 分配时的字节数
+     */
+    void deallocate(void* memory, size_t bytes);
+
+private:
+    HugePageArena* arena_;                          // 大页内存来源
+    void* free_lists_[kMaxSmall / kAlignment];      // 各级别小块的空闲链表，空闲块的开头保存下一个空闲块
+    void* medium_lists_[12];                        // 各级别中等块（1KB到2MB）的空闲链表
+    char* cursor_;                                  // 当前slab中未切分部分的开头
+    char* slab_end_;                                // 当前slab的末尾
+
+    /**
+     * 中等块的级别
+     * @param bytes 字节数，在kMaxSmall和kLargePageBytes之间
+     * @return 级别，该级别的块大小为kMinMedium << 级别
+     */
+    static size_t mediumClass(size_t bytes);
+};
+
+/**
+ * 使用SlabAllocator的标准库分配器
+ * 没有绑定SlabAllocator时使用全局operator new，容器类型不随是否启用大页变化
+ */
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;  // 移动赋值时一并换成新的分配器
+
+    ArenaAllocator() noexcept : slabs_(nullptr) {}
+    explicit ArenaAllocator(SlabAllocator* slabs) noexcept : slabs_(slabs) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : slabs_(other.slabs()) {}
+
+    T* allocate(size_t n) {
+        if (!slabs_) {
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        }
+        return static_cast<T*>(slabs_->allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* memory, size_t n) noexcept {
+        if (!slabs_) {
+            ::operator delete(memory);
+            return;
+        }
+        slabs_->deallocate(memory, n * sizeof(T));
+    }
+
+    SlabAllocator* slabs() const noexcept { return slabs_; }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept { return slabs_ == other.slabs(); }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const noexcept { return slabs_ != other.slabs(); }
+
+private:
+    SlabAllocator* slabs_;   // 绑定的分配器，为空时使用operator new
+};
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+/**
+ * 键的哈希
+ * 本地存储选择分片、负缓存和限流器选择桶都使用这里的哈希，保证同一个键在各处分布一致
+ *
+ * - 混合：std::hash对短字符串的低位分布不均，先把高位混合到低位，再取低位作为分片或桶的下标
+ * - 指纹：组相联的表只保存64位指纹而不保存键，两个不同的键指纹相同的概率约为2^-64，可以忽略
+ */
+class KeyHash {
+public:
+    /**
+     * 混合后的哈希值
+     * @param key 键
+     * @return 哈希值，低位可以直接用作下标
+     */
+    static uint64_t mix(const std::string& key) {
+        uint64_t hash = std::hash<std::string>()(key);
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+    /**
+     * 键的指纹，0保留给空条目
+     * @param key 键
+     * @return 非0的指纹
+     */
+    static uint64_t fingerprint(const std::string& key) {
+        uint64_t hash = mix(key);
+        return hash != 0 ? hash : 1;
+    }
+};
\ No newline at end of file
@@ -0,0 +1,612 @@
+#pragma once
+
+#include "art_index.h"
+#include "background_freer.h"
+#include "cache_entry.h"
+#include "huge_page_arena.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * 一个命名空间在本节点上的统计
+ */
+struct NamespaceStats {
+    std::string name;       // 命名空间名称
+    uint64_t quota_bytes;   // 内存配额（字节），0表示不限制
+    int64_t bytes;          // 占用的内存（估算）
+    int64_t keys;           // 键数量
+    uint64_t hits;          // 读取命中次数
+    uint64_t misses;        // 读取未命中次数
+    uint64_t evictions;     // 因超出配额被淘汰的键数量
+};
+
+/**
+ * 本节点的键值存储
+ * 按键的哈希分成多个分片，每个分片有独立的互斥锁，不同分片上的操作互不阻塞。
+ * 读-改-写操作（自增、比较并交换、租约写入）在键所在分片的锁内一次完成
+ *
+ * 设计特点：
+ * - 分片锁：分片数为2的幂，分片结构按缓存行对齐，避免相邻分片的锁互相干扰
+ * - 版本号：每次修改从全局递增计数器取得新版本，键删除后重建也不会与旧版本重复
+ * - 惰性过期：读取时删除已硬过期的条目，后台分批扫描回收不再被访问的过期条目
+ * - 租约：与键值保存在同一分片中，写入和删除时在同一把锁内使租约失效
+ * - 可选的基数树索引：键有长公共前缀时比哈希表省内存，并且按键有序，前缀遍历只访问匹配的子树
+ * - 惰性释放：删除或覆盖大值时只在锁内摘下条目，内存交给后台线程释放，锁的持有时间与值的大小无关
+ * - 命名空间：键中第一个冒号之前的部分为命名空间，已创建的命名空间各自统计内存并按配额淘汰，
+ *   互不挤占；未创建的前缀和不含冒号的键归入默认命名空间
+ * - 可选的大页内存：哈希表的节点和桶数组分配在2MB或1GB大页上，随机访问大表时减少TLB未命中
+ */
+class LocalStore {
+public:
+    /**
+     * 构造函数
+     * @param shard_count 分片数量，向上取整到2的幂
+     * @param art_index 是否用自适应基数树代替哈希表索引键
+     * @param lazy_free_bytes 值达到该字节数的条目交给后台线程释放，0表示总是就地释放
+     * @param huge_page_bytes 哈希表索引使用的页大小（2MB或1GB），0表示使用普通的堆内存
+     * @param shard_nodes 使用大页时第i个分片的内存放在shard_nodes[i % 大小]号NUMA节点上，为空时不指定节点
+     */
+    explicit LocalStore(size_t shard_count = 16, bool art_index = false, size_t lazy_free_bytes = 0,
+                        size_t huge_page_bytes = 0, const std::vector<int>& shard_nodes = std::vector<int>());
+
+    /**
+     * 读取值
+     * @param key 缓存键
+     * @param value 输出参数，存储读取到的值
+     * @param meta 输出参数（可为空），值的元数据
+     * @param claim_refresh 是否允许本次读取领取刷新任务
+     * @return 键存在且未硬过期时返回true
+     */
+    bool get(const std::string& key, std::string& value, ReadMeta* meta = nullptr, bool claim_refresh = false);
+
+    /**
+     * 写入值，未完成的租约随之失效
+     * @param key 缓存键
+     * @param value 缓存值
+     * @param ttl 过期参数
+     * @return 新版本
+     */
+    uint64_t set(const std::string& key, const std::string& value, const EntryTtl& ttl = EntryTtl());
+
+    /**
+     * 键不存在（或已硬过期）时写入值
+     * @param key 缓存键
+     * @param value 输入要写入的值；键已存在时输出当前值
+     * @return 是否写入
+     */
+    bool insertIfAbsent(const std::string& key, std::string& value);
+
+    /**
+     * 删除键，未完成的租约随之失效
+     * @param key 缓存键
+     * @param old_value 输出参数（可为空），被删除的值；交给后台释放的大值不输出，此时为空
+     * @return 键存在且未硬过期时返回true
+     */
+    bool del(const std::string& key, std::string* old_value = nullptr);
+
+    /**
+     * 把十进制整数值加上delta，键不存在时视为0
+     * 保留原有的过期时间
+     * @param key 缓存键
+     * @param delta 增量，可以为负
+     * @param result 输出参数，运算后的值
+     * @return Ok；值不是整数或运算溢出时返回Invalid
+     */
+    OpStatus incr(const std::string& key, int64_t delta, int64_t& result);
+
+    /**
+     * 比较并交换：当前版本等于expected_version时写入
+     * @param key 缓存键
+     * @param value 要写入的值
+     * @param expected_version 期望的版本，0表示要求键不存在
+     * @param version 输出参数，成功时为新版本，失败时为当前版本（键不存在时为0）
+     * @return Ok或Conflict
+     */
+    OpStatus compareAndSwap(const std::string& key, const std::string& value,
+                            uint64_t expected_version, uint64_t& version);
+
+    /**
+     * 在值的末尾追加数据，键不存在时视为空值
+     * 原地追加，不复制已有内容；保留原有的过期时间
+     * @param key 缓存键
+     * @param data 追加的数据
+     * @param length 输出参数，追加后的值长度
+     * @return Ok；追加后超过kMaxValueSize时返回Invalid
+     */
+    OpStatus append(const std::string& key, const std::string& data, size_t& length);
+
+    /**
+     * 读取值的一段，只复制这一段
+     * @param key 缓存键
+     * @param start 起始位置（包含），负数表示从末尾倒数
+     * @param end 结束位置（包含），负数表示从末尾倒数
+     * @param value 输出参数，读取到的片段，范围为空时为空串
+     * @param length 输出参数，完整值的长度
+     * @return 键存在且未硬过期时返回true
+     */
+    bool getRange(const std::string& key, int64_t start, int64_t end, std::string& value, size_t& length);
+
+    /**
+     * 从offset开始覆盖写入数据，值不够长时先用零字节补齐，键不存在时视为空值
+     * 保留原有的过期时间
+     * @param key 缓存键
+     * @param offset 写入位置
+     * @param data 写入的数据
+     * @param length 输出参数，写入后的值长度
+     * @return Ok；写入后超过kMaxValueSize时返回Invalid
+     */
+    OpStatus setRange(const std::string& key, size_t offset, const std::string& data, size_t& length);
+
+    /**
+     * 读取哈希字段
+     * @param key 缓存键
+     * @param fields 输入要读取的字段名，输出各字段是否存在及字段值；为空时读取全部字段
+     * @return Ok；键不存在时返回NotFound；键不是哈希类型时返回Invalid
+     */
+    OpStatus hashGet(const std::string& key, std::vector<FieldValue>& fields);
+
+    /**
+     * 写入哈希字段，键不存在时创建，保留原有的过期时间
+     * @param key 缓存键
+     * @param fields 要写入的字段
+     * @param added 输出参数，新增的字段数量
+     * @return Ok；键不是哈希类型时返回Invalid
+     */
+    OpStatus hashSet(const std::string& key, const std::vector<FieldValue>& fields, size_t& added);
+
+    /**
+     * 删除哈希字段，最后一个字段删除后键也被删除
+     * @param key 缓存键
+     * @param fields 要删除的字段名
+     * @param removed 输出参数，实际删除的字段数量
+     * @return Ok；键不存在时返回NotFound；键不是哈希类型时返回Invalid
+     */
+    OpStatus hashDel(const std::string& key, const std::vector<std::string>& fields, size_t& removed);
+
+    /**
+     * 原子地写入多个键
+     * 按分片编号顺序锁住涉及的所有分片后检查条件并写入，其他线程看不到只写了一部分的中间状态
+     * @param entries 键值对，同一个键出现多次时以最后一次为准
+     * @param ttl 过期参数，作用于所有键
+     * @param condition 写入的前提条件
+     * @return Ok；条件不满足时返回Conflict，此时没有任何键被修改
+     */
+    OpStatus multiSet(const std::vector<std::pair<std::string, std::string>>& entries, const EntryTtl& ttl,
+                      WriteCondition condition);
+
+    /**
+     * 原子地删除多个键
+     * @param keys 要删除的键
+     * @param removed 输出参数，实际删除的键及其旧值（交给后台释放的大值为空）
+     */
+    void multiDel(const std::vector<std::string>& keys, std::vector<std::pair<std::string, std::string>>& removed);
+
+    /**
+     * 把范围规整到[0, length)内
+     * 负数位置从末尾倒数，越界的部分截掉
+     * @param start 输入输出参数，起始位置（包含）
+     * @param end 输入输出参数，结束位置（包含）
+     * @param length 值的长度
+     * @return 规整后的范围非空时返回true
+     */
+    static bool clampRange(int64_t& start, int64_t& end, size_t length);
+
+    static constexpr size_t kMaxValueSize = 512 * 1024 * 1024;   // 追加和范围写入允许的最大值长度
+    static constexpr size_t kMaxScanCount = 10000;               // 一次遍历最多检查的条目数
+    static constexpr const char* kDefaultNamespace = "_default";  // 默认命名空间的名称
+    static constexpr size_t kEvictionSamples = 8;                // 每次淘汰比较的候选键数量
+    static constexpr size_t kEvictionScanLimit = 256;            // 每次淘汰最多检查的条目数
+    static constexpr size_t kEvictionsPerWrite = 16;             // 一次写入最多淘汰的键数量
+
+    /**
+     * 租约获取
+     * 键存在时返回当前值；否则没有有效租约时发放新租约，已有他人持有的租约时告知等待
+     * @param key 缓存键
+     * @param lease_ttl 新租约的有效期
+     * @param result 输出参数，租约获取结果（不包含旧值）
+     */
+    void leaseGet(const std::string& key, std::chrono::milliseconds lease_ttl, LeaseResult& result);
+
+    /**
+     * 租约写入，只有租约仍然有效时才写入
+     * @param key 缓存键
+     * @param value 缓存值
+     * @param token 租约令牌
+     * @return 租约有效并已写入时返回true
+     */
+    bool leaseSet(const std::string& key, const std::string& value, uint64_t token);
+
+    /**
+     * 清理已经过期的租约
+     */
+    void purgeLeases();
+
+    /**
+     * 分批清理已经硬过期的条目
+     */
+    void sweepExpired();
+
+    /**
+     * 键数量（包括尚未被清理的过期条目）
+     * @return 键数量
+     */
+    size_t size();
+
+    /**
+     * 等待后台释放的条目数量
+     * @return 条目数量，未启用惰性释放时为0
+     */
+    size_t lazyFreePending() const { return freer_ ? freer_->pending() : 0; }
+
+    /**
+     * 已经在后台释放的条目数量
+     * @return 条目数量，未启用惰性释放时为0
+     */
+    uint64_t lazyFreed() const { return freer_ ? freer_->freed() : 0; }
+
+    /**
+     * 哈希表索引映射的内存
+     * @param kind 页面类型
+     * @return 字节数，未启用大页时为0
+     */
+    uint64_t hugePageBytes(PageKind kind) const;
+
+    /**
+     * 键所在的分片编号
+     * @param key 缓存键
+     * @return 分片编号，小于shardCount()
+     */
+    size_t shardOf(const std::string& key) const;
+
+    /**
+     * 分片数量
+     * @return 分片数量
+     */
+    size_t shardCount() const { return shard_mask_ + 1; }
+
+    /**
+     * 创建命名空间或修改其配额
+     * 创建时把已有的同前缀键从默认命名空间转入，需要逐个分片检查一遍
+     * @param name 命名空间名称，kDefaultNamespace表示默认命名空间
+     * @param quota_bytes 内存配额（字节），0表示不限制
+     * @return 名称为空、包含冒号或以下划线开头（kDefaultNamespace除外）时返回false
+     */
+    bool setNamespace(const std::string& name, uint64_t quota_bytes);
+
+    /**
+     * 删除命名空间，其中的键保留并归入默认命名空间
+     * @param name 命名空间名称
+     * @return 命名空间存在（且不是默认命名空间）时返回true
+     */
+    bool removeNamespace(const std::string& name);
+
+    /**
+     * 各命名空间的统计，默认命名空间排在最前
+     * @return 统计列表
+     */
+    std::vector<NamespaceStats> namespaceStats();
+
+    /**
+     * 淘汰超出配额的命名空间中的键，直到回到配额以内
+     * 写入时只在写入的分片上淘汰，配额调低或键集中在少数分片时由这里补齐
+     */
+    void enforceQuotas();
+
+    /**
+     * 按游标分批遍历键，不在两次调用之间保存任何状态
+     * 每次只持有一个分片的锁并检查最多count个条目。哈希表索引的游标记录桶下标和发出游标时的桶数量，
+     * 分片在两次调用之间扩容时从该分片的第一个桶重新开始，因此遍历期间一直存在的键至少返回一次，
+     * 但可能重复返回；基数树索引的游标记录最后检查的键，每个键恰好返回一次
+     * @param cursor 游标，"0"表示从头开始
+     * @param count 本次最多检查的条目数，取值限制在[1, kMaxScanCount]
+     * @param match glob模式（支持*、?、[...]和\转义），为空时不过滤
+     * @param keys 输出参数，追加本次找到的键
+     * @param next 输出参数，下一次调用使用的游标，遍历结束时为"0"
+     * @return 游标格式不正确时返回false
+     */
+    bool scan(const std::string& cursor, size_t count, const std::string& match,
+              std::vector<std::string>& keys, std::string& next);
+
+    /**
+     * 按游标分批删除匹配的键，游标格式和遍历规则与scan相同
+     * 每次调用只持有一个分片的锁并检查最多count个条目，未完成的租约随之失效；大值交给后台释放
+     * @param cursor 游标，"0"表示从头开始
+     * @param count 本次最多检查的条目数，取值限制在[1, kMaxScanCount]
+     * @param match glob模式，为空时删除全部
+     * @param keys 输出参数，追加本次删除的键
+     * @param next 输出参数，下一次调用使用的游标，删除结束时为"0"
+     * @return 游标格式不正确时返回false
+     */
+    bool deleteMatching(const std::string& cursor, size_t count, const std::string& match,
+                        std::vector<std::string>& keys, std::string& next);
+
+    /**
+     * 检查字符串是否匹配glob模式，规则与Redis的KEYS/SCAN相同
+     * @param pattern glob模式
+     * @param text 要检查的字符串
+     * @return 是否匹配
+     */
+    static bool globMatch(const std::string& pattern, const std::string& text);
+
+private:
+    /**
+     * 未命中时发放的租约
+     */
+    struct Lease {
+        uint64_t token;                                      // 租约令牌
+        std::chrono::steady_clock::time_point expires_at;    // 租约过期时间
+    };
+
+    /**
+     * 命名空间在一个分片上的用量
+     * 只在持有该分片的锁时修改，统计时不加锁读取
+     */
+    struct NamespaceUsage {
+        std::atomic<int64_t> bytes{0};         // 占用的内存（估算）
+        std::atomic<int64_t> keys{0};          // 键数量
+        std::atomic<uint64_t> hits{0};         // 读取命中次数
+        std::atomic<uint64_t> misses{0};       // 读取未命中次数
+        std::atomic<uint64_t> evictions{0};    // 被淘汰的键数量
+        std::string evict_from;                // 基数树索引：下一次淘汰抽样的起始键
+    };
+
+    /**
+     * 一个命名空间：独立的内存配额、淘汰范围和统计
+     */
+    struct Namespace {
+        std::string name;                           // 名称
+        std::atomic<uint64_t> quota_bytes;          // 内存配额（字节），0表示不限制
+        std::unique_ptr<NamespaceUsage[]> usage;    // 每个分片一份用量
+    };
+
+    /**
+     * 哈希表索引，未启用大页时分配器退化为operator new
+     */
+    using EntryMap = std::unordered_map<std::string, CacheEntry, std::hash<std::string>, std::equal_to<std::string>,
+                                        ArenaAllocator<std::pair<const std::string, CacheEntry>>>;
+
+    /**
+     * 一个分片
+     */
+    struct alignas(64) Shard {
+        std::mutex mutex;                                        // 保护本分片的互斥锁
+        std::unique_ptr<SlabAllocator> slabs;                    // 大页分配器，未启用大页时为空，须先于entries构造
+        EntryMap entries;                                        // 键值（哈希表索引）
+        std::unique_ptr<ArtIndex> tree;                          // 键值（基数树索引），非空时不使用entries
+        std::unordered_map<std::string, Lease> leases;           // 键到未完成租约的映射
+        std::unordered_map<std::string, Namespace*> namespaces;  // 已创建的命名空间，为空时所有键都属于默认命名空间
+        size_t index;                                            // 分片编号
+        uint64_t random;                                         // 淘汰抽样用的随机数状态
+    };
+
+    std::vector<std::unique_ptr<HugePageArena>> arenas_;  // 大页内存来源，每个NUMA节点一个，须晚于shards_析构
+    std::unique_ptr<Shard[]> shards_;          // 分片数组
+    size_t shard_mask_;                        // 分片数量减一
+    std::atomic<uint64_t> next_version_;       // 上一个分配的版本
+    std::atomic<uint64_t> next_lease_token_;   // 上一个发放的租约令牌
+    size_t lazy_free_bytes_;                   // 交给后台释放的值的最小字节数
+    std::unique_ptr<BackgroundFreer> freer_;   // 后台释放器，未启用惰性释放时为空
+    std::unique_ptr<Namespace> default_namespace_;                          // 默认命名空间
+    std::unordered_map<std::string, std::unique_ptr<Namespace>> namespaces_;  // 已创建的命名空间
+    std::mutex namespaces_mutex_;              // 串行化命名空间的创建、修改和删除
+
+    /**
+     * 获取键所在的分片
+     * @param key 缓存键
+     * @return 分片
+     */
+    Shard& shardFor(const std::string& key);
+
+    /**
+     * 按分片编号从小到大锁住一组键涉及的所有分片
+     * 所有多分片操作都按同一顺序加锁，不会互相死锁
+     * @param keys 缓存键
+     * @return 持有的锁，析构时释放
+     */
+    std::vector<std::unique_lock<std::mutex>> lockShards(const std::vector<std::string>& keys);
+
+    /**
+     * 查找未硬过期的条目，不存在时创建一个空值条目
+     * 调用方必须持有分片的锁
+     * @param shard 分片
+     * @param key 缓存键
+     * @param now 当前时间（steady_clock纳秒）
+     * @return 条目
+     */
+    CacheEntry& findOrCreate(Shard& shard, const std::string& key, int64_t now);
+
+    /**
+     * 查找未硬过期的条目，已硬过期的条目顺便删除
+     * 调用方必须持有分片的锁
+     * @param shard 分片
+     * @param key 缓存键
+     * @param now 当前时间（steady_clock纳秒）
+     * @return 条目指针，不存在时为空
+     */
+    CacheEntry* findLive(Shard& shard, const std::string& key, int64_t now);
+
+    /**
+     * 在分片的索引（哈希表或基数树）中查找条目，不检查过期
+     * 调用方必须持有分片的锁
+     * @param shard 分片
+     * @param key 缓存键
+     * @return 条目指针，不存在时为空
+     */
+    static CacheEntry* findEntry(Shard& shard, const std::string& key);
+
+    /**
+     * 在分片的索引中查找条目，不存在时插入默认构造的条目
+     * 调用方必须持有分片的锁
+     * @param shard 分片
+     * @param key 缓存键
+     * @return 条目
+     */
+    static CacheEntry& insertEntry(Shard& shard, const std::string& key);
+
+    /**
+     * 从分片的索引中删除条目，大值交给后台释放
+     * 调用方必须持有分片的锁
+     * @param shard 分片
+     * @param key 缓存键
+     * @param old_value 输出参数（可为空），被删除的值；交给后台释放的大值不输出
+     */
+    void eraseEntry(Shard& shard, const std::string& key, std::string* old_value = nullptr);
+
+    /**
+     * 遍历或删除一批键，scan和deleteMatching的共同实现
+     * @param cursor 游标
+     * @param count 本次最多检查的条目数
+     * @param match glob模式
+     * @param erase 是否删除找到的键
+     * @param keys 输出参数，追加本次找到的键
+     * @param next 输出参数，下一次的游标
+     * @return 游标格式不正确时返回false
+     */
+    bool scanBatch(const std::string& cursor, size_t count, const std::string& match, bool erase,
+                   std::vector<std::string>& keys, std::string& next);
+
+    /**
+     * 删除一批键及其租约
+     * 调用方必须持有分片的锁
+     * @param shard 分片
+     * @param keys 缓存键
+     * @param from 从keys的这个下标开始删除
+     */
+    void eraseKeys(Shard& shard, const std::vector<std::string>& keys, size_t from);
+
+    /**
+     * 创建命名空间对象，每个分片一份用量
+     * @param name 名称
+     * @param quota_bytes 内存配额
+     * @return 命名空间
+     */
+    std::unique_ptr<Namespace> newNamespace(const std::string& name, uint64_t quota_bytes);
+
+    /**
+     * 键所属的命名空间
+     * 调用方必须持有分片的锁
+     * @param shard 键所在的分片
+     * @param key 缓存键
+     * @return 命名空间，未创建的前缀返回默认命名空间
+     */
+    Namespace* namespaceOf(Shard& shard, const std::string& key);
+
+    /**
+     * 条目占用的内存（估算）：键、条目结构和值
+     * @param key 缓存键
+     * @param entry 条目
+     * @return 字节数
+     */
+    static size_t entryBytes(const std::string& key, const CacheEntry& entry);
+
+    /**
+     * 命名空间在所有分片上占用的内存之和
+     * @param ns 命名空间
+     * @return 字节数
+     */
+    int64_t namespaceBytes(const Namespace& ns) const;
+
+    /**
+     * 把条目的大小变化计入所属命名空间，变大且超出配额时在本分片上淘汰
+     * 调用方必须持有分片的锁，并且调用之后不再使用本分片中的条目引用
+     * @param shard 分片
+     * @param key 缓存键
+     * @param before 修改前的entryBytes，新键为0
+     * @param after 修改后的entryBytes，删除为0
+     */
+    void charge(Shard& shard, const std::string& key, size_t before, size_t after);
+
+    /**
+     * 只把条目的大小变化计入所属命名空间，不淘汰，由调用方决定何时淘汰
+     * 调用方必须持有分片的锁
+     * @param shard 分片
+     * @param key 缓存键
+     * @param before 修改前的entryBytes，新键为0
+     * @param after 修改后的entryBytes，删除为0
+     * @return 变大且超出配额时返回所属命名空间，否则为空
+     */
+    Namespace* account(Shard& shard, const std::string& key, size_t before, size_t after);
+
+    /**
+     * 在一个分片上淘汰命名空间中最久未访问的键，直到回到配额以内
+     * 调用方必须持有分片的锁
+     * @param shard 分片
+     * @param ns 命名空间
+     * @param keep 不淘汰的键（刚写入的键，多键写入时为整批键）
+     * @param limit 最多淘汰的键数量
+     * @return 淘汰的键数量
+     */
+    size_t evict(Shard& shard, Namespace& ns, const std::unordered_set<std::string>& keep, size_t limit);
+
+    /**
+     * 抽样选出命名空间中最久未访问的键
+     * 从随机位置（基数树索引为上次抽样结束的位置）开始检查最多kEvictionScanLimit个条目，
+     * 在属于该命名空间的前kEvictionSamples个中选择
+     * 调用方必须持有分片的锁
+     * @param shard 分片
+     * @param ns 命名空间
+     * @param keep 不选择的键
+     * @param victim 输出参数，选中的键
+     * @return 找到候选键时返回true
+     */
+    bool sampleVictim(Shard& shard, Namespace& ns, const std::unordered_set<std::string>& keep, std::string& victim);
+
+    /**
+     * 释放条目占用的值，大值移交给后台线程，小值就地释放
+     * 调用方必须持有分片的锁，条目随后会被删除或覆盖
+     * @param entry 条目，大值返回时已被移走
+     */
+    void dispose(CacheEntry& entry);
+
+    /**
+     * 条目是否应该交给后台释放
+     * @param entry 条目
+     * @return 启用了惰性释放且条目是大值时返回true
+     */
+    bool lazyFreeable(const CacheEntry& entry) const;
+
+    /**
+     * 分批清理基数树索引中已经硬过期的条目
+     * @param shard 分片，调用方不持有其锁
+     */
+    void sweepTree(Shard& shard);
+
+    /**
+     * 提取glob模式开头不含通配符的部分
+     * @param pattern glob模式
+     * @return 字面前缀
+     */
+    static std::string globPrefix(const std::string& pattern);
+
+    /**
+     * 把字节串编码为十六进制
+     * @param bytes 原始字节
+     * @return 十六进制字符串
+     */
+    static std::string toHex(const std::string& bytes);
+
+    /**
+     * 解码十六进制字符串
+     * @param hex 十六进制字符串
+     * @param bytes 输出参数，原始字节
+     * @return 格式正确时返回true
+     */
+    static bool fromHex(const std::string& hex, std::string& bytes);
+
+    /**
+     * 匹配glob模式中的一个字符类[...]
+     * @param pattern glob模式
+     * @param pos 输入'['的位置，输出字符类之后的位置
+     * @param c 要匹配的字符
+     * @return 是否匹配
+     */
+    static bool matchClass(const std::string& pattern, size_t& pos, char c);
+};
\ No newline at end of file
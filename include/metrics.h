@@ -0,0 +1,305 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * 被统计的操作类型
+ * 覆盖对外的缓存操作、本地存储操作以及发往其他节点的gRPC调用
+ */
+enum class MetricOp {
+    Get,         // CacheServer::get
+    Set,         // CacheServer::set
+    Del,         // CacheServer::del
+    MGet,        // CacheServer::mget
+    Incr,        // CacheServer::incr
+    Cas,         // CacheServer::compareAndSwap
+    Append,      // CacheServer::append
+    GetRange,    // CacheServer::getRange
+    SetRange,    // CacheServer::setRange
+    HashGet,     // CacheServer::hashGet
+    HashSet,     // CacheServer::hashSet
+    HashDel,     // CacheServer::hashDel
+    MultiSet,    // CacheServer::multiSet
+    MultiDel,    // CacheServer::multiDel
+    Scan,        // CacheServer::scan
+    DeleteMatching,  // CacheServer::deleteMatching
+    ConfigureNamespace,  // CacheServer::configureNamespace
+    GetLocal,    // 本地存储读取
+    SetLocal,    // 本地存储写入
+    DelLocal,    // 本地存储删除
+    RpcGet,      // 转发到远程节点的Get调用
+    RpcSet,      // 转发到远程节点的Set调用
+    RpcDel,      // 转发到远程节点的Delete调用
+    RpcMGet,     // 转发到远程节点的MGet调用
+    RpcHealth,   // 远程节点健康检查
+    RpcHotKeys,  // 获取远程节点热点键
+    RpcPushReplicas,  // 向其他节点推送热点副本
+    RpcInvalidate,    // 向其他节点发送失效通知
+    RpcLeaseGet,      // 转发到远程节点的LeaseGet调用
+    RpcLeaseSet,      // 转发到远程节点的LeaseSet调用
+    RpcIncr,          // 转发到远程节点的Incr调用
+    RpcCompareAndSwap,  // 转发到远程节点的CompareAndSwap调用
+    RpcAppend,        // 转发到远程节点的Append调用
+    RpcGetRange,      // 转发到远程节点的GetRange调用
+    RpcSetRange,      // 转发到远程节点的SetRange调用
+    RpcHashGet,       // 转发到远程节点的HashGet调用
+    RpcHashSet,       // 转发到远程节点的HashSet调用
+    RpcHashDel,       // 转发到远程节点的HashDel调用
+    RpcMultiSet,      // 转发到远程节点的MultiSet调用
+    RpcMultiDel,      // 转发到远程节点的MultiDel调用
+    RpcScan,          // 遍历远程节点的键
+    RpcDeleteMatching,  // 向远程节点提交按模式删除任务
+    RpcConfigureNamespace,  // 在远程节点上配置命名空间
+    Count        // 操作类型数量，不是真实操作
+};
+
+/**
+ * 全局计数器类型
+ */
+enum class MetricCounter {
+    Hits,        // 读取命中次数
+    Misses,      // 读取未命中次数
+    LocalOps,    // 由本节点直接处理的操作次数
+    Forwarded,   // 转发到其他节点的操作次数
+    ReplicaHits, // 由热点副本直接返回的读取次数
+    NearHits,    // 由近端缓存直接返回的读取次数
+    NegativeHits,// 由负缓存直接返回"不存在"的读取次数
+    Coalesced,   // 合并到其他在途请求、没有单独执行的读取次数
+    Loads,       // 本地未命中时通过加载函数读取的次数
+    LeasesGranted,    // 发放的租约数量
+    LeaseWaits,       // 租约被他人持有、被告知等待的未命中次数
+    LeaseRejects,     // 因租约无效被拒绝的写入次数
+    Count        // 计数器数量，不是真实计数器
+};
+
+/**
+ * 直方图快照
+ * 多个分片合并后的桶计数，用于计算分位数和输出Prometheus格式
+ */
+struct HistogramSnapshot {
+    std::vector<uint64_t> counts;   // 各个桶的计数
+    uint64_t count;                 // 样本总数
+    uint64_t sum;                   // 样本值总和（纳秒）
+
+    HistogramSnapshot();
+
+    /**
+     * 计算分位数
+     * @param quantile 分位点（0~1）
+     * @return 分位数对应的值（纳秒），为所在桶的上界
+     */
+    uint64_t valueAtQuantile(double quantile) const;
+
+    /**
+     * 统计小于等于给定值的样本数
+     * @param value_ns 上界（纳秒）
+     * @return 样本数
+     */
+    uint64_t countAtOrBelow(uint64_t value_ns) const;
+};
+
+/**
+ * HDR风格的延迟直方图
+ * 按2的幂分级，每级再线性划分16个子桶，在1纳秒到约73分钟的范围内相对误差不超过1/16
+ * 所有字段都是原子变量，记录时只做relaxed原子加法，不加锁
+ */
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 4;                       // 每级子桶数量的位数
+    static constexpr int kSubBuckets = 1 << kSubBucketBits;        // 每级子桶数量
+    static constexpr int kMaxExponent = 41;                        // 可表示的最大值的位数
+    static constexpr int kBucketCount = (kMaxExponent - kSubBucketBits + 2) * kSubBuckets;  // 桶总数
+
+    LatencyHistogram();
+
+    /**
+     * 记录一个样本
+     * @param value_ns 样本值（纳秒）
+     */
+    void record(uint64_t value_ns);
+
+    /**
+     * 把当前计数累加到快照中
+     * @param snapshot 目标快照
+     */
+    void mergeInto(HistogramSnapshot& snapshot) const;
+
+    /**
+     * 计算样本值所在的桶下标
+     * @param value_ns 样本值（纳秒）
+     * @return 桶下标
+     */
+    static int bucketIndex(uint64_t value_ns);
+
+    /**
+     * 计算桶所能表示的最大值
+     * @param index 桶下标
+     * @return 桶上界（纳秒）
+     */
+    static uint64_t bucketUpperBound(int index);
+
+private:
+    std::atomic<uint64_t> counts_[kBucketCount];   // 各个桶的计数
+    std::atomic<uint64_t> sum_;                    // 样本值总和
+};
+
+/**
+ * 指标注册表
+ * 每个操作的延迟直方图、错误数和字节数，以及命中率等全局计数器
+ *
+ * 设计特点：
+ * - 按线程分片：每个线程固定写入一个缓存行对齐的分片，热路径上没有锁也几乎没有缓存行争用
+ * - 读取时合并：导出指标时才合并所有分片，开销由抓取方承担
+ */
+class Metrics {
+public:
+    static constexpr int kShards = 16;   // 分片数量
+
+    Metrics();
+
+    /**
+     * 记录一次操作的耗时
+     * @param op 操作类型
+     * @param latency_ns 耗时（纳秒）
+     */
+    void recordLatency(MetricOp op, uint64_t latency_ns);
+
+    /**
+     * 记录一次操作的错误
+     * @param op 操作类型
+     */
+    void recordError(MetricOp op);
+
+    /**
+     * 记录一次操作传输的字节数
+     * @param op 操作类型
+     * @param bytes_in 接收的字节数
+     * @param bytes_out 发送的字节数
+     */
+    void recordBytes(MetricOp op, uint64_t bytes_in, uint64_t bytes_out);
+
+    /**
+     * 增加全局计数器
+     * @param counter 计数器类型
+     * @param delta 增量
+     */
+    void increment(MetricCounter counter, uint64_t delta = 1);
+
+    /**
+     * 合并所有分片中某个操作的延迟直方图
+     * @param op 操作类型
+     * @return 直方图快照
+     */
+    HistogramSnapshot snapshot(MetricOp op) const;
+
+    /**
+     * 合并所有分片中某个全局计数器的值
+     * @param counter 计数器类型
+     * @return 计数器值
+     */
+    uint64_t counterValue(MetricCounter counter) const;
+
+    /**
+     * 以Prometheus文本格式输出所有指标
+     * @return Prometheus文本
+     */
+    std::string renderPrometheus() const;
+
+    /**
+     * 以Prometheus文本格式输出一个直方图
+     * @param oss 输出流
+     * @param name 指标名称（不含后缀）
+     * @param labels 标签，例如op="get"
+     * @param snapshot 直方图快照
+     */
+    static void appendHistogram(std::ostringstream& oss, const std::string& name,
+                                const std::string& labels, const HistogramSnapshot& snapshot);
+
+    /**
+     * 以Prometheus文本格式输出常用分位数（p50/p90/p99/p999）
+     * @param oss 输出流
+     * @param name 指标名称
+     * @param labels 标签，例如op="get"
+     * @param snapshot 直方图快照
+     */
+    static void appendQuantiles(std::ostringstream& oss, const std::string& name,
+                                const std::string& labels, const HistogramSnapshot& snapshot);
+
+    /**
+     * 获取操作类型的名称
+     * @param op 操作类型
+     * @return 操作名称
+     */
+    static const char* opName(MetricOp op);
+
+    /**
+     * 生成操作类型的Prometheus标签
+     * @param op 操作类型
+     * @return 形如op="get"的标签
+     */
+    static std::string labelFor(MetricOp op);
+
+private:
+    static constexpr int kOpCount = static_cast<int>(MetricOp::Count);
+    static constexpr int kCounterCount = static_cast<int>(MetricCounter::Count);
+
+    /**
+     * 单个操作的统计数据
+     */
+    struct OpStats {
+        LatencyHistogram latency;           // 延迟直方图
+        std::atomic<uint64_t> errors;       // 错误次数
+        std::atomic<uint64_t> bytes_in;     // 接收字节数
+        std::atomic<uint64_t> bytes_out;    // 发送字节数
+
+        OpStats() : errors(0), bytes_in(0), bytes_out(0) {}
+    };
+
+    /**
+     * 一个线程分片，按缓存行对齐避免伪共享
+     */
+    struct alignas(64) Shard {
+        OpStats ops[kOpCount];                          // 各操作的统计数据
+        std::atomic<uint64_t> counters[kCounterCount];  // 全局计数器
+
+        Shard();
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards_;   // 所有分片
+
+    /**
+     * 获取当前线程对应的分片
+     * @return 分片引用
+     */
+    Shard& localShard();
+};
+
+/**
+ * 作用域计时器
+ * 构造时记录开始时间，析构时把耗时写入对应操作的直方图
+ * metrics为空时不做任何事，便于在可选组件中使用
+ */
+class ScopedLatency {
+public:
+    ScopedLatency(Metrics* metrics, MetricOp op)
+        : metrics_(metrics), op_(op),
+          start_(metrics ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point()) {}
+
+    ~ScopedLatency() {
+        if (metrics_) {
+            auto elapsed = std::chrono::steady_clock::now() - start_;
+            metrics_->recordLatency(op_, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        }
+    }
+
+private:
+    Metrics* metrics_;                                   // 指标注册表，可以为空
+    MetricOp op_;                                        // 被计时的操作
+    std::chrono::steady_clock::time_point start_;        // 开始时间
+};
\ No newline at end of file
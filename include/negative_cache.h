@@ -0,0 +1,60 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * 紧凑的负缓存
+ * 记录最近确认不存在的键，只保存键的64位指纹和过期时间，每个条目16字节，与键的长度无关
+ *
+ * 设计特点：
+ * - 组相联：键的指纹（见KeyHash）映射到一个4路的桶，桶满时替换最早过期的条目，容量固定不需要扩容
+ * - 惰性过期：查询时比较过期时间，过期条目在插入时被复用
+ */
+class NegativeCache {
+public:
+    /**
+     * 构造函数
+     * @param capacity 最多保存的条目数量，向上取整到4的倍数和2的幂
+     */
+    explicit NegativeCache(size_t capacity);
+
+    /**
+     * 判断键是否被记录为不存在
+     * @param key 缓存键
+     * @return 存在未过期的条目时返回true
+     */
+    bool contains(const std::string& key);
+
+    /**
+     * 记录键不存在，已存在时刷新过期时间
+     * @param key 缓存键
+     * @param ttl 存活时间
+     */
+    void insert(const std::string& key, std::chrono::milliseconds ttl);
+
+    /**
+     * 删除键的记录
+     * @param key 缓存键
+     * @return 是否存在未过期的条目
+     */
+    bool erase(const std::string& key);
+
+private:
+    static constexpr size_t kWays = 4;  // 每个桶的条目数
+
+    /**
+     * 一个条目，fingerprint为0表示空
+     */
+    struct Slot {
+        uint64_t fingerprint;    // 键的指纹
+        int64_t expires_at;      // 过期时间（steady_clock纳秒）
+    };
+
+    std::mutex mutex_;            // 保护slots_的互斥锁
+    std::vector<Slot> slots_;     // 按桶连续存放的条目
+    size_t bucket_mask_;          // 桶数量减一
+};
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * NUMA拓扑
+ * 从/sys/devices/system/node读取每个节点的CPU，只保留进程亲和性掩码允许的CPU；
+ * 读取失败或不是NUMA机器时视为只有一个节点。不依赖libnuma，内存策略通过系统调用设置
+ */
+class NumaTopology {
+public:
+    /**
+     * 探测当前机器的拓扑
+     * @return 拓扑，至少有一个节点
+     */
+    static NumaTopology detect();
+
+    /**
+     * 节点数量（只计算有可用CPU的节点）
+     * @return 节点数量
+     */
+    size_t nodeCount() const { return cpus_.size(); }
+
+    /**
+     * 节点上可用的CPU
+     * @param node 节点下标，小于nodeCount()
+     * @return CPU编号列表
+     */
+    const std::vector<int>& cpusOf(size_t node) const { return cpus_[node]; }
+
+    /**
+     * CPU所在的节点
+     * @param cpu CPU编号
+     * @return 节点下标，未知的CPU视为节点0
+     */
+    size_t nodeOfCpu(int cpu) const;
+
+    /**
+     * 系统中的节点编号
+     * @param node 节点下标
+     * @return /sys/devices/system/node/nodeN中的N
+     */
+    int nodeId(size_t node) const { return node_ids_[node]; }
+
+    /**
+     * 让当前线程之后分配的内存优先放在指定节点上
+     * 节点内存不足时内核仍会从其他节点分配，不会因此分配失败
+     * @param node 节点下标
+     * @return 设置成功时返回true
+     */
+    bool preferMemory(size_t node) const;
+
+    /**
+     * 让一段尚未访问过的内存优先放在指定节点上，与访问它的线程无关
+     * @param memory 内存的开头，按页对齐
+     * @param bytes 字节数
+     * @param node_id 系统中的节点编号
+     * @return 设置成功时返回true
+     */
+    static bool preferMemory(void* memory, size_t bytes, int node_id);
+
+private:
+    std::vector<std::vector<int>> cpus_;   // 每个节点上可用的CPU
+    std::vector<int> node_ids_;            // 每个节点的系统编号
+    std::vector<size_t> node_of_cpu_;      // CPU编号到节点下标
+
+    /**
+     * 解析cpulist格式（如"0-3,8-11"）
+     * @param text cpulist文本
+     * @return CPU编号列表
+     */
+    static std::vector<int> parseCpuList(const std::string& text);
+};
\ No newline at end of file
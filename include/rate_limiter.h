@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/**
+ * 无锁令牌桶限流器
+ * 按键（客户端地址、API密钥或命名空间）限制请求速率，每个键有独立的令牌桶
+ *
+ * 设计特点：
+ * - 单个原子变量表示令牌桶：只保存"理论到达时间"（GCRA算法，与令牌桶等价），
+ *   放行一个请求就是一次比较并交换，不加锁，不同的键之间互不等待
+ * - 每个缓存行一个桶：一个桶的4个条目正好占满一个缓存行，键按指纹（见KeyHash）分到桶中；
+ *   桶中没有该键时接管理论到达时间最早的条目并从满桶开始，被挤出的键再次出现时同样从满桶开始
+ */
+class RateLimiter {
+public:
+    /**
+     * 构造函数
+     * @param rate 每秒允许的请求数
+     * @param burst 允许的突发请求数（桶容量），不大于0时等于rate
+     * @param capacity 最多同时跟踪的键数量，向上取整到4的倍数和2的幂
+     */
+    RateLimiter(int rate, int burst, size_t capacity);
+
+    /**
+     * 尝试放行一个请求
+     * @param key 限流键
+     * @param retry_after 输出参数，拒绝时为令牌恢复所需的等待时间
+     * @return 令牌充足时返回true并消耗一个令牌
+     */
+    bool allow(const std::string& key, std::chrono::nanoseconds& retry_after);
+
+    /**
+     * 被拒绝的请求数量
+     * @return 请求数量
+     */
+    uint64_t rejected() const { return rejected_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t kWays = 4;  // 每个桶的条目数
+
+    /**
+     * 一个条目，fingerprint为0表示空
+     */
+    struct Slot {
+        std::atomic<uint64_t> fingerprint{0};   // 键的指纹
+        std::atomic<int64_t> tat{0};            // 理论到达时间（steady_clock纳秒），不晚于当前时间表示桶已满
+    };
+
+    /**
+     * 一个桶，独占一个缓存行，不同桶的更新不会互相使缓存失效
+     */
+    struct alignas(64) Bucket {
+        Slot slots[kWays];
+    };
+
+    int64_t interval_;                      // 每个令牌的恢复时间（纳秒）
+    int64_t tolerance_;                     // 理论到达时间最多可以超前当前时间多少（纳秒），决定突发容量
+    std::unique_ptr<Bucket[]> buckets_;     // 所有桶
+    size_t bucket_mask_;                    // 桶数量减一
+    std::atomic<uint64_t> rejected_;        // 被拒绝的请求数量
+
+    /**
+     * 找到键对应的条目，不存在时接管桶中最久空闲的条目
+     * @param fingerprint 键的指纹
+     * @return 条目
+     */
+    Slot& slotOf(uint64_t fingerprint);
+};
\ No newline at end of file
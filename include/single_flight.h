@@ -0,0 +1,98 @@
+#pragma once
+
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/**
+ * 按键合并并发调用
+ * 同一个键同时只有一个调用真正执行，执行期间到达的调用等待并共享它的结果
+ *
+ * 设计特点：
+ * - 只合并在途调用：调用结束后立即移除，下一次调用重新执行，不缓存结果
+ * - 可以提前放弃：forget()之后到达的调用会重新执行，用于键被修改后避免读到修改前开始的结果
+ * - 异常透传：执行的调用抛出异常时，等待者收到同一个异常
+ *
+ * @tparam Result 调用结果类型，需要可复制
+ */
+template <typename Result>
+class SingleFlight {
+public:
+    /**
+     * 执行调用，同一个键已有调用在途时等待它的结果
+     * @param key 合并调用的键
+     * @param fn 实际执行的调用
+     * @param shared 输出参数（可为空），结果来自其他调用时设为true
+     * @return 调用结果
+     */
+    Result run(const std::string& key, const std::function<Result()>& fn, bool* shared = nullptr) {
+        std::shared_ptr<Call> call;
+        bool leader = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = calls_.find(key);
+            if (it != calls_.end()) {
+                call = it->second;
+            } else {
+                call = std::make_shared<Call>();
+                call->future = call->promise.get_future().share();
+                calls_[key] = call;
+                leader = true;
+            }
+        }
+        if (shared) {
+            *shared = !leader;
+        }
+        if (!leader) {
+            return call->future.get();
+        }
+
+        try {
+            Result result = fn();
+            finish(key, call);
+            call->promise.set_value(result);
+            return result;
+        } catch (...) {
+            finish(key, call);
+            call->promise.set_exception(std::current_exception());
+            throw;
+        }
+    }
+
+    /**
+     * 放弃键上的在途调用：已在等待的调用仍会收到结果，之后到达的调用重新执行
+     * @param key 合并调用的键
+     */
+    void forget(const std::string& key) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        calls_.erase(key);
+    }
+
+private:
+    /**
+     * 一次在途调用
+     */
+    struct Call {
+        std::promise<Result> promise;          // 执行者写入结果
+        std::shared_future<Result> future;     // 等待者读取结果
+    };
+
+    std::mutex mutex_;                                                // 保护calls_的互斥锁
+    std::unordered_map<std::string, std::shared_ptr<Call>> calls_;    // 键到在途调用的映射
+
+    /**
+     * 调用结束，移除登记（已被forget或替换时不移除新的调用）
+     * @param key 合并调用的键
+     * @param call 结束的调用
+     */
+    void finish(const std::string& key, const std::shared_ptr<Call>& call) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = calls_.find(key);
+        if (it != calls_.end() && it->second == call) {
+            calls_.erase(it);
+        }
+    }
+};
\ No newline at end of file
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+/**
+ * 有界的单生产者单消费者无锁队列
+ * 只允许一个线程入队、一个线程出队，两端各自只写自己的下标，不需要比较并交换
+ *
+ * 设计特点：
+ * - 环形缓冲区：容量向上取整到2的幂，下标用位与取模
+ * - 读写下标分别独占一个缓存行，生产者和消费者不会因为伪共享互相使缓存失效
+ * - 两端各自缓存对方的下标，只有看起来满或空时才重新读取对方的缓存行
+ */
+template <typename T>
+class SpscQueue {
+public:
+    /**
+     * 构造函数
+     * @param capacity 队列容量，向上取整到2的幂
+     */
+    explicit SpscQueue(size_t capacity) : head_(0), cached_tail_(0), tail_(0), cached_head_(0) {
+        size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        mask_ = size - 1;
+        slots_.reset(new T[size]);
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    /**
+     * 入队，只能由生产者线程调用
+     * @param item 元素
+     * @return 队列已满时返回false
+     */
+    bool push(const T& item) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ > mask_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ > mask_) {
+                return false;
+            }
+        }
+        slots_[tail & mask_] = item;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * 出队，只能由消费者线程调用
+     * @param item 输出参数，队首元素
+     * @return 队列为空时返回false
+     */
+    bool pop(T& item) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cached_tail_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_) {
+                return false;
+            }
+        }
+        item = slots_[head & mask_];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * 队列是否为空，任意线程都可以调用，结果只是一个瞬间的快照
+     * @return 为空时返回true
+     */
+    bool empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+private:
+    alignas(64) std::atomic<size_t> head_;    // 下一个出队的位置，只由消费者写入
+    size_t cached_tail_;                      // 消费者看到的tail_
+    alignas(64) std::atomic<size_t> tail_;    // 下一个入队的位置，只由生产者写入
+    size_t cached_head_;                      // 生产者看到的head_
+    alignas(64) std::unique_ptr<T[]> slots_;  // 环形缓冲区
+    size_t mask_;                             // 容量减一
+};
\ No newline at end of file
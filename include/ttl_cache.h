@@ -0,0 +1,70 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/**
+ * 有界的TTL缓存
+ * 保存其他节点所拥有的键的短期副本，容量满时按LRU淘汰，条目过期后视为不存在
+ *
+ * 设计特点：
+ * - 容量有界：最多保存capacity个条目
+ * - 惰性过期：读取时才检查过期时间，不需要后台清理线程
+ * - 线程安全：所有操作由一把互斥锁保护，临界区只有哈希表和链表操作
+ */
+class TtlCache {
+public:
+    /**
+     * 构造函数
+     * @param capacity 最多保存的条目数量
+     */
+    explicit TtlCache(size_t capacity);
+
+    /**
+     * 读取条目
+     * @param key 缓存键
+     * @param value 输出参数，存储读取到的值
+     * @return 条目存在且未过期时返回true
+     */
+    bool get(const std::string& key, std::string& value);
+
+    /**
+     * 写入条目，已存在时覆盖并刷新过期时间
+     * @param key 缓存键
+     * @param value 缓存值
+     * @param ttl 存活时间
+     */
+    void put(const std::string& key, const std::string& value, std::chrono::milliseconds ttl);
+
+    /**
+     * 删除条目
+     * @param key 缓存键
+     * @return 条目是否存在
+     */
+    bool erase(const std::string& key);
+
+    /**
+     * 当前条目数量（包括尚未被清理的过期条目）
+     * @return 条目数量
+     */
+    size_t size();
+
+private:
+    /**
+     * 缓存条目
+     */
+    struct Entry {
+        std::string key;                                     // 缓存键
+        std::string value;                                   // 缓存值
+        std::chrono::steady_clock::time_point expires_at;    // 过期时间
+    };
+
+    size_t capacity_;                                                        // 最大条目数量
+    std::mutex mutex_;                                                       // 保护以下数据的互斥锁
+    std::list<Entry> lru_;                                                   // 按最近使用排序，表头最新
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;      // 键到链表节点的映射
+};
\ No newline at end of file
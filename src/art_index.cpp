@@ -0,0 +1,820 @@
+#include "art_index.h"
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+/**
+ * 叶子：条目加上从所在位置到键末尾的剩余字节，剩余字节紧跟在结构之后
+ */
+struct ArtIndex::Leaf {
+    CacheEntry entry;     // 条目
+    uint32_t length;      // 剩余键字节数
+
+    char* bytes() { return reinterpret_cast<char*>(this + 1); }
+};
+
+/**
+ * 内部节点的公共部分
+ */
+struct ArtIndex::Node {
+    enum Kind : uint8_t { K4, K16, K48, K256 };
+
+    Kind kind;                   // 节点类型
+    uint16_t count;              // 子节点数量
+    uint32_t prefix_length;      // 压缩前缀的字节数
+    union {
+        char inline_prefix[8];   // 不超过8字节的前缀
+        char* heap_prefix;       // 更长的前缀
+    };
+    Leaf* terminal;              // 恰好在本节点结束的键（例如同时存在a和ab时的a）
+
+    explicit Node(Kind k) : kind(k), count(0), prefix_length(0), terminal(nullptr) {}
+
+    const char* prefix() const { return prefix_length <= sizeof(inline_prefix) ? inline_prefix : heap_prefix; }
+};
+
+/**
+ * 最多4个子节点，分支字节有序排列
+ */
+struct ArtIndex::Node4 : Node {
+    uint8_t keys[4];
+    uintptr_t children[4];
+
+    Node4() : Node(K4) {}
+};
+
+/**
+ * 最多16个子节点，分支字节有序排列
+ */
+struct ArtIndex::Node16 : Node {
+    uint8_t keys[16];
+    uintptr_t children[16];
+
+    Node16() : Node(K16) {}
+};
+
+/**
+ * 最多48个子节点，按分支字节索引到子节点槽位（0表示没有）
+ */
+struct ArtIndex::Node48 : Node {
+    uint8_t index[256];
+    uintptr_t children[48];
+
+    Node48() : Node(K48) {
+        std::memset(index, 0, sizeof(index));
+        std::memset(children, 0, sizeof(children));
+    }
+};
+
+/**
+ * 每个分支字节一个子节点
+ */
+struct ArtIndex::Node256 : Node {
+    uintptr_t children[256];
+
+    Node256() : Node(K256) { std::memset(children, 0, sizeof(children)); }
+};
+
+/**
+ * 构造空树
+ */
+ArtIndex::ArtIndex() : root_(0), size_(0) {}
+
+/**
+ * 析构时释放所有节点和条目
+ */
+ArtIndex::~ArtIndex() {
+    destroy(root_);
+}
+
+/**
+ * 查找条目
+ * 逐层比较节点前缀并按下一个字节选择子节点，到达叶子后比较剩余字节
+ * @param key 缓存键
+ * @return 条目指针，不存在时为空
+ */
+CacheEntry* ArtIndex::find(const std::string& key) {
+    const char* data = key.data();
+    size_t length = key.size();
+    size_t depth = 0;
+    uintptr_t ref = root_;
+
+    while (ref != 0) {
+        if (isLeaf(ref)) {
+            Leaf* leaf = asLeaf(ref);
+            if (leaf->length == length - depth && std::memcmp(leaf->bytes(), data + depth, leaf->length) == 0) {
+                return &leaf->entry;
+            }
+            return nullptr;
+        }
+
+        Node* node = asNode(ref);
+        if (node->prefix_length > length - depth ||
+            std::memcmp(node->prefix(), data + depth, node->prefix_length) != 0) {
+            return nullptr;
+        }
+        depth += node->prefix_length;
+        if (depth == length) {
+            return node->terminal ? &node->terminal->entry : nullptr;
+        }
+
+        uintptr_t* child = findChild(node, static_cast<uint8_t>(data[depth]));
+        if (!child) {
+            return nullptr;
+        }
+        ref = *child;
+        depth++;
+    }
+    return nullptr;
+}
+
+/**
+ * 查找条目，不存在时插入
+ * 与已有叶子分叉时新建节点保存共同部分，已有叶子原地截短剩余字节，不移动条目；
+ * 与节点前缀分叉时在分叉处拆开前缀
+ * @param key 缓存键
+ * @return 条目
+ */
+CacheEntry& ArtIndex::findOrInsert(const std::string& key) {
+    const char* data = key.data();
+    size_t length = key.size();
+    size_t depth = 0;
+    uintptr_t* slot = &root_;
+
+    while (true) {
+        uintptr_t ref = *slot;
+        if (ref == 0) {
+            Leaf* created = newLeaf(data + depth, length - depth);
+            *slot = refOf(created);
+            size_++;
+            return created->entry;
+        }
+
+        if (isLeaf(ref)) {
+            Leaf* leaf = asLeaf(ref);
+            size_t rest = length - depth;
+            size_t common = 0;
+            size_t limit = std::min<size_t>(leaf->length, rest);
+            while (common < limit && leaf->bytes()[common] == data[depth + common]) {
+                common++;
+            }
+            if (common == leaf->length && common == rest) {
+                return leaf->entry;
+            }
+
+            // 两个键在common处分叉，新节点保存共同部分
+            Node4* node = new Node4();
+            setPrefix(node, data + depth, common);
+            uintptr_t node_ref = refOf(node);
+            if (common == leaf->length) {
+                leaf->length = 0;
+                node->terminal = leaf;
+            } else {
+                uint8_t byte = static_cast<uint8_t>(leaf->bytes()[common]);
+                leaf->length -= static_cast<uint32_t>(common + 1);
+                std::memmove(leaf->bytes(), leaf->bytes() + common + 1, leaf->length);
+                addChild(node_ref, node, byte, refOf(leaf));
+            }
+
+            Leaf* created;
+            if (common == rest) {
+                created = newLeaf(nullptr, 0);
+                node->terminal = created;
+            } else {
+                created = newLeaf(data + depth + common + 1, rest - common - 1);
+                addChild(node_ref, node, static_cast<uint8_t>(data[depth + common]), refOf(created));
+            }
+            *slot = node_ref;
+            size_++;
+            return created->entry;
+        }
+
+        Node* node = asNode(ref);
+        size_t common = 0;
+        size_t limit = std::min<size_t>(node->prefix_length, length - depth);
+        const char* prefix = node->prefix();
+        while (common < limit && prefix[common] == data[depth + common]) {
+            common++;
+        }
+
+        if (common < node->prefix_length) {
+            // 在前缀中间分叉：新节点保存前缀的共同部分，原节点挂在分叉字节下并去掉已经表示的部分
+            Node4* parent = new Node4();
+            setPrefix(parent, prefix, common);
+            uintptr_t parent_ref = refOf(parent);
+            uint8_t byte = static_cast<uint8_t>(prefix[common]);
+            std::string remainder(prefix + common + 1, node->prefix_length - common - 1);
+            setPrefix(node, remainder.data(), remainder.size());
+            addChild(parent_ref, parent, byte, ref);
+
+            Leaf* created;
+            if (depth + common == length) {
+                created = newLeaf(nullptr, 0);
+                parent->terminal = created;
+            } else {
+                created = newLeaf(data + depth + common + 1, length - depth - common - 1);
+                addChild(parent_ref, parent, static_cast<uint8_t>(data[depth + common]), refOf(created));
+            }
+            *slot = parent_ref;
+            size_++;
+            return created->entry;
+        }
+
+        depth += node->prefix_length;
+        if (depth == length) {
+            if (!node->terminal) {
+                node->terminal = newLeaf(nullptr, 0);
+                size_++;
+            }
+            return node->terminal->entry;
+        }
+
+        uint8_t byte = static_cast<uint8_t>(data[depth]);
+        uintptr_t* child = findChild(node, byte);
+        if (!child) {
+            Leaf* created = newLeaf(data + depth + 1, length - depth - 1);
+            addChild(*slot, node, byte, refOf(created));
+            size_++;
+            return created->entry;
+        }
+        slot = child;
+        depth++;
+    }
+}
+
+/**
+ * 删除条目
+ * @param key 缓存键
+ * @return 键存在时返回true
+ */
+bool ArtIndex::erase(const std::string& key) {
+    if (!eraseAt(root_, key, 0)) {
+        return false;
+    }
+    size_--;
+    return true;
+}
+
+/**
+ * 按键的字节序遍历不小于start的键
+ * @param start 起始键（包含）
+ * @param visit 遍历回调
+ * @return 遍历完所有键时返回true
+ */
+bool ArtIndex::forEachFrom(const std::string& start, const Visitor& visit) {
+    std::string path;
+    return walk(root_, path, start, true, visit);
+}
+
+/**
+ * 分配叶子
+ * @param bytes 剩余键字节
+ * @param length 剩余键字节数
+ * @return 新叶子
+ */
+ArtIndex::Leaf* ArtIndex::newLeaf(const char* bytes, size_t length) {
+    void* memory = ::operator new(sizeof(Leaf) + length);
+    Leaf* leaf = new (memory) Leaf();
+    leaf->length = static_cast<uint32_t>(length);
+    if (length > 0) {
+        std::memcpy(leaf->bytes(), bytes, length);
+    }
+    return leaf;
+}
+
+/**
+ * 释放叶子
+ * @param leaf 叶子
+ */
+void ArtIndex::freeLeaf(Leaf* leaf) {
+    leaf->~Leaf();
+    ::operator delete(leaf);
+}
+
+/**
+ * 释放内部节点本身
+ * @param node 内部节点
+ */
+void ArtIndex::freeNode(Node* node) {
+    if (node->prefix_length > sizeof(node->inline_prefix)) {
+        delete[] node->heap_prefix;
+    }
+    switch (node->kind) {
+        case Node::K4:
+            delete static_cast<Node4*>(node);
+            break;
+        case Node::K16:
+            delete static_cast<Node16*>(node);
+            break;
+        case Node::K48:
+            delete static_cast<Node48*>(node);
+            break;
+        case Node::K256:
+            delete static_cast<Node256*>(node);
+            break;
+    }
+}
+
+/**
+ * 释放整棵子树
+ * @param ref 子树的根
+ * @return 子树中的键数量
+ */
+size_t ArtIndex::destroy(uintptr_t ref) {
+    if (ref == 0) {
+        return 0;
+    }
+    if (isLeaf(ref)) {
+        freeLeaf(asLeaf(ref));
+        return 1;
+    }
+
+    Node* node = asNode(ref);
+    size_t removed = 0;
+    if (node->terminal) {
+        freeLeaf(node->terminal);
+        removed++;
+    }
+    uint8_t bytes[256];
+    uintptr_t children[256];
+    size_t count = listChildren(node, bytes, children);
+    for (size_t i = 0; i < count; i++) {
+        removed += destroy(children[i]);
+    }
+    freeNode(node);
+    return removed;
+}
+
+/**
+ * 设置节点的压缩前缀
+ * @param node 内部节点
+ * @param bytes 前缀字节
+ * @param length 前缀字节数
+ */
+void ArtIndex::setPrefix(Node* node, const char* bytes, size_t length) {
+    if (node->prefix_length > sizeof(node->inline_prefix)) {
+        delete[] node->heap_prefix;
+    }
+    node->prefix_length = static_cast<uint32_t>(length);
+    if (length <= sizeof(node->inline_prefix)) {
+        if (length > 0) {
+            std::memcpy(node->inline_prefix, bytes, length);
+        }
+    } else {
+        node->heap_prefix = new char[length];
+        std::memcpy(node->heap_prefix, bytes, length);
+    }
+}
+
+/**
+ * 把前缀和终止叶子从旧节点转移到新节点，用于节点升级和降级
+ * @param from 旧节点，转移后不再拥有前缀，可以直接释放
+ * @param to 新节点
+ */
+void ArtIndex::moveHeader(Node* from, Node* to) {
+    to->prefix_length = from->prefix_length;
+    std::memcpy(to->inline_prefix, from->inline_prefix, sizeof(from->inline_prefix));
+    to->terminal = from->terminal;
+    from->prefix_length = 0;
+    from->terminal = nullptr;
+}
+
+/**
+ * 查找子节点
+ * @param node 内部节点
+ * @param byte 分支字节
+ * @return 指向子节点引用的指针，不存在时为空
+ */
+uintptr_t* ArtIndex::findChild(Node* node, uint8_t byte) {
+    switch (node->kind) {
+        case Node::K4: {
+            Node4* n = static_cast<Node4*>(node);
+            for (uint16_t i = 0; i < n->count; i++) {
+                if (n->keys[i] == byte) {
+                    return &n->children[i];
+                }
+            }
+            return nullptr;
+        }
+        case Node::K16: {
+            Node16* n = static_cast<Node16*>(node);
+            for (uint16_t i = 0; i < n->count; i++) {
+                if (n->keys[i] == byte) {
+                    return &n->children[i];
+                }
+            }
+            return nullptr;
+        }
+        case Node::K48: {
+            Node48* n = static_cast<Node48*>(node);
+            return n->index[byte] ? &n->children[n->index[byte] - 1] : nullptr;
+        }
+        case Node::K256: {
+            Node256* n = static_cast<Node256*>(node);
+            return n->children[byte] ? &n->children[byte] : nullptr;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * 添加子节点
+ * 4和16的节点按分支字节有序插入；节点已满时复制到更大的节点，公共部分（前缀、终止叶子）直接转移
+ * @param slot 指向该节点的引用
+ * @param node 内部节点
+ * @param byte 分支字节
+ * @param child 子节点引用
+ */
+void ArtIndex::addChild(uintptr_t& slot, Node* node, uint8_t byte, uintptr_t child) {
+    switch (node->kind) {
+        case Node::K4: {
+            Node4* n = static_cast<Node4*>(node);
+            if (n->count < 4) {
+                uint16_t pos = 0;
+                while (pos < n->count && n->keys[pos] < byte) {
+                    pos++;
+                }
+                std::memmove(n->keys + pos + 1, n->keys + pos, n->count - pos);
+                std::memmove(n->children + pos + 1, n->children + pos, (n->count - pos) * sizeof(uintptr_t));
+                n->keys[pos] = byte;
+                n->children[pos] = child;
+                n->count++;
+                return;
+            }
+            Node16* grown = new Node16();
+            grown->count = n->count;
+            moveHeader(n, grown);
+            std::memcpy(grown->keys, n->keys, n->count);
+            std::memcpy(grown->children, n->children, n->count * sizeof(uintptr_t));
+            freeNode(n);
+            slot = refOf(grown);
+            addChild(slot, grown, byte, child);
+            return;
+        }
+        case Node::K16: {
+            Node16* n = static_cast<Node16*>(node);
+            if (n->count < 16) {
+                uint16_t pos = 0;
+                while (pos < n->count && n->keys[pos] < byte) {
+                    pos++;
+                }
+                std::memmove(n->keys + pos + 1, n->keys + pos, n->count - pos);
+                std::memmove(n->children + pos + 1, n->children + pos, (n->count - pos) * sizeof(uintptr_t));
+                n->keys[pos] = byte;
+                n->children[pos] = child;
+                n->count++;
+                return;
+            }
+            Node48* grown = new Node48();
+            grown->count = n->count;
+            moveHeader(n, grown);
+            for (uint16_t i = 0; i < n->count; i++) {
+                grown->index[n->keys[i]] = static_cast<uint8_t>(i + 1);
+                grown->children[i] = n->children[i];
+            }
+            freeNode(n);
+            slot = refOf(grown);
+            addChild(slot, grown, byte, child);
+            return;
+        }
+        case Node::K48: {
+            Node48* n = static_cast<Node48*>(node);
+            if (n->count < 48) {
+                uint8_t pos = 0;
+                while (n->children[pos] != 0) {
+                    pos++;
+                }
+                n->children[pos] = child;
+                n->index[byte] = static_cast<uint8_t>(pos + 1);
+                n->count++;
+                return;
+            }
+            Node256* grown = new Node256();
+            grown->count = n->count;
+            moveHeader(n, grown);
+            for (int b = 0; b < 256; b++) {
+                if (n->index[b]) {
+                    grown->children[b] = n->children[n->index[b] - 1];
+                }
+            }
+            freeNode(n);
+            slot = refOf(grown);
+            addChild(slot, grown, byte, child);
+            return;
+        }
+        case Node::K256: {
+            Node256* n = static_cast<Node256*>(node);
+            n->children[byte] = child;
+            n->count++;
+            return;
+        }
+    }
+}
+
+/**
+ * 移除子节点
+ * 子节点数量降到下一级容量的3/4左右时降级，避免在边界上反复升降
+ * @param slot 指向该节点的引用
+ * @param node 内部节点
+ * @param byte 分支字节
+ */
+void ArtIndex::removeChild(uintptr_t& slot, Node* node, uint8_t byte) {
+    switch (node->kind) {
+        case Node::K4:
+        case Node::K16: {
+            uint8_t* keys = node->kind == Node::K4 ? static_cast<Node4*>(node)->keys : static_cast<Node16*>(node)->keys;
+            uintptr_t* children = node->kind == Node::K4 ? static_cast<Node4*>(node)->children
+                                                         : static_cast<Node16*>(node)->children;
+            uint16_t pos = 0;
+            while (pos < node->count && keys[pos] != byte) {
+                pos++;
+            }
+            if (pos == node->count) {
+                return;
+            }
+            std::memmove(keys + pos, keys + pos + 1, node->count - pos - 1);
+            std::memmove(children + pos, children + pos + 1, (node->count - pos - 1) * sizeof(uintptr_t));
+            node->count--;
+
+            if (node->kind == Node::K16 && node->count <= 3) {
+                Node4* shrunk = new Node4();
+                shrunk->count = node->count;
+                moveHeader(node, shrunk);
+                std::memcpy(shrunk->keys, keys, node->count);
+                std::memcpy(shrunk->children, children, node->count * sizeof(uintptr_t));
+                freeNode(node);
+                slot = refOf(shrunk);
+            }
+            return;
+        }
+        case Node::K48: {
+            Node48* n = static_cast<Node48*>(node);
+            if (!n->index[byte]) {
+                return;
+            }
+            n->children[n->index[byte] - 1] = 0;
+            n->index[byte] = 0;
+            n->count--;
+
+            if (n->count <= 12) {
+                Node16* shrunk = new Node16();
+                moveHeader(n, shrunk);
+                for (int b = 0; b < 256; b++) {
+                    if (n->index[b]) {
+                        shrunk->keys[shrunk->count] = static_cast<uint8_t>(b);
+                        shrunk->children[shrunk->count] = n->children[n->index[b] - 1];
+                        shrunk->count++;
+                    }
+                }
+                freeNode(n);
+                slot = refOf(shrunk);
+            }
+            return;
+        }
+        case Node::K256: {
+            Node256* n = static_cast<Node256*>(node);
+            if (!n->children[byte]) {
+                return;
+            }
+            n->children[byte] = 0;
+            n->count--;
+
+            if (n->count <= 36) {
+                Node48* shrunk = new Node48();
+                moveHeader(n, shrunk);
+                for (int b = 0; b < 256; b++) {
+                    if (n->children[b]) {
+                        shrunk->children[shrunk->count] = n->children[b];
+                        shrunk->index[b] = static_cast<uint8_t>(shrunk->count + 1);
+                        shrunk->count++;
+                    }
+                }
+                freeNode(n);
+                slot = refOf(shrunk);
+            }
+            return;
+        }
+    }
+}
+
+/**
+ * 按分支字节从小到大列出子节点
+ * @param node 内部节点
+ * @param bytes 输出参数，分支字节
+ * @param children 输出参数，子节点引用
+ * @return 子节点数量
+ */
+size_t ArtIndex::listChildren(Node* node, uint8_t* bytes, uintptr_t* children) {
+    size_t count = 0;
+    switch (node->kind) {
+        case Node::K4: {
+            Node4* n = static_cast<Node4*>(node);
+            for (uint16_t i = 0; i < n->count; i++, count++) {
+                bytes[count] = n->keys[i];
+                children[count] = n->children[i];
+            }
+            break;
+        }
+        case Node::K16: {
+            Node16* n = static_cast<Node16*>(node);
+            for (uint16_t i = 0; i < n->count; i++, count++) {
+                bytes[count] = n->keys[i];
+                children[count] = n->children[i];
+            }
+            break;
+        }
+        case Node::K48: {
+            Node48* n = static_cast<Node48*>(node);
+            for (int b = 0; b < 256; b++) {
+                if (n->index[b]) {
+                    bytes[count] = static_cast<uint8_t>(b);
+                    children[count] = n->children[n->index[b] - 1];
+                    count++;
+                }
+            }
+            break;
+        }
+        case Node::K256: {
+            Node256* n = static_cast<Node256*>(node);
+            for (int b = 0; b < 256; b++) {
+                if (n->children[b]) {
+                    bytes[count] = static_cast<uint8_t>(b);
+                    children[count] = n->children[b];
+                    count++;
+                }
+            }
+            break;
+        }
+    }
+    return count;
+}
+
+/**
+ * 删除键之后收缩节点
+ * 与子节点合并时把本节点前缀和分支字节拼到子节点前面：子节点是内部节点时改前缀，
+ * 是叶子时重新分配更长的叶子并移入条目
+ * @param slot 指向该节点的引用
+ */
+void ArtIndex::compact(uintptr_t& slot) {
+    Node* node = asNode(slot);
+    if (node->count == 0) {
+        if (node->terminal) {
+            Leaf* leaf = newLeaf(node->prefix(), node->prefix_length);
+            leaf->entry = std::move(node->terminal->entry);
+            freeLeaf(node->terminal);
+            slot = refOf(leaf);
+        } else {
+            slot = 0;
+        }
+        freeNode(node);
+        return;
+    }
+    if (node->count != 1 || node->terminal) {
+        return;
+    }
+
+    uint8_t bytes[256];
+    uintptr_t children[256];
+    listChildren(node, bytes, children);
+    std::string merged(node->prefix(), node->prefix_length);
+    merged.push_back(static_cast<char>(bytes[0]));
+
+    uintptr_t child = children[0];
+    if (isLeaf(child)) {
+        Leaf* old_leaf = asLeaf(child);
+        merged.append(old_leaf->bytes(), old_leaf->length);
+        Leaf* leaf = newLeaf(merged.data(), merged.size());
+        leaf->entry = std::move(old_leaf->entry);
+        freeLeaf(old_leaf);
+        slot = refOf(leaf);
+    } else {
+        Node* child_node = asNode(child);
+        merged.append(child_node->prefix(), child_node->prefix_length);
+        setPrefix(child_node, merged.data(), merged.size());
+        slot = child;
+    }
+    freeNode(node);
+}
+
+/**
+ * 在子树中删除键
+ * @param slot 子树的根引用
+ * @param key 完整的键
+ * @param depth 子树根所在的深度
+ * @return 键存在时返回true
+ */
+bool ArtIndex::eraseAt(uintptr_t& slot, const std::string& key, size_t depth) {
+    uintptr_t ref = slot;
+    if (ref == 0) {
+        return false;
+    }
+    if (isLeaf(ref)) {
+        Leaf* leaf = asLeaf(ref);
+        if (leaf->length != key.size() - depth ||
+            std::memcmp(leaf->bytes(), key.data() + depth, leaf->length) != 0) {
+            return false;
+        }
+        freeLeaf(leaf);
+        slot = 0;
+        return true;
+    }
+
+    Node* node = asNode(ref);
+    if (node->prefix_length > key.size() - depth ||
+        std::memcmp(node->prefix(), key.data() + depth, node->prefix_length) != 0) {
+        return false;
+    }
+    depth += node->prefix_length;
+    if (depth == key.size()) {
+        if (!node->terminal) {
+            return false;
+        }
+        freeLeaf(node->terminal);
+        node->terminal = nullptr;
+        compact(slot);
+        return true;
+    }
+
+    uint8_t byte = static_cast<uint8_t>(key[depth]);
+    uintptr_t* child = findChild(node, byte);
+    if (!child || !eraseAt(*child, key, depth + 1)) {
+        return false;
+    }
+    if (*child == 0) {
+        removeChild(slot, node, byte);
+    }
+    compact(slot);
+    return true;
+}
+
+/**
+ * 有序遍历子树
+ * 到子树根为止的路径已经大于start时整棵子树都不小于start，不再逐个比较；
+ * 路径小于start且不是start的前缀时整棵子树都可以跳过
+ * @param ref 子树的根
+ * @param path 到子树根为止的键字节
+ * @param start 起始键
+ * @param bounded 子树中是否可能有小于start的键
+ * @param visit 遍历回调
+ * @return 回调要求停止时返回false
+ */
+bool ArtIndex::walk(uintptr_t ref, std::string& path, const std::string& start, bool bounded,
+                    const Visitor& visit) {
+    if (ref == 0) {
+        return true;
+    }
+    size_t base = path.size();
+
+    if (isLeaf(ref)) {
+        Leaf* leaf = asLeaf(ref);
+        path.append(leaf->bytes(), leaf->length);
+        bool keep_going = true;
+        if (!bounded || path >= start) {
+            keep_going = visit(path, leaf->entry);
+        }
+        path.resize(base);
+        return keep_going;
+    }
+
+    Node* node = asNode(ref);
+    path.append(node->prefix(), node->prefix_length);
+    if (bounded) {
+        size_t compared = std::min(path.size(), start.size());
+        int cmp = path.compare(0, compared, start, 0, compared);
+        if (cmp < 0) {
+            path.resize(base);
+            return true;
+        }
+        // 路径大于start，或者start是路径的前缀：子树中所有键都不小于start
+        bounded = cmp == 0 && path.size() < start.size();
+    }
+
+    // 终止叶子的键就是路径本身，仍受限时它是start的真前缀，一定小于start
+    if (node->terminal && !bounded && !visit(path, node->terminal->entry)) {
+        path.resize(base);
+        return false;
+    }
+
+    uint8_t bytes[256];
+    uintptr_t children[256];
+    size_t count = listChildren(node, bytes, children);
+    for (size_t i = 0; i < count; i++) {
+        bool child_bounded = false;
+        if (bounded) {
+            uint8_t start_byte = static_cast<uint8_t>(start[path.size()]);
+            if (bytes[i] < start_byte) {
+                continue;
+            }
+            child_bounded = bytes[i] == start_byte;
+        }
+        path.push_back(static_cast<char>(bytes[i]));
+        bool keep_going = walk(children[i], path, start, child_bounded, visit);
+        path.pop_back();
+        if (!keep_going) {
+            path.resize(base);
+            return false;
+        }
+    }
+    path.resize(base);
+    return true;
+}
\ No newline at end of file
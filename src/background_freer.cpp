@@ -0,0 +1,65 @@
+#include "background_freer.h"
+
+/**
+ * 构造函数，启动后台释放线程
+ */
+BackgroundFreer::BackgroundFreer() : stopping_(false), pending_(0), freed_(0) {
+    thread_ = std::thread(&BackgroundFreer::run, this);
+}
+
+/**
+ * 析构函数
+ * 通知后台线程退出并等待它把队列中剩余的对象释放完
+ */
+BackgroundFreer::~BackgroundFreer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_one();
+    thread_.join();
+}
+
+/**
+ * 把对象加入队列
+ * 排队对象超过上限时说明后台线程跟不上，此时由调用方就地释放
+ * @param garbage 要释放的对象
+ */
+void BackgroundFreer::push(std::shared_ptr<void> garbage) {
+    if (pending_.load(std::memory_order_relaxed) >= kMaxPending) {
+        return;  // garbage在这里析构
+    }
+    bool was_empty;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        was_empty = queue_.empty();
+        queue_.push_back(std::move(garbage));
+    }
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    if (was_empty) {
+        cv_.notify_one();  // 队列非空时后台线程已被唤醒过，会一并取走
+    }
+}
+
+/**
+ * 后台线程主循环
+ * 每次取走整个队列后在锁外析构，析构期间新对象可以继续入队
+ */
+void BackgroundFreer::run() {
+    std::vector<std::shared_ptr<void>> batch;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;  // 已经停止且没有剩余对象
+            }
+            batch.swap(queue_);
+        }
+
+        size_t count = batch.size();
+        batch.clear();
+        pending_.fetch_sub(count, std::memory_order_relaxed);
+        freed_.fetch_add(count, std::memory_order_relaxed);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include "cache_entry.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <thread>
+
+/**
+ * 创建永不过期的空条目
+ */
+CacheEntry::CacheEntry()
+    : version(0), soft_expires_at(0), hard_expires_at(0), recompute_ns(0), refresh_claimed_at(0), accessed_at(0) {}
+
+/**
+ * 按过期参数创建条目
+ * 只指定硬过期时软过期与硬过期相同，XFetch仍会在硬过期前选出一个调用方提前刷新；
+ * 只指定软过期时条目永不硬过期，软过期只用来触发刷新
+ * @param value 缓存值
+ * @param ttl 过期参数
+ * @param now 当前时间（steady_clock纳秒）
+ */
+CacheEntry::CacheEntry(const std::string& value, const EntryTtl& ttl, int64_t now)
+    : value(value), version(0), soft_expires_at(0), hard_expires_at(0), recompute_ns(0), refresh_claimed_at(0),
+      accessed_at(accessTick(now)) {
+    const int64_t ms = 1000000;
+    if (ttl.ttl_ms > 0) {
+        hard_expires_at = now + ttl.ttl_ms * ms;
+    }
+    int64_t soft_ttl_ms = ttl.soft_ttl_ms > 0 ? ttl.soft_ttl_ms : ttl.ttl_ms;
+    if (ttl.ttl_ms > 0) {
+        soft_ttl_ms = std::min(soft_ttl_ms, ttl.ttl_ms);
+    }
+    if (soft_ttl_ms > 0) {
+        soft_expires_at = now + soft_ttl_ms * ms;
+        recompute_ns = (ttl.recompute_ms > 0 ? ttl.recompute_ms : soft_ttl_ms / 10) * ms;
+    }
+}
+
+/**
+ * 计算读取时的过期状态
+ * 刷新任务领取后在期限内不再发放；期限为预计刷新耗时的两倍且至少1秒，
+ * 领取者刷新失败时，期限过后下一个调用方会重新领取
+ * @param now 当前时间（steady_clock纳秒）
+ * @param claim 是否允许本次读取领取刷新任务
+ * @param meta 输出参数，过期状态
+ */
+void CacheEntry::inspect(int64_t now, bool claim, ReadMeta& meta) {
+    meta.stale = false;
+    meta.refresh = false;
+    meta.ttl_ms = hard_expires_at != 0 ? (hard_expires_at - now) / 1000000 : -1;
+    meta.version = version;
+    if (soft_expires_at == 0) {
+        return;
+    }
+
+    meta.stale = now >= soft_expires_at;
+    if (!claim) {
+        return;
+    }
+    if (refresh_claimed_at != 0 && now - refresh_claimed_at < std::max(recompute_ns * 2, kMinClaimNanos)) {
+        return;
+    }
+
+    // XFetch：-ln(rand)服从指数分布，把当前时间随机向后推移
+    double gap = static_cast<double>(recompute_ns) * kXFetchBeta * -std::log(uniformRandom());
+    if (meta.stale || now + static_cast<int64_t>(gap) >= soft_expires_at) {
+        refresh_claimed_at = now;
+        meta.refresh = true;
+    }
+}
+
+/**
+ * 当前时间
+ * @return steady_clock纳秒
+ */
+int64_t CacheEntry::nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * 线程本地的(0, 1]均匀随机数
+ * @return 随机数
+ */
+double CacheEntry::uniformRandom() {
+    thread_local uint64_t rng = (0x9E3779B97F4A7C15ULL ^ static_cast<uint64_t>(
+        std::hash<std::thread::id>()(std::this_thread::get_id()))) | 1;  // xorshift的状态不能为0
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return static_cast<double>((rng >> 11) + 1) / 9007199254740992.0;  // 2^53
+}
\ No newline at end of file
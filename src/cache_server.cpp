@@ -1,7 +1,12 @@
 #include "cache_server.h"
 #include <grpcpp/server_builder.h>
+#include <grpcpp/resource_quota.h>
 #include <iostream>
 #include <thread>
+#include <future>
+#include <algorithm>
+#include <sstream>
+#include <cstdlib>
 
 /**
  * 缓存服务器构造函数
@@ -9,18 +14,65 @@
  * @param host 服务器主机地址
  * @param grpc_port gRPC服务端口
  * @param http_port HTTP服务端口
+ * @param options 运行配置
  * 初始化分布式缓存服务器的所有组件，包括一致性哈希环、gRPC客户端和HTTP处理器
  */
 CacheServer::CacheServer(const std::string& node_id, const std::string& host, 
-                         int grpc_port, int http_port)
-    : node_id_(node_id), host_(host), grpc_port_(grpc_port), http_port_(http_port) {
+                         int grpc_port, int http_port, const ServerOptions& options)
+    : node_id_(node_id), host_(host), grpc_port_(grpc_port), http_port_(http_port), options_(options),
+      invalidation_epoch_(0), running_(false), bulk_deleted_(0) {
     
+    // 创建指标注册表，记录各项操作的延迟和计数
+    metrics_ = std::make_unique<Metrics>();
+    // 启用时创建核心线程，第i个线程负责编号除以线程数余i的分片
+    std::vector<int> shard_nodes;
+    if (options_.thread_per_core > 0) {
+        cores_ = std::make_unique<CoreEngine>(static_cast<size_t>(options_.thread_per_core), options_.numa_bind);
+        if (options_.numa_bind) {
+            std::cout << "核心线程按" << cores_->nodeCount() << "个NUMA节点分布" << std::endl;
+            // 分片的大页内存放在所属核心线程的节点上
+            for (size_t core = 0; core < cores_->size(); core++) {
+                shard_nodes.push_back(cores_->nodeOf(core));
+            }
+        }
+    }
+    // 创建本地存储，按键分片加锁
+    store_ = std::make_unique<LocalStore>(static_cast<size_t>(std::max(options_.store_shards, 1)),
+                                          options_.store_art_index,
+                                          static_cast<size_t>(std::max(options_.lazy_free_bytes, 0)),
+                                          static_cast<size_t>(std::max(options_.huge_pages, 0)) * 1024 * 1024,
+                                          shard_nodes);
+    // 创建启动配置中的命名空间，格式为"名称=配额MB,..."
+    std::stringstream namespaces(options_.namespaces);
+    std::string item;
+    while (std::getline(namespaces, item, ',')) {
+        size_t eq = item.find('=');
+        std::string name = item.substr(0, eq);
+        uint64_t quota_mb = eq == std::string::npos ? 0 : std::strtoull(item.c_str() + eq + 1, nullptr, 10);
+        if (!name.empty() && !store_->setNamespace(name, quota_mb * 1024 * 1024)) {
+            std::cerr << "忽略不合法的命名空间: " << name << std::endl;
+        }
+    }
+    // 创建热点键追踪器，在get/set路径上采样统计访问最频繁的键
+    hot_keys_ = std::make_unique<HotKeyTracker>(options_.hot_key_capacity, options_.hot_key_sample_rate);
+    // 创建副本缓存，保存其他节点推送来的热点键
+    replicas_ = std::make_unique<TtlCache>(options_.replica_capacity);
+    // 创建旧值缓存，租约未命中时可以返回最近删除的值
+    stale_values_ = std::make_unique<TtlCache>(options_.stale_capacity);
+    // 启用时创建近端缓存，保存本节点转发读取到的其他节点的键
+    if (options_.near_cache) {
+        near_cache_ = std::make_unique<TtlCache>(options_.near_cache_capacity);
+    }
+    // 启用时创建负缓存，记录转发读取确认不存在的键
+    if (options_.negative_cache) {
+        negative_cache_ = std::make_unique<NegativeCache>(options_.negative_cache_capacity);
+    }
     // 创建一致性哈希环，每个物理节点100个虚拟节点
     hash_ring_ = std::make_unique<ConsistentHash>(100);
     // 创建gRPC客户端，用于与其他节点通信
-    grpc_client_ = std::make_unique<GrpcClient>();
+    grpc_client_ = std::make_unique<GrpcClient>(metrics_.get());
     // 创建HTTP处理器，提供REST API接口
-    http_handler_ = std::make_unique<HttpHandler>(this, http_port_);
+    http_handler_ = std::make_unique<HttpHandler>(this, http_port_, options_.http);
     
     // 将自身节点添加到哈希环中
     Node self_node(node_id_, host_, grpc_port_, http_port_);
@@ -49,6 +101,12 @@ void CacheServer::start() {
     builder.AddListeningPort(server_address, grpc::InsecureServerCredentials());
     builder.RegisterService(this);  // 注册缓存服务
     
+    // gRPC使用独立的线程配额，与HTTP工作线程池互不影响
+    grpc::ResourceQuota quota("cache_grpc_quota");
+    quota.SetMaxThreads(options_.grpc_max_threads);
+    builder.SetResourceQuota(quota);
+    builder.AddChannelArgument(GRPC_ARG_MAX_CONCURRENT_STREAMS, options_.grpc_max_concurrent_streams);
+    
     // 构建并启动gRPC服务器
     grpc_server_ = builder.BuildAndStart();
     if (!grpc_server_) {
@@ -58,6 +116,11 @@ void CacheServer::start() {
     
     std::cout << "gRPC服务器正在监听 " << server_address << std::endl;
     
+    // 启动后台线程：推送本节点负责的热点键，清理过期的近端缓存登记
+    running_ = true;
+    background_thread_ = std::thread(&CacheServer::backgroundLoop, this);
+    bulk_delete_thread_ = std::thread(&CacheServer::bulkDeleteLoop, this);
+    
     // 启动HTTP服务器
     http_handler_->start();
     
@@ -74,6 +137,23 @@ void CacheServer::stop() {
         http_handler_->stop();
     }
     
+    // 停止后台线程
+    {
+        std::lock_guard<std::mutex> lock(background_mutex_);
+        running_ = false;
+    }
+    background_cv_.notify_all();
+    if (background_thread_.joinable()) {
+        background_thread_.join();
+    }
+    {
+        std::lock_guard<std::mutex> lock(bulk_delete_mutex_);
+        bulk_delete_cv_.notify_all();  // 加锁后通知，删除线程不会在检查running_和开始等待之间错过唤醒
+    }
+    if (bulk_delete_thread_.joinable()) {
+        bulk_delete_thread_.join();  // 未执行完的任务随之放弃
+    }
+    
     // 停止gRPC服务器
     if (grpc_server_) {
         grpc_server_->Shutdown();  // 发起关闭
@@ -85,38 +165,208 @@ void CacheServer::stop() {
  * 获取缓存值
  * @param key 缓存键
  * @param value 输出参数，存储获取到的值
+ * @param meta 输出参数（可为空），值的过期状态
  * @return 是否成功获取到值
  * 根据一致性哈希算法确定键值应该存储在哪个节点，如果是本地节点则直接访问，
- * 否则通过gRPC调用远程节点
+ * 否则通过gRPC调用远程节点。热点副本和近端缓存返回的值不带过期状态，
+ * 刷新任务只由负责节点发放
  */
-bool CacheServer::get(const std::string& key, std::string& value) {
+bool CacheServer::get(const std::string& key, std::string& value, ReadMeta* meta) {
+    ScopedLatency timer(metrics_.get(), MetricOp::Get);
+    hot_keys_->record(key);
+    
+    bool found;
     if (isLocalKey(key)) {
         // 键值属于本地节点，直接从本地缓存获取
-        return getLocal(key, value);
+        metrics_->increment(MetricCounter::LocalOps);
+        found = getOrLoadLocal(key, value, meta);
+    } else if (replicas_->get(key, value)) {
+        // 负责节点推送过来的热点副本，直接在本地返回，不经过转发
+        metrics_->increment(MetricCounter::ReplicaHits);
+        found = true;
+    } else {
+        // 键值属于远程节点，先查近端缓存，未命中时通过gRPC调用获取
+        found = getRemote(key, value, meta);
+    }
+    
+    // 记录命中情况和返回的字节数
+    if (found) {
+        metrics_->increment(MetricCounter::Hits);
+        metrics_->recordBytes(MetricOp::Get, 0, value.size());
     } else {
-        // 键值属于远程节点，通过gRPC调用获取
+        metrics_->increment(MetricCounter::Misses);
+    }
+    return found;
+}
+
+/**
+ * 从远程节点获取值
+ * @param key 缓存键
+ * @param value 输出参数，存储获取到的值
+ * @param meta 输出参数（可为空），值的过期状态
+ * @return 是否成功获取
+ * 启用近端缓存时先查近端缓存；未命中则转发并告知负责节点本节点会缓存结果，
+ * 负责节点在键被修改时向本节点发送失效通知。
+ * 启用负缓存时，负责节点确认不存在的键在短时间内直接返回未找到，负责节点写入该键时同样发送失效通知。
+ * 转发期间收到过任何失效通知时放弃回填，避免失效先于旧值到达而留下旧值。
+ * 同一个键的并发转发合并为一次gRPC调用，其余调用等待并共享结果，刷新任务只交给发起调用的一方。
+ * 已软过期的值不进入近端缓存，近端缓存的存活时间不超过值的剩余硬过期时间
+ */
+bool CacheServer::getRemote(const std::string& key, std::string& value, ReadMeta* meta) {
+    if (near_cache_ && near_cache_->get(key, value)) {
+        metrics_->increment(MetricCounter::NearHits);
+        return true;
+    }
+    if (negative_cache_ && negative_cache_->contains(key)) {
+        metrics_->increment(MetricCounter::NegativeHits);
+        return false;
+    }
+    
+    bool shared = false;
+    RemoteRead read = remote_flights_.run(key, [this, &key]() {
+        RemoteRead read;
+        KeyValueResult& result = read.result;
+        result.key = key;
+        
+        metrics_->increment(MetricCounter::Forwarded);
         Node target_node = hash_ring_->getNode(key);
-        return grpc_client_->get(target_node, key, value);
+        if (!near_cache_ && !negative_cache_) {
+            result.found = grpc_client_->get(target_node, key, result.value, &read.meta);
+            return read;
+        }
+        
+        // 负责节点的登记时间覆盖两种缓存中较长的一个
+        int cache_ttl_ms = 0;
+        if (near_cache_) {
+            cache_ttl_ms = options_.near_cache_ttl_ms;
+        }
+        if (negative_cache_) {
+            cache_ttl_ms = std::max(cache_ttl_ms, options_.negative_cache_ttl_ms);
+        }
+        
+        uint64_t epoch;
+        {
+            std::lock_guard<std::mutex> lock(near_cache_mutex_);
+            epoch = invalidation_epoch_;
+        }
+        grpc_client_->fetch(target_node, key, node_id_, cache_ttl_ms, result, &read.meta);
+        if (result.error) {
+            return read;  // 调用失败不缓存
+        }
+        
+        std::lock_guard<std::mutex> lock(near_cache_mutex_);
+        if (invalidation_epoch_ != epoch) {
+            return read;
+        }
+        if (result.found && near_cache_ && !read.meta.stale) {
+            int64_t near_ttl_ms = options_.near_cache_ttl_ms;
+            if (read.meta.ttl_ms >= 0) {
+                near_ttl_ms = std::min(near_ttl_ms, read.meta.ttl_ms);
+            }
+            if (near_ttl_ms > 0) {
+                near_cache_->put(key, result.value, std::chrono::milliseconds(near_ttl_ms));
+            }
+        } else if (!result.found && negative_cache_) {
+            negative_cache_->insert(key, std::chrono::milliseconds(options_.negative_cache_ttl_ms));
+        }
+        return read;
+    }, &shared);
+    
+    if (shared) {
+        metrics_->increment(MetricCounter::Coalesced);
+        read.meta.refresh = false;  // 刷新任务只交给发起调用的一方
+    }
+    if (read.result.found) {
+        value = read.result.value;
+        if (meta) {
+            *meta = read.meta;
+        }
+    }
+    return read.result.found;
+}
+
+/**
+ * 从本地缓存获取值，未命中时读穿透加载
+ * @param key 缓存键
+ * @param value 输出参数，存储获取到的值
+ * @param meta 输出参数（可为空），值的过期状态
+ * @return 是否成功获取
+ * 同一个键的并发未命中只调用一次加载函数；
+ * 加载期间键被显式写入时保留写入的值，不用加载结果覆盖
+ */
+bool CacheServer::getOrLoadLocal(const std::string& key, std::string& value, ReadMeta* meta) {
+    if (getLocal(key, value, meta, meta != nullptr)) {
+        return true;
+    }
+    if (!loader_) {
+        return false;
+    }
+    
+    bool shared = false;
+    KeyValueResult result = load_flights_.run(key, [this, &key]() {
+        KeyValueResult result;
+        result.key = key;
+        
+        metrics_->increment(MetricCounter::Loads);
+        result.found = loader_(key, result.value);
+        if (!result.found) {
+            return result;
+        }
+        
+        if (onOwner(key, [&]() { return store_->insertIfAbsent(key, result.value); })) {
+            notifyKeyChanged(key);
+        }
+        return result;
+    }, &shared);
+    
+    if (shared) {
+        metrics_->increment(MetricCounter::Coalesced);
     }
+    if (result.found) {
+        value = result.value;
+    }
+    return result.found;
+}
+
+/**
+ * 设置读穿透加载函数
+ * @param loader 加载函数，参数为键和输出的值，返回是否加载到
+ */
+void CacheServer::setLoader(std::function<bool(const std::string&, std::string&)> loader) {
+    loader_ = std::move(loader);
 }
 
 /**
  * 设置缓存值
  * @param key 缓存键
  * @param value 要设置的值
+ * @param ttl 过期参数
  * @return 是否成功设置
  * 根据一致性哈希算法确定键值应该存储在哪个节点，如果是本地节点则直接设置，
  * 否则通过gRPC调用远程节点
  */
-bool CacheServer::set(const std::string& key, const std::string& value) {
+bool CacheServer::set(const std::string& key, const std::string& value, const EntryTtl& ttl) {
+    ScopedLatency timer(metrics_.get(), MetricOp::Set);
+    hot_keys_->record(key);
+    metrics_->recordBytes(MetricOp::Set, value.size(), 0);
+    
+    bool success;
     if (isLocalKey(key)) {
         // 键值属于本地节点，直接设置到本地缓存
-        return setLocal(key, value);
+        metrics_->increment(MetricCounter::LocalOps);
+        success = setLocal(key, value, ttl);
     } else {
         // 键值属于远程节点，通过gRPC调用设置
+        metrics_->increment(MetricCounter::Forwarded);
+        dropRemoteCopies(key);
         Node target_node = hash_ring_->getNode(key);
-        return grpc_client_->set(target_node, key, value);
+        success = grpc_client_->set(target_node, key, value, ttl);
     }
+    
+    if (!success) {
+        metrics_->recordError(MetricOp::Set);
+    }
+    return success;
 }
 
 /**
@@ -127,183 +377,1959 @@ bool CacheServer::set(const std::string& key, const std::string& value) {
  * 否则通过gRPC调用远程节点
  */
 bool CacheServer::del(const std::string& key) {
+    ScopedLatency timer(metrics_.get(), MetricOp::Del);
+    
     if (isLocalKey(key)) {
         // 键值属于本地节点，直接从本地缓存删除
+        metrics_->increment(MetricCounter::LocalOps);
         return delLocal(key);
     } else {
         // 键值属于远程节点，通过gRPC调用删除
+        metrics_->increment(MetricCounter::Forwarded);
+        dropRemoteCopies(key);
         Node target_node = hash_ring_->getNode(key);
         return grpc_client_->del(target_node, key);
     }
 }
 
 /**
- * 向集群添加节点
- * @param node 要添加的节点信息
- * 将新节点添加到一致性哈希环中，实现集群的动态扩展
+ * 丢弃本节点保存的其他节点键的副本
+ * 转发写入前调用，保证本节点随后的读取能看到自己的写入
+ * @param key 缓存键
  */
-void CacheServer::addNode(const Node& node) {
-    hash_ring_->addNode(node);
-    std::cout << "已添加节点: " << node.id << " (" << node.host << ":" << node.grpc_port << ")" << std::endl;
+void CacheServer::dropRemoteCopies(const std::string& key) {
+    replicas_->erase(key);
+    if (near_cache_) {
+        near_cache_->erase(key);
+    }
+    if (negative_cache_) {
+        negative_cache_->erase(key);
+    }
+    remote_flights_.forget(key);
 }
 
 /**
- * 从集群移除节点
- * @param node_id 要移除的节点ID
- * 从一致性哈希环中移除节点，实现集群的动态缩容
+ * 租约获取
+ * @param key 缓存键
+ * @param result 输出参数，存储租约获取结果
+ * @return 负责节点无法访问时返回false
+ * 总是由键的负责节点处理，不使用热点副本和近端缓存：
+ * 租约必须由负责节点统一发放，才能保证同一时间只有一个调用方回源
  */
-void CacheServer::removeNode(const std::string& node_id) {
-    hash_ring_->removeNode(node_id);
-    std::cout << "已移除节点: " << node_id << std::endl;
+bool CacheServer::leaseGet(const std::string& key, LeaseResult& result) {
+    if (isLocalKey(key)) {
+        metrics_->increment(MetricCounter::LocalOps);
+        leaseGetLocal(key, result);
+        return true;
+    }
+    metrics_->increment(MetricCounter::Forwarded);
+    Node target_node = hash_ring_->getNode(key);
+    return grpc_client_->leaseGet(target_node, key, result);
 }
 
 /**
- * gRPC Get服务实现
- * @param context gRPC服务器上下文
- * @param request 获取请求，包含要查找的键
- * @param response 获取响应，包含查找结果和值
- * @return gRPC状态
- * 处理来自其他节点的获取请求，只在本地缓存中查找
+ * 租约写入
+ * @param key 缓存键
+ * @param value 缓存值
+ * @param token LeaseGet发放的租约
+ * @return 租约有效并已写入时返回true
  */
-grpc::Status CacheServer::Get(grpc::ServerContext* context,
-                              const cache::GetRequest* request,
-                              cache::GetResponse* response) {
-    std::string value;
-    // 在本地缓存中查找键值
-    bool found = getLocal(request->key(), value);
+bool CacheServer::leaseSet(const std::string& key, const std::string& value, uint64_t token) {
+    hot_keys_->record(key);
+    if (isLocalKey(key)) {
+        metrics_->increment(MetricCounter::LocalOps);
+        return leaseSetLocal(key, value, token);
+    }
+    metrics_->increment(MetricCounter::Forwarded);
+    dropRemoteCopies(key);
+    Node target_node = hash_ring_->getNode(key);
+    return grpc_client_->leaseSet(target_node, key, value, token);
+}
+
+/**
+ * 原子自增
+ * @param key 缓存键
+ * @param delta 增量，可以为负
+ * @param result 输出参数，自增后的值
+ * @return 操作结果
+ * 总是由键的负责节点在键所在分片的锁内完成，不使用热点副本和近端缓存
+ */
+OpStatus CacheServer::incr(const std::string& key, int64_t delta, int64_t& result) {
+    ScopedLatency timer(metrics_.get(), MetricOp::Incr);
+    hot_keys_->record(key);
     
-    // 设置响应结果
-    response->set_found(found);
-    if (found) {
-        response->set_value(value);
+    OpStatus status;
+    if (isLocalKey(key)) {
+        metrics_->increment(MetricCounter::LocalOps);
+        status = incrLocal(key, delta, result);
+    } else {
+        metrics_->increment(MetricCounter::Forwarded);
+        dropRemoteCopies(key);
+        Node target_node = hash_ring_->getNode(key);
+        status = grpc_client_->incr(target_node, key, delta, result);
     }
     
-    return grpc::Status::OK;
+    if (status == OpStatus::Unavailable) {
+        metrics_->recordError(MetricOp::Incr);
+    }
+    return status;
 }
 
 /**
- * gRPC Set服务实现
- * @param context gRPC服务器上下文
- * @param request 设置请求，包含键值对
- * @param response 设置响应，包含操作结果
- * @return gRPC状态
- * 处理来自其他节点的设置请求，将键值对存储到本地缓存
+ * 比较并交换
+ * @param key 缓存键
+ * @param value 要写入的值
+ * @param expected_version 期望的版本，0表示要求键不存在
+ * @param version 输出参数，成功时为新版本，冲突时为当前版本
+ * @return 操作结果
+ * 版本只由负责节点分配和比较，热点副本和近端缓存读到的值不带版本
  */
-grpc::Status CacheServer::Set(grpc::ServerContext* context,
-                              const cache::SetRequest* request,
-                              cache::SetResponse* response) {
-    // 在本地缓存中设置键值对
-    bool success = setLocal(request->key(), request->value());
-    response->set_success(success);
+OpStatus CacheServer::compareAndSwap(const std::string& key, const std::string& value,
+                                     uint64_t expected_version, uint64_t& version) {
+    ScopedLatency timer(metrics_.get(), MetricOp::Cas);
+    hot_keys_->record(key);
+    metrics_->recordBytes(MetricOp::Cas, value.size(), 0);
     
-    return grpc::Status::OK;
+    OpStatus status;
+    if (isLocalKey(key)) {
+        metrics_->increment(MetricCounter::LocalOps);
+        status = compareAndSwapLocal(key, value, expected_version, version);
+    } else {
+        metrics_->increment(MetricCounter::Forwarded);
+        dropRemoteCopies(key);
+        Node target_node = hash_ring_->getNode(key);
+        status = grpc_client_->compareAndSwap(target_node, key, value, expected_version, version);
+    }
+    
+    if (status == OpStatus::Unavailable) {
+        metrics_->recordError(MetricOp::Cas);
+    }
+    return status;
 }
 
 /**
- * gRPC Delete服务实现
- * @param context gRPC服务器上下文
- * @param request 删除请求，包含要删除的键
- * @param response 删除响应，包含操作结果
- * @return gRPC状态
- * 处理来自其他节点的删除请求，从本地缓存中删除指定键值
+ * 在值的末尾追加数据
+ * @param key 缓存键
+ * @param data 追加的数据
+ * @param length 输出参数，追加后的值长度
+ * @return 操作结果
+ * 转发时只传输追加的部分，负责节点原地追加
  */
-grpc::Status CacheServer::Delete(grpc::ServerContext* context,
-                                 const cache::DeleteRequest* request,
-                                 cache::DeleteResponse* response) {
-    // 从本地缓存中删除键值
-    bool success = delLocal(request->key());
-    response->set_success(success);
+OpStatus CacheServer::append(const std::string& key, const std::string& data, size_t& length) {
+    ScopedLatency timer(metrics_.get(), MetricOp::Append);
+    hot_keys_->record(key);
+    metrics_->recordBytes(MetricOp::Append, data.size(), 0);
     
-    return grpc::Status::OK;
+    OpStatus status;
+    if (isLocalKey(key)) {
+        metrics_->increment(MetricCounter::LocalOps);
+        status = appendLocal(key, data, length);
+    } else {
+        metrics_->increment(MetricCounter::Forwarded);
+        dropRemoteCopies(key);
+        Node target_node = hash_ring_->getNode(key);
+        status = grpc_client_->append(target_node, key, data, length);
+    }
+    
+    if (status == OpStatus::Unavailable) {
+        metrics_->recordError(MetricOp::Append);
+    }
+    return status;
 }
 
 /**
- * gRPC Health服务实现
- * @param context gRPC服务器上下文
- * @param request 健康检查请求
- * @param response 健康检查响应，包含节点状态和ID
- * @return gRPC状态
- * 提供节点健康状态检查，用于集群监控和负载均衡
+ * 读取值的一段
+ * @param key 缓存键
+ * @param start 起始位置（包含），负数表示从末尾倒数
+ * @param end 结束位置（包含），负数表示从末尾倒数
+ * @param value 输出参数，读取到的片段
+ * @param length 输出参数，完整值的长度
+ * @return 键存在时返回true
+ * 本节点有热点副本或近端缓存时直接从中截取，否则转发到负责节点，
+ * 只有这一段经过网络传输，范围读取的结果不回填近端缓存
  */
-grpc::Status CacheServer::Health(grpc::ServerContext* context,
-                                 const cache::HealthRequest* request,
-                                 cache::HealthResponse* response) {
-    // 设置节点健康状态和ID
-    response->set_healthy(true);
-    response->set_node_id(node_id_);
+bool CacheServer::getRange(const std::string& key, int64_t start, int64_t end, std::string& value, size_t& length) {
+    ScopedLatency timer(metrics_.get(), MetricOp::GetRange);
+    hot_keys_->record(key);
     
-    return grpc::Status::OK;
+    bool found;
+    std::string whole;
+    if (isLocalKey(key)) {
+        metrics_->increment(MetricCounter::LocalOps);
+        found = onOwner(key, [&]() { return store_->getRange(key, start, end, value, length); });
+    } else if (replicas_->get(key, whole) || (near_cache_ && near_cache_->get(key, whole))) {
+        // 本节点已有完整副本，截取后返回，不经过转发
+        length = whole.size();
+        if (LocalStore::clampRange(start, end, length)) {
+            value.assign(whole, static_cast<size_t>(start), static_cast<size_t>(end - start + 1));
+        } else {
+            value.clear();
+        }
+        found = true;
+    } else if (negative_cache_ && negative_cache_->contains(key)) {
+        metrics_->increment(MetricCounter::NegativeHits);
+        found = false;
+    } else {
+        metrics_->increment(MetricCounter::Forwarded);
+        Node target_node = hash_ring_->getNode(key);
+        found = grpc_client_->getRange(target_node, key, start, end, value, length);
+    }
+    
+    if (found) {
+        metrics_->increment(MetricCounter::Hits);
+        metrics_->recordBytes(MetricOp::GetRange, 0, value.size());
+    } else {
+        metrics_->increment(MetricCounter::Misses);
+    }
+    return found;
 }
 
 /**
- * 判断键值是否属于本地节点
- * @param key 要检查的键
- * @return 如果键值应该存储在本地节点返回true，否则返回false
- * 使用一致性哈希算法确定键值的归属节点
+ * 从offset开始覆盖写入数据
+ * @param key 缓存键
+ * @param offset 写入位置，超过值长度时中间用零字节补齐
+ * @param data 写入的数据
+ * @param length 输出参数，写入后的值长度
+ * @return 操作结果
  */
-bool CacheServer::isLocalKey(const std::string& key) const {
-    try {
-        // 通过一致性哈希算法获取键值对应的目标节点
+OpStatus CacheServer::setRange(const std::string& key, size_t offset, const std::string& data, size_t& length) {
+    ScopedLatency timer(metrics_.get(), MetricOp::SetRange);
+    hot_keys_->record(key);
+    metrics_->recordBytes(MetricOp::SetRange, data.size(), 0);
+    
+    OpStatus status;
+    if (isLocalKey(key)) {
+        metrics_->increment(MetricCounter::LocalOps);
+        status = setRangeLocal(key, offset, data, length);
+    } else {
+        metrics_->increment(MetricCounter::Forwarded);
+        dropRemoteCopies(key);
         Node target_node = hash_ring_->getNode(key);
-        return target_node.id == node_id_;  // 检查是否为当前节点
-    } catch (const std::exception& e) {
-        return true; // 如果没有可用节点，默认为本地处理
+        status = grpc_client_->setRange(target_node, key, offset, data, length);
     }
+    
+    if (status == OpStatus::Unavailable) {
+        metrics_->recordError(MetricOp::SetRange);
+    }
+    return status;
 }
 
 /**
- * 从本地缓存获取值
+ * 读取哈希字段
  * @param key 缓存键
- * @param value 输出参数，存储获取到的值
- * @return 是否成功获取到值
- * 线程安全的本地缓存访问方法
+ * @param fields 输入要读取的字段名（为空表示全部），输出读取结果
+ * @return 操作结果
+ * 总是由负责节点处理：热点副本和近端缓存中保存的是整个哈希的JSON，不按字段读取
  */
-bool CacheServer::getLocal(const std::string& key, std::string& value) {
-    // 使用互斥锁保证线程安全
-    std::lock_guard<std::mutex> lock(cache_mutex_);
+OpStatus CacheServer::hashGet(const std::string& key, std::vector<FieldValue>& fields) {
+    ScopedLatency timer(metrics_.get(), MetricOp::HashGet);
+    hot_keys_->record(key);
     
-    // 在本地缓存中查找键值
-    auto it = local_cache_.find(key);
-    if (it != local_cache_.end()) {
-        value = it->second;  // 找到则返回值
-        return true;
+    OpStatus status;
+    if (isLocalKey(key)) {
+        metrics_->increment(MetricCounter::LocalOps);
+        status = onOwner(key, [&]() { return store_->hashGet(key, fields); });
+    } else {
+        metrics_->increment(MetricCounter::Forwarded);
+        Node target_node = hash_ring_->getNode(key);
+        status = grpc_client_->hashGet(target_node, key, fields);
     }
     
-    return false;  // 未找到
+    if (status == OpStatus::Ok) {
+        uint64_t bytes_out = 0;
+        for (const auto& field : fields) {
+            bytes_out += field.value.size();
+        }
+        metrics_->increment(MetricCounter::Hits);
+        metrics_->recordBytes(MetricOp::HashGet, 0, bytes_out);
+    } else if (status == OpStatus::NotFound) {
+        metrics_->increment(MetricCounter::Misses);
+    } else if (status == OpStatus::Unavailable) {
+        metrics_->recordError(MetricOp::HashGet);
+    }
+    return status;
 }
 
 /**
- * 向本地缓存设置值
+ * 写入哈希字段
  * @param key 缓存键
- * @param value 要设置的值
- * @return 是否成功设置（总是返回true）
- * 线程安全的本地缓存设置方法
+ * @param fields 要写入的字段
+ * @param added 输出参数，新增的字段数量
+ * @return 操作结果
+ * 只有给出的字段经过网络传输，负责节点原地修改
  */
-bool CacheServer::setLocal(const std::string& key, const std::string& value) {
-    // 使用互斥锁保证线程安全
-    std::lock_guard<std::mutex> lock(cache_mutex_);
+OpStatus CacheServer::hashSet(const std::string& key, const std::vector<FieldValue>& fields, size_t& added) {
+    ScopedLatency timer(metrics_.get(), MetricOp::HashSet);
+    hot_keys_->record(key);
+    uint64_t bytes_in = 0;
+    for (const auto& field : fields) {
+        bytes_in += field.field.size() + field.value.size();
+    }
+    metrics_->recordBytes(MetricOp::HashSet, bytes_in, 0);
     
-    // 设置键值对到本地缓存
-    local_cache_[key] = value;
-    return true;  // 设置操作总是成功
+    OpStatus status;
+    if (isLocalKey(key)) {
+        metrics_->increment(MetricCounter::LocalOps);
+        status = hashSetLocal(key, fields, added);
+    } else {
+        metrics_->increment(MetricCounter::Forwarded);
+        dropRemoteCopies(key);
+        Node target_node = hash_ring_->getNode(key);
+        status = grpc_client_->hashSet(target_node, key, fields, added);
+    }
+    
+    if (status == OpStatus::Unavailable) {
+        metrics_->recordError(MetricOp::HashSet);
+    }
+    return status;
 }
 
 /**
- * 从本地缓存删除值
- * @param key 要删除的缓存键
- * @return 是否成功删除（键存在时返回true，不存在时返回false）
- * 线程安全的本地缓存删除方法
+ * 删除哈希字段
+ * @param key 缓存键
+ * @param fields 要删除的字段名
+ * @param removed 输出参数，实际删除的字段数量
+ * @return 操作结果
  */
-bool CacheServer::delLocal(const std::string& key) {
-    // 使用互斥锁保证线程安全
-    std::lock_guard<std::mutex> lock(cache_mutex_);
+OpStatus CacheServer::hashDel(const std::string& key, const std::vector<std::string>& fields, size_t& removed) {
+    ScopedLatency timer(metrics_.get(), MetricOp::HashDel);
     
-    // 在本地缓存中查找并删除键值
-    auto it = local_cache_.find(key);
-    if (it != local_cache_.end()) {
-        local_cache_.erase(it);  // 找到则删除
-        return true;
+    OpStatus status;
+    if (isLocalKey(key)) {
+        metrics_->increment(MetricCounter::LocalOps);
+        status = hashDelLocal(key, fields, removed);
+    } else {
+        metrics_->increment(MetricCounter::Forwarded);
+        dropRemoteCopies(key);
+        Node target_node = hash_ring_->getNode(key);
+        status = grpc_client_->hashDel(target_node, key, fields, removed);
+    }
+    
+    if (status == OpStatus::Unavailable) {
+        metrics_->recordError(MetricOp::HashDel);
+    }
+    return status;
+}
+
+/**
+ * 原子地写入多个键
+ * @param entries 键值对
+ * @param ttl 过期参数，作用于所有键
+ * @param condition 写入的前提条件
+ * @return 操作结果
+ * 所有键属于同一个节点时整批在负责节点上执行，远程只需一次MultiSet调用；
+ * 跨节点的批量无法原子执行，直接拒绝而不是退化成逐个写入
+ */
+OpStatus CacheServer::multiSet(const std::vector<std::pair<std::string, std::string>>& entries,
+                               const EntryTtl& ttl, WriteCondition condition) {
+    ScopedLatency timer(metrics_.get(), MetricOp::MultiSet);
+    if (entries.empty()) {
+        return OpStatus::Invalid;
+    }
+    
+    std::vector<std::string> keys;
+    keys.reserve(entries.size());
+    for (const auto& entry : entries) {
+        keys.push_back(entry.first);
+    }
+    Node owner;
+    if (!sameOwner(keys, owner)) {
+        return OpStatus::CrossNode;
+    }
+    
+    OpStatus status;
+    if (owner.id == node_id_) {
+        metrics_->increment(MetricCounter::LocalOps);
+        status = multiSetLocal(entries, ttl, condition);
+    } else {
+        metrics_->increment(MetricCounter::Forwarded);
+        for (const auto& key : keys) {
+            dropRemoteCopies(key);
+        }
+        status = grpc_client_->multiSet(owner, entries, ttl, condition);
+    }
+    
+    if (status == OpStatus::Unavailable) {
+        metrics_->recordError(MetricOp::MultiSet);
+    }
+    return status;
+}
+
+/**
+ * 原子地删除多个键
+ * @param keys 要删除的键
+ * @param deleted 输出参数，实际删除的键数量
+ * @return 操作结果
+ */
+OpStatus CacheServer::multiDel(const std::vector<std::string>& keys, size_t& deleted) {
+    ScopedLatency timer(metrics_.get(), MetricOp::MultiDel);
+    deleted = 0;
+    if (keys.empty()) {
+        return OpStatus::Invalid;
+    }
+    
+    Node owner;
+    if (!sameOwner(keys, owner)) {
+        return OpStatus::CrossNode;
     }
     
-    return false;  // 键不存在
+    OpStatus status;
+    if (owner.id == node_id_) {
+        metrics_->increment(MetricCounter::LocalOps);
+        status = multiDelLocal(keys, deleted);
+    } else {
+        metrics_->increment(MetricCounter::Forwarded);
+        for (const auto& key : keys) {
+            dropRemoteCopies(key);
+        }
+        status = grpc_client_->multiDel(owner, keys, deleted);
+    }
+    
+    if (status == OpStatus::Unavailable) {
+        metrics_->recordError(MetricOp::MultiDel);
+    }
+    return status;
+}
+
+/**
+ * 按游标分批遍历集群中的键
+ * 每次调用只访问一个节点；节点按ID排序，集群成员变化时仍能接着上次的位置继续。
+ * 节点增减期间迁移中的键可能被漏掉或重复返回
+ * @param cursor 游标，"0"表示从头开始
+ * @param count 本次最多检查的条目数
+ * @param match glob模式
+ * @param keys 输出参数，本次找到的键
+ * @param next 输出参数，下一次的游标
+ * @return 操作结果
+ */
+OpStatus CacheServer::scan(const std::string& cursor, size_t count, const std::string& match,
+                           std::vector<std::string>& keys, std::string& next) {
+    ScopedLatency timer(metrics_.get(), MetricOp::Scan);
+    
+    std::string node_id;
+    std::string node_cursor = "0";
+    if (cursor != "0") {
+        size_t colon = cursor.rfind(':');
+        if (colon == std::string::npos || colon == 0) {
+            return OpStatus::Invalid;
+        }
+        node_id = cursor.substr(0, colon);
+        node_cursor = cursor.substr(colon + 1);
+    }
+    
+    std::vector<Node> nodes = hash_ring_->getAllNodes();
+    std::sort(nodes.begin(), nodes.end(), [](const Node& a, const Node& b) { return a.id < b.id; });
+    
+    // 找到ID不小于游标中节点ID的第一个节点；游标中的节点已下线时从下一个节点的开头继续
+    auto it = std::lower_bound(nodes.begin(), nodes.end(), node_id,
+                               [](const Node& node, const std::string& id) { return node.id < id; });
+    if (it == nodes.end()) {
+        next = "0";
+        return OpStatus::Ok;
+    }
+    if (it->id != node_id) {
+        node_cursor = "0";
+    }
+    
+    OpStatus status = OpStatus::Ok;
+    std::string node_next;
+    if (it->id == node_id_) {
+        if (!scanLocal(node_cursor, count, match, keys, node_next)) {
+            status = OpStatus::Invalid;
+        }
+    } else {
+        status = grpc_client_->scan(*it, node_cursor, count, match, keys, node_next);
+    }
+    if (status != OpStatus::Ok) {
+        if (status == OpStatus::Unavailable) {
+            metrics_->recordError(MetricOp::Scan);
+        }
+        return status;
+    }
+    
+    if (node_next != "0") {
+        next = it->id + ":" + node_next;
+    } else if (++it != nodes.end()) {
+        next = it->id + ":0";
+    } else {
+        next = "0";
+    }
+    return OpStatus::Ok;
+}
+
+/**
+ * 按游标分批遍历本节点存储中的键
+ * @param cursor 游标，"0"表示从头开始
+ * @param count 本次最多检查的条目数
+ * @param match glob模式
+ * @param keys 输出参数，本次找到的键
+ * @param next 输出参数，下一次的游标
+ * @return 游标格式不正确时返回false
+ */
+bool CacheServer::scanLocal(const std::string& cursor, size_t count, const std::string& match,
+                            std::vector<std::string>& keys, std::string& next) {
+    return store_->scan(cursor, count, match, keys, next);
+}
+
+/**
+ * 删除集群中所有匹配的键
+ * 并行向每个节点提交任务，提交只是入队，不等待删除完成
+ * @param match glob模式，为空时删除全部
+ * @param failed 输出参数，无法提交任务的节点ID
+ * @return Ok；有节点无法访问时返回Unavailable
+ */
+OpStatus CacheServer::deleteMatching(const std::string& match, std::vector<std::string>& failed) {
+    ScopedLatency timer(metrics_.get(), MetricOp::DeleteMatching);
+    
+    deleteMatchingLocal(match);
+    
+    std::vector<Node> others = otherNodes();
+    std::vector<std::future<OpStatus>> pending;
+    for (const auto& node : others) {
+        pending.push_back(std::async(std::launch::async, [this, node, &match]() {
+            return grpc_client_->deleteMatching(node, match);
+        }));
+    }
+    for (size_t i = 0; i < pending.size(); i++) {
+        if (pending[i].get() != OpStatus::Ok) {
+            failed.push_back(others[i].id);
+        }
+    }
+    if (!failed.empty()) {
+        metrics_->recordError(MetricOp::DeleteMatching);
+        return OpStatus::Unavailable;
+    }
+    return OpStatus::Ok;
+}
+
+/**
+ * 在本节点提交按模式删除的后台任务
+ * 相同模式的任务已经在排队（尚未开始）时不再重复提交
+ * @param match glob模式，为空时删除全部
+ */
+void CacheServer::deleteMatchingLocal(const std::string& match) {
+    {
+        std::lock_guard<std::mutex> lock(bulk_delete_mutex_);
+        if (std::find(bulk_delete_jobs_.begin() + (bulk_delete_jobs_.empty() ? 0 : 1),
+                      bulk_delete_jobs_.end(), match) != bulk_delete_jobs_.end()) {
+            return;
+        }
+        bulk_delete_jobs_.push_back(match);
+    }
+    bulk_delete_cv_.notify_one();
+}
+
+/**
+ * 在集群所有节点上创建、修改或删除命名空间
+ * 先在本节点执行以检查名称，再并行发给其他节点
+ * @param name 命名空间名称
+ * @param quota_bytes 每个节点上的内存配额（字节），0表示不限制
+ * @param remove 是否删除命名空间
+ * @param failed 输出参数，无法访问的节点ID
+ * @return Ok；名称不合法时返回Invalid；删除不存在的命名空间时返回NotFound；有节点无法访问时返回Unavailable
+ */
+OpStatus CacheServer::configureNamespace(const std::string& name, uint64_t quota_bytes, bool remove,
+                                         std::vector<std::string>& failed) {
+    ScopedLatency timer(metrics_.get(), MetricOp::ConfigureNamespace);
+    
+    OpStatus local = configureNamespaceLocal(name, quota_bytes, remove);
+    if (local == OpStatus::Invalid) {
+        return local;
+    }
+    
+    // 本节点上不存在时其他节点上仍可能存在（例如本节点是后加入的），照常发给其他节点
+    std::vector<Node> others = otherNodes();
+    std::vector<std::future<OpStatus>> pending;
+    for (const auto& node : others) {
+        pending.push_back(std::async(std::launch::async, [this, node, &name, quota_bytes, remove]() {
+            return grpc_client_->configureNamespace(node, name, quota_bytes, remove);
+        }));
+    }
+    bool found = local == OpStatus::Ok;
+    for (size_t i = 0; i < pending.size(); i++) {
+        OpStatus status = pending[i].get();
+        if (status == OpStatus::Ok) {
+            found = true;
+        } else if (status != OpStatus::NotFound) {
+            failed.push_back(others[i].id);
+        }
+    }
+    if (!failed.empty()) {
+        metrics_->recordError(MetricOp::ConfigureNamespace);
+        return OpStatus::Unavailable;
+    }
+    return found ? OpStatus::Ok : OpStatus::NotFound;
+}
+
+/**
+ * 在本节点创建、修改或删除命名空间
+ * @param name 命名空间名称
+ * @param quota_bytes 内存配额（字节），0表示不限制
+ * @param remove 是否删除命名空间
+ * @return Ok；名称不合法时返回Invalid；删除不存在的命名空间时返回NotFound
+ */
+OpStatus CacheServer::configureNamespaceLocal(const std::string& name, uint64_t quota_bytes, bool remove) {
+    if (remove) {
+        return store_->removeNamespace(name) ? OpStatus::Ok : OpStatus::NotFound;
+    }
+    if (!store_->setNamespace(name, quota_bytes)) {
+        return OpStatus::Invalid;
+    }
+    // 调低配额后不等写入触发，立即把超出的部分淘汰掉
+    store_->enforceQuotas();
+    return OpStatus::Ok;
+}
+
+/**
+ * 检查一组键是否都属于同一个节点
+ * @param keys 缓存键，不能为空
+ * @param owner 输出参数，负责第一个键的节点
+ * @return 都属于同一个节点时返回true
+ */
+bool CacheServer::sameOwner(const std::vector<std::string>& keys, Node& owner) const {
+    owner = hash_ring_->getNode(keys.front());
+    for (size_t i = 1; i < keys.size(); ++i) {
+        if (hash_ring_->getNode(keys[i]).id != owner.id) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * 在本地执行租约获取
+ * @param key 缓存键
+ * @param result 输出参数，存储租约获取结果
+ * 键存在时返回当前值；否则没有有效租约时发放一个新租约，
+ * 已有他人持有的租约时告知等待。未命中时附带最近删除的旧值（如果还在）
+ */
+void CacheServer::leaseGetLocal(const std::string& key, LeaseResult& result) {
+    onOwner(key, [&]() { store_->leaseGet(key, std::chrono::milliseconds(options_.lease_ttl_ms), result); });
+    if (result.found) {
+        return;
+    }
+    metrics_->increment(result.wait ? MetricCounter::LeaseWaits : MetricCounter::LeasesGranted);
+    
+    if (stale_values_->get(key, result.value)) {
+        result.stale = true;
+    }
+}
+
+/**
+ * 在本地执行租约写入
+ * @param key 缓存键
+ * @param value 缓存值
+ * @param token LeaseGet发放的租约
+ * @return 租约有效并已写入时返回true
+ * 租约在键被写入或删除时失效，回源期间键已被修改时迟到的旧值不会覆盖新值
+ */
+bool CacheServer::leaseSetLocal(const std::string& key, const std::string& value, uint64_t token) {
+    ScopedLatency timer(metrics_.get(), MetricOp::SetLocal);
+    
+    if (!onOwner(key, [&]() { return store_->leaseSet(key, value, token); })) {
+        metrics_->increment(MetricCounter::LeaseRejects);
+        return false;
+    }
+    stale_values_->erase(key);
+    
+    // 键在其他节点有副本时广播失效
+    notifyKeyChanged(key);
+    return true;
+}
+
+/**
+ * 在本地执行原子自增
+ * @param key 缓存键
+ * @param delta 增量
+ * @param result 输出参数，自增后的值
+ * @return 操作结果
+ */
+OpStatus CacheServer::incrLocal(const std::string& key, int64_t delta, int64_t& result) {
+    OpStatus status = onOwner(key, [&]() { return store_->incr(key, delta, result); });
+    if (status == OpStatus::Ok) {
+        // 键在其他节点有副本时广播失效
+        notifyKeyChanged(key);
+    }
+    return status;
+}
+
+/**
+ * 在本地执行比较并交换
+ * @param key 缓存键
+ * @param value 要写入的值
+ * @param expected_version 期望的版本
+ * @param version 输出参数，成功时为新版本，冲突时为当前版本
+ * @return 操作结果
+ */
+OpStatus CacheServer::compareAndSwapLocal(const std::string& key, const std::string& value,
+                                          uint64_t expected_version, uint64_t& version) {
+    OpStatus status = onOwner(key, [&]() { return store_->compareAndSwap(key, value, expected_version, version); });
+    if (status == OpStatus::Ok) {
+        stale_values_->erase(key);
+        // 键在其他节点有副本时广播失效
+        notifyKeyChanged(key);
+    }
+    return status;
+}
+
+/**
+ * 在本地执行追加
+ * @param key 缓存键
+ * @param data 追加的数据
+ * @param length 输出参数，追加后的值长度
+ * @return 操作结果
+ */
+OpStatus CacheServer::appendLocal(const std::string& key, const std::string& data, size_t& length) {
+    ScopedLatency timer(metrics_.get(), MetricOp::SetLocal);
+    OpStatus status = onOwner(key, [&]() { return store_->append(key, data, length); });
+    if (status == OpStatus::Ok) {
+        // 键在其他节点有副本时广播失效
+        notifyKeyChanged(key);
+    }
+    return status;
+}
+
+/**
+ * 在本地执行范围写入
+ * @param key 缓存键
+ * @param offset 写入位置
+ * @param data 写入的数据
+ * @param length 输出参数，写入后的值长度
+ * @return 操作结果
+ */
+OpStatus CacheServer::setRangeLocal(const std::string& key, size_t offset, const std::string& data, size_t& length) {
+    ScopedLatency timer(metrics_.get(), MetricOp::SetLocal);
+    OpStatus status = onOwner(key, [&]() { return store_->setRange(key, offset, data, length); });
+    if (status == OpStatus::Ok) {
+        // 键在其他节点有副本时广播失效
+        notifyKeyChanged(key);
+    }
+    return status;
+}
+
+/**
+ * 在本地写入哈希字段
+ * @param key 缓存键
+ * @param fields 要写入的字段
+ * @param added 输出参数，新增的字段数量
+ * @return 操作结果
+ */
+OpStatus CacheServer::hashSetLocal(const std::string& key, const std::vector<FieldValue>& fields, size_t& added) {
+    ScopedLatency timer(metrics_.get(), MetricOp::SetLocal);
+    OpStatus status = onOwner(key, [&]() { return store_->hashSet(key, fields, added); });
+    if (status == OpStatus::Ok) {
+        // 键在其他节点有副本时广播失效
+        notifyKeyChanged(key);
+    }
+    return status;
+}
+
+/**
+ * 在本地删除哈希字段
+ * @param key 缓存键
+ * @param fields 要删除的字段名
+ * @param removed 输出参数，实际删除的字段数量
+ * @return 操作结果
+ */
+OpStatus CacheServer::hashDelLocal(const std::string& key, const std::vector<std::string>& fields, size_t& removed) {
+    ScopedLatency timer(metrics_.get(), MetricOp::DelLocal);
+    OpStatus status = onOwner(key, [&]() { return store_->hashDel(key, fields, removed); });
+    if (status == OpStatus::Ok && removed > 0) {
+        // 键在其他节点有副本时广播失效
+        notifyKeyChanged(key);
+    }
+    return status;
+}
+
+/**
+ * 在本地原子地写入多个键
+ * @param entries 键值对
+ * @param ttl 过期参数
+ * @param condition 写入的前提条件
+ * @return 操作结果
+ * 转发方和本节点看到的集群视图可能不同，这里按本节点的视图再检查一次归属
+ */
+OpStatus CacheServer::multiSetLocal(const std::vector<std::pair<std::string, std::string>>& entries,
+                                    const EntryTtl& ttl, WriteCondition condition) {
+    ScopedLatency timer(metrics_.get(), MetricOp::SetLocal);
+    std::vector<std::string> keys;
+    keys.reserve(entries.size());
+    for (const auto& entry : entries) {
+        if (!isLocalKey(entry.first)) {
+            return OpStatus::CrossNode;
+        }
+        keys.push_back(entry.first);
+    }
+    
+    OpStatus status = store_->multiSet(entries, ttl, condition);
+    if (status == OpStatus::Ok) {
+        // 键在其他节点有副本时广播失效
+        notifyKeysChanged(keys);
+    }
+    return status;
+}
+
+/**
+ * 在本地原子地删除多个键
+ * @param keys 要删除的键
+ * @param deleted 输出参数，实际删除的键数量
+ * @return 操作结果
+ */
+OpStatus CacheServer::multiDelLocal(const std::vector<std::string>& keys, size_t& deleted) {
+    ScopedLatency timer(metrics_.get(), MetricOp::DelLocal);
+    for (const auto& key : keys) {
+        if (!isLocalKey(key)) {
+            return OpStatus::CrossNode;
+        }
+    }
+    
+    // 删除键值，保留旧值供租约未命中时使用
+    std::vector<std::pair<std::string, std::string>> removed;
+    store_->multiDel(keys, removed);
+    deleted = removed.size();
+    if (removed.empty()) {
+        return OpStatus::Ok;
+    }
+    
+    std::vector<std::string> changed;
+    changed.reserve(removed.size());
+    for (auto& entry : removed) {
+        if (!entry.second.empty()) {
+            stale_values_->put(entry.first, entry.second, std::chrono::milliseconds(options_.stale_ttl_ms));
+        }
+        changed.push_back(std::move(entry.first));
+    }
+    // 键在其他节点有副本时广播失效
+    notifyKeysChanged(changed);
+    return OpStatus::Ok;
+}
+
+/**
+ * 批量获取缓存值
+ * @param keys 缓存键列表
+ * @param on_batch 每个节点的结果到达时调用一次
+ * 先按一致性哈希把键分组到负责节点，本地键直接查询并立即回调，
+ * 远程节点各发起一次MGet调用并行执行，哪个节点先返回就先回调哪个，
+ * 调用方可以边收边输出，首字节时间不受最慢节点影响
+ */
+void CacheServer::mget(const std::vector<std::string>& keys,
+                       const std::function<void(const std::vector<KeyValueResult>&)>& on_batch) {
+    ScopedLatency timer(metrics_.get(), MetricOp::MGet);
+    
+    // 按负责节点分组
+    std::vector<std::string> local_keys;
+    std::unordered_map<std::string, std::pair<Node, std::vector<std::string>>> remote_groups;
+    for (const auto& key : keys) {
+        if (isLocalKey(key)) {
+            local_keys.push_back(key);
+        } else {
+            Node target_node = hash_ring_->getNode(key);
+            auto& group = remote_groups[target_node.id];
+            group.first = target_node;
+            group.second.push_back(key);
+        }
+    }
+    
+    // 保证回调之间互斥
+    std::mutex callback_mutex;
+    
+    // 并行向各远程节点发起批量请求
+    std::vector<std::future<void>> pending;
+    for (auto& entry : remote_groups) {
+        auto* group = &entry.second;
+        pending.push_back(std::async(std::launch::async, [this, group, &on_batch, &callback_mutex]() {
+            std::vector<KeyValueResult> results;
+            grpc_client_->mget(group->first, group->second, results);
+            recordBatch(results, MetricCounter::Forwarded);
+            std::lock_guard<std::mutex> lock(callback_mutex);
+            on_batch(results);
+        }));
+    }
+    
+    // 远程请求在途时处理本地键
+    if (!local_keys.empty()) {
+        std::vector<KeyValueResult> results;
+        for (const auto& key : local_keys) {
+            KeyValueResult result;
+            result.key = key;
+            result.found = getLocal(key, result.value);
+            results.push_back(result);
+        }
+        recordBatch(results, MetricCounter::LocalOps);
+        std::lock_guard<std::mutex> lock(callback_mutex);
+        on_batch(results);
+    }
+    
+    // 等待所有远程节点返回
+    for (auto& future : pending) {
+        future.get();
+    }
+}
+
+/**
+ * 记录一批批量查询结果的指标
+ * @param results 查询结果
+ * @param route 本地处理还是转发
+ */
+void CacheServer::recordBatch(const std::vector<KeyValueResult>& results, MetricCounter route) {
+    uint64_t hits = 0;
+    uint64_t bytes_out = 0;
+    for (const auto& result : results) {
+        if (result.found) {
+            hits++;
+            bytes_out += result.value.size();
+        } else if (result.error) {
+            metrics_->recordError(MetricOp::MGet);
+        }
+    }
+    metrics_->increment(route, results.size());
+    metrics_->increment(MetricCounter::Hits, hits);
+    metrics_->increment(MetricCounter::Misses, results.size() - hits);
+    metrics_->recordBytes(MetricOp::MGet, 0, bytes_out);
+}
+
+/**
+ * 以Prometheus文本格式输出本节点的缓存指标
+ * @return Prometheus文本，包括操作指标和本地键数量
+ */
+std::string CacheServer::renderMetrics() {
+    std::string text = metrics_->renderPrometheus();
+    
+    size_t key_count = store_->size();
+    text += "# HELP cache_local_keys 本节点存储的键数量\n";
+    text += "# TYPE cache_local_keys gauge\n";
+    text += "cache_local_keys " + std::to_string(key_count) + "\n";
+    
+    // 惰性释放队列积压说明后台释放跟不上删除速度
+    text += "# HELP cache_lazy_free_pending 等待后台释放的条目数量\n";
+    text += "# TYPE cache_lazy_free_pending gauge\n";
+    text += "cache_lazy_free_pending " + std::to_string(store_->lazyFreePending()) + "\n";
+    text += "# HELP cache_lazy_freed_total 已经在后台释放的条目数量\n";
+    text += "# TYPE cache_lazy_freed_total counter\n";
+    text += "cache_lazy_freed_total " + std::to_string(store_->lazyFreed()) + "\n";
+    
+    // 大页不可用时会退回到透明大页或普通页，按实际得到的页面类型分别统计
+    if (options_.huge_pages > 0 && !options_.store_art_index) {
+        text += "# HELP cache_huge_page_bytes 本地存储哈希表按页面类型映射的内存\n";
+        text += "# TYPE cache_huge_page_bytes gauge\n";
+        for (int kind = 0; kind < static_cast<int>(PageKind::Count); kind++) {
+            PageKind page_kind = static_cast<PageKind>(kind);
+            text += "cache_huge_page_bytes{kind=\"" + std::string(HugePageArena::kindName(page_kind)) + "\"} " +
+                    std::to_string(store_->hugePageBytes(page_kind)) + "\n";
+        }
+    }
+    
+    size_t bulk_jobs;
+    {
+        std::lock_guard<std::mutex> lock(bulk_delete_mutex_);
+        bulk_jobs = bulk_delete_jobs_.size();
+    }
+    text += "# HELP cache_bulk_delete_jobs 排队和正在执行的按模式删除任务数量\n";
+    text += "# TYPE cache_bulk_delete_jobs gauge\n";
+    text += "cache_bulk_delete_jobs " + std::to_string(bulk_jobs) + "\n";
+    text += "# HELP cache_bulk_deleted_total 按模式删除的键数量\n";
+    text += "# TYPE cache_bulk_deleted_total counter\n";
+    text += "cache_bulk_deleted_total " + std::to_string(bulk_deleted_.load()) + "\n";
+    
+    // 每核一线程模式下各核心线程执行的任务数量，分布不均说明分片数量不是线程数的整数倍或键有热点
+    if (cores_) {
+        std::vector<uint64_t> executed = cores_->executed();
+        text += "# HELP cache_core_tasks_total 核心线程执行的本地存储操作数量\n";
+        text += "# TYPE cache_core_tasks_total counter\n";
+        for (size_t i = 0; i < executed.size(); i++) {
+            text += "cache_core_tasks_total{core=\"" + std::to_string(i) + "\"} " + std::to_string(executed[i]) + "\n";
+        }
+        text += "# HELP cache_core_inlined_total 提交线程过多时在提交线程上直接执行的操作数量\n";
+        text += "# TYPE cache_core_inlined_total counter\n";
+        text += "cache_core_inlined_total " + std::to_string(cores_->inlined()) + "\n";
+        
+        // 提交线程与核心线程是否在同一个NUMA节点上，以及各自的平均耗时（seconds_total / total）
+        if (options_.numa_bind) {
+            NumaDispatchStats numa = cores_->numaStats();
+            text += "# HELP cache_core_node 核心线程所在的NUMA节点\n";
+            text += "# TYPE cache_core_node gauge\n";
+            for (size_t i = 0; i < cores_->size(); i++) {
+                text += "cache_core_node{core=\"" + std::to_string(i) + "\"} " + std::to_string(cores_->nodeOf(i)) + "\n";
+            }
+            text += "# HELP cache_numa_dispatch_total 交给核心线程执行的操作数量，按提交线程是否在同一个NUMA节点上区分\n";
+            text += "# TYPE cache_numa_dispatch_total counter\n";
+            text += "cache_numa_dispatch_total{locality=\"local\"} " + std::to_string(numa.local_tasks) + "\n";
+            text += "cache_numa_dispatch_total{locality=\"remote\"} " + std::to_string(numa.remote_tasks) + "\n";
+            text += "# HELP cache_numa_dispatch_seconds_total 交给核心线程执行的操作从入队到完成的总耗时\n";
+            text += "# TYPE cache_numa_dispatch_seconds_total counter\n";
+            text += "cache_numa_dispatch_seconds_total{locality=\"local\"} " +
+                    std::to_string(numa.local_nanos / 1e9) + "\n";
+            text += "cache_numa_dispatch_seconds_total{locality=\"remote\"} " +
+                    std::to_string(numa.remote_nanos / 1e9) + "\n";
+        }
+    }
+    
+    // 各命名空间的用量、配额和淘汰
+    std::vector<NamespaceStats> namespaces = store_->namespaceStats();
+    auto family = [&](const std::string& name, const char* type, const char* help, auto field) {
+        text += "# HELP " + name + " " + help + "\n";
+        text += "# TYPE " + name + " " + type + "\n";
+        for (const auto& ns : namespaces) {
+            text += name + "{namespace=\"" + ns.name + "\"} " + std::to_string(ns.*field) + "\n";
+        }
+    };
+    family("cache_namespace_bytes", "gauge", "命名空间在本节点占用的字节数（估算）", &NamespaceStats::bytes);
+    family("cache_namespace_quota_bytes", "gauge", "命名空间在本节点的内存配额，0表示不限制", &NamespaceStats::quota_bytes);
+    family("cache_namespace_keys", "gauge", "命名空间在本节点的键数量", &NamespaceStats::keys);
+    family("cache_namespace_hits_total", "counter", "命名空间的读取命中次数", &NamespaceStats::hits);
+    family("cache_namespace_misses_total", "counter", "命名空间的读取未命中次数", &NamespaceStats::misses);
+    family("cache_namespace_evictions_total", "counter", "命名空间因超出配额被淘汰的键数量", &NamespaceStats::evictions);
+    
+    // 各个目标节点的gRPC调用指标
+    text += grpc_client_->renderPeerMetrics();
+    return text;
+}
+
+/**
+ * 以JSON格式输出本节点发往各个节点的gRPC调用概况
+ * @return JSON文本
+ */
+std::string CacheServer::renderPeers() {
+    return grpc_client_->renderPeersJson();
+}
+
+/**
+ * 获取本节点的热点键
+ * 统计的是经过本节点get/set入口的访问，包括最终转发到其他节点的键
+ * @param limit 最多返回的键数量
+ * @return 按估算访问次数从高到低排列的热点键
+ */
+std::vector<HotKey> CacheServer::getHotKeys(size_t limit) {
+    return hot_keys_->topK(limit);
+}
+
+/**
+ * 获取集群中每个节点的热点键
+ * 本节点直接读取，其他节点通过gRPC依次获取
+ * @param limit 每个节点最多返回的键数量
+ * @return 节点ID到该节点热点键的映射
+ */
+std::vector<std::pair<std::string, std::vector<HotKey>>> CacheServer::getClusterHotKeys(size_t limit) {
+    std::vector<std::pair<std::string, std::vector<HotKey>>> result;
+    for (const auto& node : hash_ring_->getAllNodes()) {
+        if (node.id == node_id_) {
+            result.emplace_back(node.id, getHotKeys(limit));
+            continue;
+        }
+        std::vector<HotKey> hot_keys;
+        if (grpc_client_->hotKeys(node, limit, hot_keys)) {
+            result.emplace_back(node.id, hot_keys);
+        }
+    }
+    return result;
+}
+
+/**
+ * 向集群添加节点
+ * @param node 要添加的节点信息
+ * 将新节点添加到一致性哈希环中，实现集群的动态扩展
+ */
+void CacheServer::addNode(const Node& node) {
+    hash_ring_->addNode(node);
+    std::cout << "已添加节点: " << node.id << " (" << node.host << ":" << node.grpc_port << ")" << std::endl;
+}
+
+/**
+ * 从集群移除节点
+ * @param node_id 要移除的节点ID
+ * 从一致性哈希环中移除节点，实现集群的动态缩容
+ */
+void CacheServer::removeNode(const std::string& node_id) {
+    hash_ring_->removeNode(node_id);
+    std::cout << "已移除节点: " << node_id << std::endl;
+}
+
+/**
+ * gRPC Get服务实现
+ * @param context gRPC服务器上下文
+ * @param request 获取请求，包含要查找的键
+ * @param response 获取响应，包含查找结果和值
+ * @return gRPC状态
+ * 处理来自其他节点的获取请求，只在本地缓存中查找
+ */
+grpc::Status CacheServer::Get(grpc::ServerContext* context,
+                              const cache::GetRequest* request,
+                              cache::GetResponse* response) {
+    // 转发来的读取也计入热点统计，负责节点才能看到键的全部访问
+    hot_keys_->record(request->key());
+    
+    // 请求方会缓存结果：先登记再读取，之后的修改都会通知到请求方
+    if (!request->requester_id().empty()) {
+        auto expires_at = std::chrono::steady_clock::now() + std::chrono::milliseconds(request->cache_ttl_ms());
+        std::lock_guard<std::mutex> lock(fetchers_mutex_);
+        fetchers_[request->key()][request->requester_id()] = expires_at;
+    }
+    
+    std::string value;
+    ReadMeta meta;
+    // 在本地缓存中查找键值，未命中时读穿透加载
+    bool found = getOrLoadLocal(request->key(), value, &meta);
+    
+    // 设置响应结果
+    response->set_found(found);
+    if (found) {
+        response->set_value(value);
+        response->set_stale(meta.stale);
+        response->set_refresh(meta.refresh);
+        response->set_ttl_ms(meta.ttl_ms);
+        response->set_version(meta.version);
+    }
+    
+    return grpc::Status::OK;
+}
+
+/**
+ * gRPC Set服务实现
+ * @param context gRPC服务器上下文
+ * @param request 设置请求，包含键值对
+ * @param response 设置响应，包含操作结果
+ * @return gRPC状态
+ * 处理来自其他节点的设置请求，将键值对存储到本地缓存
+ */
+grpc::Status CacheServer::Set(grpc::ServerContext* context,
+                              const cache::SetRequest* request,
+                              cache::SetResponse* response) {
+    // 在本地缓存中设置键值对
+    EntryTtl ttl;
+    ttl.ttl_ms = request->ttl_ms();
+    ttl.soft_ttl_ms = request->soft_ttl_ms();
+    ttl.recompute_ms = request->recompute_ms();
+    bool success = setLocal(request->key(), request->value(), ttl);
+    response->set_success(success);
+    
+    return grpc::Status::OK;
+}
+
+/**
+ * gRPC Delete服务实现
+ * @param context gRPC服务器上下文
+ * @param request 删除请求，包含要删除的键
+ * @param response 删除响应，包含操作结果
+ * @return gRPC状态
+ * 处理来自其他节点的删除请求，从本地缓存中删除指定键值
+ */
+grpc::Status CacheServer::Delete(grpc::ServerContext* context,
+                                 const cache::DeleteRequest* request,
+                                 cache::DeleteResponse* response) {
+    // 从本地缓存中删除键值
+    bool success = delLocal(request->key());
+    response->set_success(success);
+    
+    return grpc::Status::OK;
+}
+
+/**
+ * gRPC Health服务实现
+ * @param context gRPC服务器上下文
+ * @param request 健康检查请求
+ * @param response 健康检查响应，包含节点状态和ID
+ * @return gRPC状态
+ * 提供节点健康状态检查，用于集群监控和负载均衡
+ */
+grpc::Status CacheServer::Health(grpc::ServerContext* context,
+                                 const cache::HealthRequest* request,
+                                 cache::HealthResponse* response) {
+    // 设置节点健康状态和ID
+    response->set_healthy(true);
+    response->set_node_id(node_id_);
+    
+    return grpc::Status::OK;
+}
+
+/**
+ * gRPC MGet服务实现
+ * @param context gRPC服务器上下文
+ * @param request 批量获取请求，包含要查找的键列表
+ * @param response 批量获取响应，按请求顺序包含每个键的结果
+ * @return gRPC状态
+ * 处理来自其他节点的批量获取请求，只在本地缓存中查找
+ */
+grpc::Status CacheServer::MGet(grpc::ServerContext* context,
+                               const cache::MGetRequest* request,
+                               cache::MGetResponse* response) {
+    for (const auto& key : request->keys()) {
+        cache::KeyValue* entry = response->add_entries();
+        entry->set_key(key);
+        std::string value;
+        if (getLocal(key, value)) {
+            entry->set_found(true);
+            entry->set_value(value);
+        }
+    }
+    
+    return grpc::Status::OK;
+}
+
+/**
+ * gRPC HotKeys服务实现
+ * @param context gRPC服务器上下文
+ * @param request 热点键请求，包含最多返回的键数量
+ * @param response 热点键响应，包含本节点ID和热点键列表
+ * @return gRPC状态
+ */
+grpc::Status CacheServer::HotKeys(grpc::ServerContext* context,
+                                  const cache::HotKeysRequest* request,
+                                  cache::HotKeysResponse* response) {
+    response->set_node_id(node_id_);
+    for (const auto& hot_key : getHotKeys(request->limit())) {
+        cache::HotKeyEntry* entry = response->add_keys();
+        entry->set_key(hot_key.key);
+        entry->set_count(hot_key.count);
+        entry->set_error(hot_key.error);
+    }
+    
+    return grpc::Status::OK;
+}
+
+/**
+ * gRPC PushReplicas服务实现
+ * @param context gRPC服务器上下文
+ * @param request 推送副本请求，包含热点键的当前值和存活时间
+ * @param response 推送副本响应，包含接受的副本数量
+ * @return gRPC状态
+ * 保存负责节点推送来的热点副本；按本节点的哈希环判断属于自己的键不保存，
+ * 避免节点变更期间副本遮住本地的真实数据
+ */
+grpc::Status CacheServer::PushReplicas(grpc::ServerContext* context,
+                                       const cache::PushReplicasRequest* request,
+                                       cache::PushReplicasResponse* response) {
+    std::chrono::milliseconds ttl(request->ttl_ms());
+    uint32_t accepted = 0;
+    for (const auto& entry : request->entries()) {
+        if (!entry.found() || isLocalKey(entry.key())) {
+            continue;
+        }
+        replicas_->put(entry.key(), entry.value(), ttl);
+        accepted++;
+    }
+    response->set_accepted(accepted);
+    
+    return grpc::Status::OK;
+}
+
+/**
+ * gRPC Invalidate服务实现
+ * @param context gRPC服务器上下文
+ * @param request 失效通知请求，包含已被修改的键
+ * @param response 失效通知响应，包含实际删除的副本数量
+ * @return gRPC状态
+ */
+grpc::Status CacheServer::Invalidate(grpc::ServerContext* context,
+                                     const cache::InvalidateRequest* request,
+                                     cache::InvalidateResponse* response) {
+    uint32_t invalidated = 0;
+    for (const auto& key : request->keys()) {
+        // 之后到达的读取不再合并到修改前开始的转发
+        remote_flights_.forget(key);
+        if (replicas_->erase(key)) {
+            invalidated++;
+        }
+    }
+    if (near_cache_ || negative_cache_) {
+        std::lock_guard<std::mutex> lock(near_cache_mutex_);
+        invalidation_epoch_++;
+        for (const auto& key : request->keys()) {
+            if (near_cache_ && near_cache_->erase(key)) {
+                invalidated++;
+            }
+            if (negative_cache_ && negative_cache_->erase(key)) {
+                invalidated++;
+            }
+        }
+    }
+    response->set_invalidated(invalidated);
+    
+    return grpc::Status::OK;
+}
+
+/**
+ * gRPC LeaseGet服务实现
+ * @param context gRPC服务器上下文
+ * @param request 租约获取请求，包含缓存键
+ * @param response 租约获取响应，包含当前值、租约或等待标志
+ * @return gRPC状态
+ */
+grpc::Status CacheServer::LeaseGet(grpc::ServerContext* context,
+                                   const cache::LeaseGetRequest* request,
+                                   cache::LeaseGetResponse* response) {
+    hot_keys_->record(request->key());
+    
+    LeaseResult result;
+    leaseGetLocal(request->key(), result);
+    response->set_found(result.found);
+    response->set_value(result.value);
+    response->set_lease_token(result.token);
+    response->set_wait(result.wait);
+    response->set_stale(result.stale);
+    
+    return grpc::Status::OK;
+}
+
+/**
+ * gRPC LeaseSet服务实现
+ * @param context gRPC服务器上下文
+ * @param request 租约写入请求，包含键值对和租约
+ * @param response 租约写入响应，包含是否接受
+ * @return gRPC状态
+ */
+grpc::Status CacheServer::LeaseSet(grpc::ServerContext* context,
+                                   const cache::LeaseSetRequest* request,
+                                   cache::LeaseSetResponse* response) {
+    bool success = leaseSetLocal(request->key(), request->value(), request->lease_token());
+    response->set_success(success);
+    
+    return grpc::Status::OK;
+}
+
+/**
+ * gRPC Incr服务实现
+ * @param context gRPC服务器上下文
+ * @param request 原子自增请求，包含键和增量
+ * @param response 原子自增响应，包含操作结果和自增后的值
+ * @return gRPC状态
+ */
+grpc::Status CacheServer::Incr(grpc::ServerContext* context,
+                               const cache::IncrRequest* request,
+                               cache::IncrResponse* response) {
+    hot_keys_->record(request->key());
+    
+    int64_t result = 0;
+    OpStatus status = incrLocal(request->key(), request->delta(), result);
+    response->set_status(toStatusCode(status));
+    response->set_value(result);
+    
+    return grpc::Status::OK;
+}
+
+/**
+ * gRPC CompareAndSwap服务实现
+ * @param context gRPC服务器上下文
+ * @param request 比较并交换请求，包含键值对和期望的版本
+ * @param response 比较并交换响应，包含操作结果和版本
+ * @return gRPC状态
+ */
+grpc::Status CacheServer::CompareAndSwap(grpc::ServerContext* context,
+                                         const cache::CompareAndSwapRequest* request,
+                                         cache::CompareAndSwapResponse* response) {
+    hot_keys_->record(request->key());
+    
+    uint64_t version = 0;
+    OpStatus status = compareAndSwapLocal(request->key(), request->value(), request->version(), version);
+    response->set_status(toStatusCode(status));
+    response->set_version(version);
+    
+    return grpc::Status::OK;
+}
+
+/**
+ * gRPC Append服务实现
+ * @param context gRPC服务器上下文
+ * @param request 追加请求，包含键和追加的数据
+ * @param response 追加响应，包含操作结果和追加后的值长度
+ * @return gRPC状态
+ */
+grpc::Status CacheServer::Append(grpc::ServerContext* context,
+                                 const cache::AppendRequest* request,
+                                 cache::AppendResponse* response) {
+    hot_keys_->record(request->key());
+    
+    size_t length = 0;
+    OpStatus status = appendLocal(request->key(), request->data(), length);
+    response->set_status(toStatusCode(status));
+    response->set_length(length);
+    
+    return grpc::Status::OK;
+}
+
+/**
+ * gRPC GetRange服务实现
+ * @param context gRPC服务器上下文
+ * @param request 范围读取请求，包含键和范围
+ * @param response 范围读取响应，包含片段和完整值的长度
+ * @return gRPC状态
+ */
+grpc::Status CacheServer::GetRange(grpc::ServerContext* context,
+                                   const cache::GetRangeRequest* request,
+                                   cache::GetRangeResponse* response) {
+    hot_keys_->record(request->key());
+    
+    size_t length = 0;
+    bool found = onOwner(request->key(), [&]() {
+        return store_->getRange(request->key(), request->start(), request->end(), *response->mutable_value(), length);
+    });
+    response->set_found(found);
+    response->set_length(length);
+    
+    return grpc::Status::OK;
+}
+
+/**
+ * gRPC SetRange服务实现
+ * @param context gRPC服务器上下文
+ * @param request 范围写入请求，包含键、写入位置和数据
+ * @param response 范围写入响应，包含操作结果和写入后的值长度
+ * @return gRPC状态
+ */
+grpc::Status CacheServer::SetRange(grpc::ServerContext* context,
+                                   const cache::SetRangeRequest* request,
+                                   cache::SetRangeResponse* response) {
+    hot_keys_->record(request->key());
+    
+    size_t length = 0;
+    OpStatus status = setRangeLocal(request->key(), request->offset(), request->data(), length);
+    response->set_status(toStatusCode(status));
+    response->set_length(length);
+    
+    return grpc::Status::OK;
+}
+
+/**
+ * gRPC HashGet服务实现
+ * @param context gRPC服务器上下文
+ * @param request 哈希读取请求，包含键和字段名
+ * @param response 哈希读取响应，包含操作结果和字段
+ * @return gRPC状态
+ */
+grpc::Status CacheServer::HashGet(grpc::ServerContext* context,
+                                  const cache::HashGetRequest* request,
+                                  cache::HashGetResponse* response) {
+    hot_keys_->record(request->key());
+    
+    std::vector<FieldValue> fields(request->fields_size());
+    for (int i = 0; i < request->fields_size(); i++) {
+        fields[i].field = request->fields(i);
+    }
+    OpStatus status = onOwner(request->key(), [&]() { return store_->hashGet(request->key(), fields); });
+    response->set_status(toStatusCode(status));
+    if (status == OpStatus::Ok) {
+        for (auto& field : fields) {
+            cache::HashField* item = response->add_fields();
+            item->set_field(std::move(field.field));
+            item->set_found(field.found);
+            item->set_value(std::move(field.value));
+        }
+    }
+    
+    return grpc::Status::OK;
+}
+
+/**
+ * gRPC HashSet服务实现
+ * @param context gRPC服务器上下文
+ * @param request 哈希写入请求，包含键和字段
+ * @param response 哈希写入响应，包含操作结果和新增的字段数量
+ * @return gRPC状态
+ */
+grpc::Status CacheServer::HashSet(grpc::ServerContext* context,
+                                  const cache::HashSetRequest* request,
+                                  cache::HashSetResponse* response) {
+    hot_keys_->record(request->key());
+    
+    std::vector<FieldValue> fields;
+    fields.reserve(request->fields_size());
+    for (const auto& item : request->fields()) {
+        fields.emplace_back(item.field(), item.value());
+    }
+    size_t added = 0;
+    OpStatus status = hashSetLocal(request->key(), fields, added);
+    response->set_status(toStatusCode(status));
+    response->set_added(added);
+    
+    return grpc::Status::OK;
+}
+
+/**
+ * gRPC HashDel服务实现
+ * @param context gRPC服务器上下文
+ * @param request 哈希删除请求，包含键和字段名
+ * @param response 哈希删除响应，包含操作结果和删除的字段数量
+ * @return gRPC状态
+ */
+grpc::Status CacheServer::HashDel(grpc::ServerContext* context,
+                                  const cache::HashDelRequest* request,
+                                  cache::HashDelResponse* response) {
+    std::vector<std::string> fields(request->fields().begin(), request->fields().end());
+    size_t removed = 0;
+    OpStatus status = hashDelLocal(request->key(), fields, removed);
+    response->set_status(toStatusCode(status));
+    response->set_removed(removed);
+    
+    return grpc::Status::OK;
+}
+
+/**
+ * gRPC MultiSet服务实现
+ * @param context gRPC服务上下文
+ * @param request 批量写入请求
+ * @param response 批量写入响应
+ * @return gRPC调用状态
+ */
+grpc::Status CacheServer::MultiSet(grpc::ServerContext* context,
+                                   const cache::MultiSetRequest* request,
+                                   cache::MultiSetResponse* response) {
+    std::vector<std::pair<std::string, std::string>> entries;
+    entries.reserve(request->entries_size());
+    for (const auto& entry : request->entries()) {
+        entries.emplace_back(entry.key(), entry.value());
+    }
+    EntryTtl ttl;
+    ttl.ttl_ms = request->ttl_ms();
+    ttl.soft_ttl_ms = request->soft_ttl_ms();
+    ttl.recompute_ms = request->recompute_ms();
+    
+    WriteCondition condition = WriteCondition::Always;
+    if (request->condition() == cache::WRITE_IF_NONE_EXIST) {
+        condition = WriteCondition::IfNoneExist;
+    } else if (request->condition() == cache::WRITE_IF_ALL_EXIST) {
+        condition = WriteCondition::IfAllExist;
+    }
+    
+    OpStatus status = entries.empty() ? OpStatus::Invalid : multiSetLocal(entries, ttl, condition);
+    response->set_status(toStatusCode(status));
+    
+    return grpc::Status::OK;
+}
+
+/**
+ * gRPC MultiDel服务实现
+ * @param context gRPC服务上下文
+ * @param request 批量删除请求
+ * @param response 批量删除响应
+ * @return gRPC调用状态
+ */
+grpc::Status CacheServer::MultiDel(grpc::ServerContext* context,
+                                   const cache::MultiDelRequest* request,
+                                   cache::MultiDelResponse* response) {
+    std::vector<std::string> keys(request->keys().begin(), request->keys().end());
+    size_t deleted = 0;
+    OpStatus status = keys.empty() ? OpStatus::Invalid : multiDelLocal(keys, deleted);
+    response->set_status(toStatusCode(status));
+    response->set_deleted(deleted);
+    
+    return grpc::Status::OK;
+}
+
+/**
+ * gRPC Scan服务实现
+ * @param context gRPC服务上下文
+ * @param request 遍历请求
+ * @param response 遍历响应
+ * @return gRPC调用状态
+ */
+grpc::Status CacheServer::Scan(grpc::ServerContext* context,
+                               const cache::ScanRequest* request,
+                               cache::ScanResponse* response) {
+    std::vector<std::string> keys;
+    std::string next;
+    bool valid = scanLocal(request->cursor(), request->count(), request->match(), keys, next);
+    response->set_status(valid ? cache::OP_OK : cache::OP_INVALID);
+    for (auto& key : keys) {
+        response->add_keys(std::move(key));
+    }
+    response->set_cursor(next);
+    
+    return grpc::Status::OK;
+}
+
+/**
+ * gRPC DeleteMatching服务实现
+ * @param context gRPC服务上下文
+ * @param request 按模式删除请求
+ * @param response 按模式删除响应
+ * @return gRPC调用状态
+ */
+grpc::Status CacheServer::DeleteMatching(grpc::ServerContext* context,
+                                         const cache::DeleteMatchingRequest* request,
+                                         cache::DeleteMatchingResponse* response) {
+    deleteMatchingLocal(request->match());
+    response->set_status(cache::OP_OK);
+    
+    return grpc::Status::OK;
+}
+
+/**
+ * gRPC ConfigureNamespace服务实现
+ * @param context gRPC服务上下文
+ * @param request 命名空间配置请求
+ * @param response 命名空间配置响应
+ * @return gRPC调用状态
+ */
+grpc::Status CacheServer::ConfigureNamespace(grpc::ServerContext* context,
+                                             const cache::ConfigureNamespaceRequest* request,
+                                             cache::ConfigureNamespaceResponse* response) {
+    OpStatus status = configureNamespaceLocal(request->name(), request->quota_bytes(), request->remove());
+    response->set_status(toStatusCode(status));
+    
+    return grpc::Status::OK;
+}
+
+/**
+ * 后台线程主循环
+ * 每个周期推送一次热点副本并清理过期的近端缓存登记，stop()时通过条件变量立即唤醒退出
+ */
+void CacheServer::backgroundLoop() {
+    std::chrono::milliseconds interval(options_.replication_interval_ms);
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(background_mutex_);
+            background_cv_.wait_for(lock, interval, [this]() { return !running_; });
+            if (!running_) {
+                return;
+            }
+        }
+        if (options_.hot_key_replication) {
+            replicateHotKeys();
+        }
+        purgeFetchers();
+        store_->purgeLeases();
+        store_->sweepExpired();
+        store_->enforceQuotas();
+    }
+}
+
+/**
+ * 按模式删除线程主循环
+ * 每个任务按游标分批删除，每批检查kBulkDeleteBatch个条目、只持有一个分片的锁，
+ * 批与批之间让出CPU，请求处理线程不会被长时间阻塞。删除的键按普通删除的方式通知持有副本的节点
+ */
+void CacheServer::bulkDeleteLoop() {
+    while (true) {
+        std::string match;
+        {
+            std::unique_lock<std::mutex> lock(bulk_delete_mutex_);
+            bulk_delete_cv_.wait(lock, [this]() { return !running_ || !bulk_delete_jobs_.empty(); });
+            if (!running_) {
+                return;
+            }
+            match = bulk_delete_jobs_.front();  // 执行期间留在队首，相同模式的新任务排在后面
+        }
+        
+        std::string cursor = "0";
+        std::vector<std::string> keys;
+        do {
+            keys.clear();
+            std::string next;
+            store_->deleteMatching(cursor, kBulkDeleteBatch, match, keys, next);
+            cursor = next;
+            if (!keys.empty()) {
+                bulk_deleted_ += keys.size();
+                notifyKeysChanged(keys);
+            }
+            std::this_thread::yield();
+        } while (cursor != "0" && running_);
+        
+        std::lock_guard<std::mutex> lock(bulk_delete_mutex_);
+        bulk_delete_jobs_.pop_front();
+    }
+}
+
+/**
+ * 清理已经过期的近端缓存登记
+ * 请求方的近端缓存条目过期后不再需要失效通知
+ */
+void CacheServer::purgeFetchers() {
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(fetchers_mutex_);
+    for (auto it = fetchers_.begin(); it != fetchers_.end();) {
+        auto& nodes = it->second;
+        for (auto node_it = nodes.begin(); node_it != nodes.end();) {
+            if (node_it->second <= now) {
+                node_it = nodes.erase(node_it);
+            } else {
+                ++node_it;
+            }
+        }
+        if (nodes.empty()) {
+            it = fetchers_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+/**
+ * 把本节点负责的热点键推送到其他所有节点
+ * 先登记键再读取当前值：登记之后发生的写入都会广播失效，
+ * 推送期间发生写入时失效通知可能先于副本到达，推送完成后对这些键再补发一次失效
+ * 键持续保持热点时每个周期都会重新推送，副本的过期时间随之刷新
+ */
+void CacheServer::replicateHotKeys() {
+    std::vector<Node> peers = otherNodes();
+    
+    auto now = std::chrono::steady_clock::now();
+    auto expires_at = now + std::chrono::milliseconds(options_.replica_ttl_ms);
+    
+    // 清理副本已经全部过期的登记
+    {
+        std::lock_guard<std::mutex> lock(replication_mutex_);
+        for (auto it = replicated_keys_.begin(); it != replicated_keys_.end();) {
+            if (it->second.expires_at <= now) {
+                it = replicated_keys_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    if (peers.empty()) {
+        return;
+    }
+    
+    // 选出访问次数达到阈值、且由本节点负责的热点键
+    std::vector<KeyValueResult> entries;
+    std::unordered_map<std::string, uint64_t> writes_before;
+    for (const auto& hot_key : hot_keys_->topK(options_.replica_max_keys)) {
+        if (hot_key.count < static_cast<uint64_t>(options_.replica_min_count)) {
+            break;  // 结果按访问次数降序排列
+        }
+        if (!isLocalKey(hot_key.key)) {
+            continue;
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(replication_mutex_);
+            ReplicatedKey& replicated = replicated_keys_[hot_key.key];
+            replicated.expires_at = expires_at;
+            writes_before[hot_key.key] = replicated.writes;
+        }
+        
+        // 已软过期或即将硬过期的值不复制，副本的存活时间不能超过值本身
+        KeyValueResult entry;
+        entry.key = hot_key.key;
+        ReadMeta meta;
+        if (getLocal(hot_key.key, entry.value, &meta) && !meta.stale &&
+            (meta.ttl_ms < 0 || meta.ttl_ms >= options_.replica_ttl_ms)) {
+            entries.push_back(entry);
+        }
+    }
+    if (entries.empty()) {
+        return;
+    }
+    
+    // 并行推送到其他所有节点
+    std::vector<std::future<bool>> pending;
+    for (const auto& node : peers) {
+        pending.push_back(std::async(std::launch::async, [this, node, &entries]() {
+            return grpc_client_->pushReplicas(node, node_id_, entries, options_.replica_ttl_ms);
+        }));
+    }
+    for (auto& future : pending) {
+        future.get();
+    }
+    
+    // 推送期间被修改的键，补发一次失效通知
+    std::vector<std::string> changed;
+    {
+        std::lock_guard<std::mutex> lock(replication_mutex_);
+        for (const auto& entry : entries) {
+            auto it = replicated_keys_.find(entry.key);
+            if (it != replicated_keys_.end() && it->second.writes != writes_before[entry.key]) {
+                changed.push_back(entry.key);
+            }
+        }
+    }
+    if (!changed.empty()) {
+        sendInvalidation(peers, changed);
+    }
+}
+
+/**
+ * 本地键被修改后调用
+ * @param key 被修改的键
+ */
+void CacheServer::notifyKeyChanged(const std::string& key) {
+    notifyKeysChanged({key});
+}
+
+/**
+ * 一批本地键被修改后调用
+ * 存在热点副本的键通知所有节点，否则只通知近端缓存中可能有该键的节点；
+ * 两者都没有的普通写入每个键只多两次哈希表查找。
+ * 需要通知的键按目标节点分组，每个节点只发一次Invalidate，各节点并行发送
+ * @param keys 被修改的键
+ */
+void CacheServer::notifyKeysChanged(const std::vector<std::string>& keys) {
+    auto now = std::chrono::steady_clock::now();
+    std::vector<Node> others;
+    std::unordered_map<std::string, std::vector<std::string>> by_node;
+    for (const auto& key : keys) {
+        bool replicated = false;
+        {
+            std::lock_guard<std::mutex> lock(replication_mutex_);
+            auto it = replicated_keys_.find(key);
+            if (it != replicated_keys_.end()) {
+                it->second.writes++;
+                replicated = true;
+            }
+        }
+        
+        // 取出并清除登记，请求方下次转发读取时会重新登记
+        std::unordered_map<std::string, std::chrono::steady_clock::time_point> fetchers;
+        {
+            std::lock_guard<std::mutex> lock(fetchers_mutex_);
+            auto it = fetchers_.find(key);
+            if (it != fetchers_.end()) {
+                fetchers.swap(it->second);
+                fetchers_.erase(it);
+            }
+        }
+        if (!replicated && fetchers.empty()) {
+            continue;
+        }
+        
+        if (others.empty()) {
+            others = otherNodes();
+        }
+        for (const auto& node : others) {
+            auto it = fetchers.find(node.id);
+            if (replicated || (it != fetchers.end() && it->second > now)) {
+                by_node[node.id].push_back(key);
+            }
+        }
+    }
+    if (by_node.empty()) {
+        return;
+    }
+    
+    std::vector<std::future<bool>> pending;
+    for (const auto& node : others) {
+        auto it = by_node.find(node.id);
+        if (it == by_node.end()) {
+            continue;
+        }
+        const std::vector<std::string>& node_keys = it->second;
+        pending.push_back(std::async(std::launch::async, [this, node, &node_keys]() {
+            return grpc_client_->invalidate(node, node_id_, node_keys);
+        }));
+    }
+    for (auto& future : pending) {
+        future.get();
+    }
+}
+
+/**
+ * 向一组节点并行发送失效通知
+ * 等待所有节点返回（或超时）后才返回，写操作返回时其他节点上的旧副本已经删除
+ * @param targets 目标节点
+ * @param keys 已被修改的键
+ */
+void CacheServer::sendInvalidation(const std::vector<Node>& targets, const std::vector<std::string>& keys) {
+    std::vector<std::future<bool>> pending;
+    for (const auto& node : targets) {
+        pending.push_back(std::async(std::launch::async, [this, node, &keys]() {
+            return grpc_client_->invalidate(node, node_id_, keys);
+        }));
+    }
+    for (auto& future : pending) {
+        future.get();
+    }
+}
+
+/**
+ * 获取除本节点以外的所有节点
+ * @return 其他节点列表
+ */
+std::vector<Node> CacheServer::otherNodes() const {
+    std::vector<Node> nodes;
+    for (const auto& node : hash_ring_->getAllNodes()) {
+        if (node.id != node_id_) {
+            nodes.push_back(node);
+        }
+    }
+    return nodes;
+}
+
+/**
+ * 判断键值是否属于本地节点
+ * @param key 要检查的键
+ * @return 如果键值应该存储在本地节点返回true，否则返回false
+ * 使用一致性哈希算法确定键值的归属节点
+ */
+bool CacheServer::isLocalKey(const std::string& key) const {
+    try {
+        // 通过一致性哈希算法获取键值对应的目标节点
+        Node target_node = hash_ring_->getNode(key);
+        return target_node.id == node_id_;  // 检查是否为当前节点
+    } catch (const std::exception& e) {
+        return true; // 如果没有可用节点，默认为本地处理
+    }
+}
+
+/**
+ * 把操作结果转换为协议中的取值
+ * @param status 操作结果
+ * @return 协议中的操作结果
+ */
+cache::OpStatusCode CacheServer::toStatusCode(OpStatus status) {
+    switch (status) {
+        case OpStatus::Ok:
+            return cache::OP_OK;
+        case OpStatus::NotFound:
+            return cache::OP_NOT_FOUND;
+        case OpStatus::Conflict:
+            return cache::OP_CONFLICT;
+        case OpStatus::CrossNode:
+            return cache::OP_CROSS_NODE;
+        default:
+            return cache::OP_INVALID;
+    }
+}
+
+/**
+ * 从本地缓存获取值
+ * @param key 缓存键
+ * @param value 输出参数，存储获取到的值
+ * @param meta 输出参数（可为空），值的过期状态
+ * @param claim_refresh 是否允许本次读取领取刷新任务
+ * @return 是否成功获取到值
+ * 读到已硬过期的条目时顺便删除
+ */
+bool CacheServer::getLocal(const std::string& key, std::string& value, ReadMeta* meta, bool claim_refresh) {
+    ScopedLatency timer(metrics_.get(), MetricOp::GetLocal);
+    return onOwner(key, [&]() { return store_->get(key, value, meta, claim_refresh); });
+}
+
+/**
+ * 向本地缓存设置值
+ * @param key 缓存键
+ * @param value 要设置的值
+ * @param ttl 过期参数
+ * @return 是否成功设置（总是返回true）
+ * 新条目的刷新任务状态随之重置
+ */
+bool CacheServer::setLocal(const std::string& key, const std::string& value, const EntryTtl& ttl) {
+    ScopedLatency timer(metrics_.get(), MetricOp::SetLocal);
+    
+    // 设置键值对到本地存储，未完成的租约随之失效
+    onOwner(key, [&]() { store_->set(key, value, ttl); });
+    
+    // 键在其他节点有副本时广播失效
+    notifyKeyChanged(key);
+    return true;  // 设置操作总是成功
+}
+
+/**
+ * 从本地缓存删除值
+ * @param key 要删除的缓存键
+ * @return 是否成功删除（键存在时返回true，不存在时返回false）
+ */
+bool CacheServer::delLocal(const std::string& key) {
+    ScopedLatency timer(metrics_.get(), MetricOp::DelLocal);
+    
+    // 删除键值，未完成的租约随之失效；保留旧值供租约未命中时使用（交给后台释放的大值不保留）
+    std::string old_value;
+    bool existed = onOwner(key, [&]() { return store_->del(key, &old_value); });
+    if (existed) {
+        if (!old_value.empty()) {
+            stale_values_->put(key, old_value, std::chrono::milliseconds(options_.stale_ttl_ms));
+        }
+        
+        // 键在其他节点有副本时广播失效
+        notifyKeyChanged(key);
+    }
+    return existed;  // 键存在时返回true
 }
\ No newline at end of file
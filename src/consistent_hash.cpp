@@ -64,6 +64,7 @@ void ConsistentHash::removeNode(const std::string& node_id) {
  * @param key 要查找的键值（通常是缓存的key或数据标识）
  * @return 负责处理该键值的节点信息
  * 该函数实现了一致性哈希的核心算法：顺时针查找最近的节点
+ * 带哈希标签的键按标签定位，例如user:{42}:profile和user:{42}:orders总在同一个节点
  */
 Node ConsistentHash::getNode(const std::string& key) const {
     // 检查哈希环是否为空
@@ -71,8 +72,8 @@ Node ConsistentHash::getNode(const std::string& key) const {
         throw std::runtime_error("没有可用节点"); // 没有可用节点
     }
     
-    // 计算键值的哈希值，确定其在哈希环上的位置
-    uint32_t hash_value = hash(key);
+    // 计算键值（或其哈希标签）的哈希值，确定其在哈希环上的位置
+    uint32_t hash_value = hash(hashTag(key));
     
     // 在哈希环上顺时针查找第一个大于等于该哈希值的虚拟节点
     auto it = ring_.lower_bound(hash_value);
@@ -109,6 +110,23 @@ bool ConsistentHash::hasNode(const std::string& node_id) const {
     return nodes_.find(node_id) != nodes_.end();
 }
 
+/**
+ * 获取键中参与哈希计算的部分
+ * @param key 缓存键
+ * @return 哈希标签；没有标签或标签为空（例如"{}"）时返回整个键
+ */
+std::string ConsistentHash::hashTag(const std::string& key) {
+    size_t open = key.find('{');
+    if (open == std::string::npos) {
+        return key;
+    }
+    size_t close = key.find('}', open + 1);
+    if (close == std::string::npos || close == open + 1) {
+        return key;
+    }
+    return key.substr(open + 1, close - open - 1);
+}
+
 /**
  * 计算字符串的哈希值
  * @param str 要计算哈希值的字符串
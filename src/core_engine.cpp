@@ -0,0 +1,295 @@
+#include "core_engine.h"
+#include <pthread.h>
+#include <sched.h>
+#include <algorithm>
+
+/**
+ * 提交线程的注册信息
+ * 只持有提交线程状态的弱引用，引擎先析构时线程退出不会访问已释放的内存
+ */
+struct CoreEngine::Registration {
+    uint64_t engine_id = 0;                // 领取编号的引擎
+    std::weak_ptr<Producer[]> producers;   // 该引擎的提交线程状态
+    size_t index = kMaxProducers;          // 领取的提交线程编号
+
+    ~Registration() { release(); }
+
+    /**
+     * 归还领取的编号
+     */
+    void release() {
+        if (auto owner = producers.lock()) {
+            owner[index].in_use.store(false, std::memory_order_release);
+        }
+        producers.reset();
+        engine_id = 0;
+        index = kMaxProducers;
+    }
+};
+
+std::atomic<uint64_t> CoreEngine::next_id_(0);
+
+thread_local CoreEngine::Registration CoreEngine::registration_;
+thread_local const CoreEngine* CoreEngine::current_engine_ = nullptr;
+thread_local size_t CoreEngine::current_core_ = 0;
+
+/**
+ * 构造函数
+ * 为每个核心预先创建来自所有提交线程编号的队列，之后领取和归还编号都不需要分配内存。
+ * 不按NUMA分布时把所有可用CPU视为一个节点，第i个核心线程绑定到第i个CPU；
+ * 按NUMA分布时第i个核心线程放在第i % 节点数个节点上，绑定到该节点的第i / 节点数个CPU
+ * @param cores 核心线程数量
+ * @param numa 是否按NUMA节点分布核心线程
+ */
+CoreEngine::CoreEngine(size_t cores, bool numa)
+    : id_(++next_id_), producers_(new Producer[kMaxProducers]), producer_limit_(0), running_(true), inlined_(0),
+      topology_(NumaTopology::detect()), numa_(numa) {
+    std::vector<int> all_cpus;
+    for (size_t node = 0; node < topology_.nodeCount(); node++) {
+        all_cpus.insert(all_cpus.end(), topology_.cpusOf(node).begin(), topology_.cpusOf(node).end());
+    }
+    std::sort(all_cpus.begin(), all_cpus.end());
+
+    for (size_t i = 0; i < std::max<size_t>(cores, 1); i++) {
+        auto core = std::make_unique<Core>();
+        for (size_t p = 0; p < kMaxProducers; p++) {
+            core->queues.push_back(std::make_unique<SpscQueue<Task*>>(kQueueCapacity));
+        }
+        if (numa_) {
+            core->node = i % topology_.nodeCount();
+            const std::vector<int>& cpus = topology_.cpusOf(core->node);
+            core->cpu = cpus[(i / topology_.nodeCount()) % cpus.size()];
+        } else {
+            core->cpu = all_cpus[i % all_cpus.size()];
+            core->node = topology_.nodeOfCpu(core->cpu);
+        }
+        cores_.push_back(std::move(core));
+    }
+    for (size_t i = 0; i < cores_.size(); i++) {
+        cores_[i]->thread = std::thread(&CoreEngine::coreLoop, this, i);
+    }
+}
+
+/**
+ * 析构函数
+ * 核心线程执行完队列中剩余的任务后退出
+ */
+CoreEngine::~CoreEngine() {
+    running_ = false;
+    for (auto& core : cores_) {
+        {
+            std::lock_guard<std::mutex> lock(core->mutex);
+            core->wake = true;
+        }
+        core->cv.notify_one();
+    }
+    for (auto& core : cores_) {
+        core->thread.join();
+    }
+}
+
+/**
+ * 各核心线程执行的任务数量
+ * @return 每个核心一项
+ */
+std::vector<uint64_t> CoreEngine::executed() const {
+    std::vector<uint64_t> counts;
+    for (const auto& core : cores_) {
+        counts.push_back(core->executed.load(std::memory_order_relaxed));
+    }
+    return counts;
+}
+
+/**
+ * 跨线程提交任务的NUMA统计
+ * 累加所有提交线程编号上的计数，各编号的数值不是同一时刻的快照
+ * @return 统计
+ */
+NumaDispatchStats CoreEngine::numaStats() const {
+    NumaDispatchStats stats{0, 0, 0, 0};
+    for (size_t i = 0; i < kMaxProducers; i++) {
+        const Producer& producer = producers_[i];
+        stats.local_tasks += producer.local_tasks.load(std::memory_order_relaxed);
+        stats.remote_tasks += producer.remote_tasks.load(std::memory_order_relaxed);
+        stats.local_nanos += producer.local_nanos.load(std::memory_order_relaxed);
+        stats.remote_nanos += producer.remote_nanos.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+/**
+ * 提交任务并等待执行完毕
+ * 入队后只在核心线程休眠时加锁唤醒。按NUMA分布时记录提交线程当前所在的节点和任务耗时，
+ * 提交线程可能随时被调度到其他CPU，节点按入队时所在的CPU计算
+ * @param core 核心编号
+ * @param task 任务
+ */
+void CoreEngine::submit(size_t core, Task& task) {
+    if (current_engine_ == this && current_core_ == core) {
+        task.invoke(task.context);
+        return;
+    }
+    size_t index = producerIndex();
+    if (index >= kMaxProducers) {
+        inlined_.fetch_add(1, std::memory_order_relaxed);
+        task.invoke(task.context);  // 分区仍由分片锁保护，就地执行只是失去了缓存亲和性
+        return;
+    }
+
+    Producer& producer = producers_[index];
+    Core& target = *cores_[core];
+    bool local = true;
+    std::chrono::steady_clock::time_point started;
+    if (numa_) {
+        local = topology_.nodeOfCpu(sched_getcpu()) == target.node;
+        started = std::chrono::steady_clock::now();
+    }
+    task.producer = &producer;
+    producer.done.store(false, std::memory_order_relaxed);
+    while (!target.queues[index]->push(&task)) {
+        std::this_thread::yield();
+    }
+
+    // 与coreLoop中休眠前的检查配对：要么核心线程看到新任务，要么这里看到它在休眠
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (target.sleeping.load(std::memory_order_relaxed)) {
+        {
+            std::lock_guard<std::mutex> lock(target.mutex);
+            target.wake = true;
+        }
+        target.cv.notify_one();
+    }
+
+    wait(producer);
+    if (numa_) {
+        uint64_t nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - started).count();
+        // 只有本线程写入这些计数，不需要原子的读-改-写
+        std::atomic<uint64_t>& tasks = local ? producer.local_tasks : producer.remote_tasks;
+        std::atomic<uint64_t>& total = local ? producer.local_nanos : producer.remote_nanos;
+        tasks.store(tasks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        total.store(total.load(std::memory_order_relaxed) + nanos, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * 等待提交线程的当前任务执行完毕
+ * 先让出CPU几次，任务很快完成时不必休眠
+ * @param producer 提交线程状态
+ */
+void CoreEngine::wait(Producer& producer) {
+    for (int spin = 0; spin < 64; spin++) {
+        if (producer.done.load(std::memory_order_acquire)) {
+            return;
+        }
+        std::this_thread::yield();
+    }
+    producer.waiting.store(true, std::memory_order_seq_cst);
+    {
+        std::unique_lock<std::mutex> lock(producer.mutex);
+        producer.cv.wait(lock, [&producer]() { return producer.done.load(std::memory_order_acquire); });
+    }
+    producer.waiting.store(false, std::memory_order_relaxed);
+}
+
+/**
+ * 获取当前线程的提交线程编号
+ * 首次调用时领取一个空闲编号，线程退出时由Registration归还
+ * @return 提交线程编号，全部被占用时返回kMaxProducers
+ */
+size_t CoreEngine::producerIndex() {
+    if (registration_.engine_id == id_) {
+        return registration_.index;  // 只比较编号，不在热路径上增减共享的引用计数
+    }
+    registration_.release();
+    for (size_t i = 0; i < kMaxProducers; i++) {
+        bool expected = false;
+        if (!producers_[i].in_use.load(std::memory_order_relaxed) &&
+            producers_[i].in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            registration_.engine_id = id_;
+            registration_.producers = producers_;
+            registration_.index = i;
+            // 扩大核心线程检查的范围
+            size_t limit = producer_limit_.load(std::memory_order_relaxed);
+            while (limit < i + 1 &&
+                   !producer_limit_.compare_exchange_weak(limit, i + 1, std::memory_order_release)) {
+            }
+            return i;
+        }
+    }
+    return kMaxProducers;
+}
+
+/**
+ * 核心线程主循环
+ * 轮流从各条队列取出任务执行；连续空转一段时间后休眠，提交线程入队时发现它在休眠才唤醒
+ * @param index 核心编号
+ */
+void CoreEngine::coreLoop(size_t index) {
+    Core& core = *cores_[index];
+    pinToCpu(core.cpu);
+    if (numa_) {
+        topology_.preferMemory(core.node);  // 分区中的条目由核心线程分配，落在所在节点上
+    }
+    current_engine_ = this;
+    current_core_ = index;
+
+    int idle = 0;
+    while (true) {
+        bool worked = false;
+        size_t limit = producer_limit_.load(std::memory_order_acquire);
+        for (size_t p = 0; p < limit; p++) {
+            Task* task;
+            while (core.queues[p]->pop(task)) {
+                Producer* producer = task->producer;
+                task->invoke(task->context);
+                core.executed.fetch_add(1, std::memory_order_relaxed);
+                // 置位之后task所在的栈帧随时可能失效，只能再访问producer
+                producer->done.store(true, std::memory_order_seq_cst);
+                if (producer->waiting.load(std::memory_order_seq_cst)) {
+                    std::lock_guard<std::mutex> lock(producer->mutex);
+                    producer->cv.notify_one();
+                }
+                worked = true;
+            }
+        }
+        if (worked) {
+            idle = 0;
+            continue;
+        }
+        if (!running_) {
+            return;  // 队列已经清空
+        }
+        if (++idle < 64) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        core.sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool pending = false;
+        limit = producer_limit_.load(std::memory_order_acquire);
+        for (size_t p = 0; p < limit && !pending; p++) {
+            pending = !core.queues[p]->empty();
+        }
+        if (!pending) {
+            std::unique_lock<std::mutex> lock(core.mutex);
+            core.cv.wait_for(lock, std::chrono::milliseconds(100), [&core]() { return core.wake; });
+            core.wake = false;
+        }
+        core.sleeping.store(false, std::memory_order_relaxed);
+        idle = 0;
+    }
+}
+
+/**
+ * 把当前线程绑定到指定CPU
+ * CPU取自NumaTopology，已经限制在进程的亲和性掩码（容器可能只分配了部分CPU）之内；绑定失败时不影响运行
+ * @param cpu CPU编号
+ */
+void CoreEngine::pinToCpu(int cpu) {
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    CPU_SET(cpu, &mask);
+    pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask);
+}
\ No newline at end of file
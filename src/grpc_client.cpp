@@ -2,12 +2,14 @@
 #include <grpcpp/create_channel.h>
 #include <grpcpp/security/credentials.h>
 #include <iostream>
+#include <json/json.h>
 
 /**
  * gRPC客户端构造函数
  * 初始化gRPC客户端，用于与其他缓存节点通信
+ * @param metrics 指标注册表，为空时不记录指标
  */
-GrpcClient::GrpcClient() {}
+GrpcClient::GrpcClient(Metrics* metrics) : metrics_(metrics) {}
 
 /**
  * 从远程节点获取缓存值
@@ -15,14 +17,16 @@ GrpcClient::GrpcClient() {}
  * @param node 目标节点信息
  * @param key 要获取的缓存键
  * @param value 输出参数，存储获取到的值
+ * @param meta 输出参数（可为空），值的过期状态
  * @return 是否成功获取
  */
-bool GrpcClient::get(const Node& node, const std::string& key, std::string& value) {
+bool GrpcClient::get(const Node& node, const std::string& key, std::string& value, ReadMeta* meta) {
     // 获取或创建到目标节点的gRPC连接
-    auto stub = getStub(node);
-    if (!stub) {
+    Peer* peer = getPeer(node);
+    if (!peer) {
         return false;
     }
+    CallScope call(this, peer, MetricOp::RpcGet);
     
     // 构建gRPC请求
     cache::GetRequest request;
@@ -32,42 +36,106 @@ bool GrpcClient::get(const Node& node, const std::string& key, std::string& valu
     grpc::ClientContext context;
     
     // 发送gRPC请求
-    grpc::Status status = stub->Get(&context, request, &response);
+    grpc::Status status = peer->stub->Get(&context, request, &response);
+    call.finish(status, request.ByteSizeLong(), response.ByteSizeLong());
     
     // 检查响应状态和结果
     if (status.ok() && response.found()) {
         value = response.value();
+        if (meta) {
+            meta->stale = response.stale();
+            meta->refresh = response.refresh();
+            meta->ttl_ms = response.ttl_ms();
+            meta->version = response.version();
+        }
         return true;
     }
     
     return false;
 }
 
+/**
+ * 从远程节点获取缓存值，并登记本节点会缓存结果
+ * @param node 目标节点信息
+ * @param key 要获取的缓存键
+ * @param requester_id 本节点ID
+ * @param cache_ttl_ms 本节点缓存结果的时间（毫秒）
+ * @param result 输出参数，存储查询结果
+ * @param meta 输出参数（可为空），值的过期状态
+ */
+void GrpcClient::fetch(const Node& node, const std::string& key, const std::string& requester_id,
+                       int cache_ttl_ms, KeyValueResult& result, ReadMeta* meta) {
+    result.key = key;
+    result.found = false;
+    result.error = true;
+    
+    // 获取或创建到目标节点的gRPC连接
+    Peer* peer = getPeer(node);
+    if (!peer) {
+        return;
+    }
+    CallScope call(this, peer, MetricOp::RpcGet);
+    
+    // 构建gRPC请求
+    cache::GetRequest request;
+    request.set_key(key);
+    request.set_requester_id(requester_id);
+    request.set_cache_ttl_ms(cache_ttl_ms);
+    
+    cache::GetResponse response;
+    grpc::ClientContext context;
+    
+    // 发送gRPC请求
+    grpc::Status status = peer->stub->Get(&context, request, &response);
+    call.finish(status, request.ByteSizeLong(), response.ByteSizeLong());
+    
+    if (status.ok()) {
+        result.error = false;
+        result.found = response.found();
+        if (result.found) {
+            result.value = response.value();
+            if (meta) {
+                meta->stale = response.stale();
+                meta->refresh = response.refresh();
+                meta->ttl_ms = response.ttl_ms();
+                meta->version = response.version();
+            }
+        }
+    }
+}
+
 /**
  * 向远程节点设置缓存值
  * 通过gRPC调用远程节点的Set服务设置键值对
  * @param node 目标节点信息
  * @param key 要设置的缓存键
  * @param value 要设置的缓存值
+ * @param ttl 过期参数
  * @return 是否成功设置
  */
-bool GrpcClient::set(const Node& node, const std::string& key, const std::string& value) {
+bool GrpcClient::set(const Node& node, const std::string& key, const std::string& value,
+                     const EntryTtl& ttl) {
     // 获取或创建到目标节点的gRPC连接
-    auto stub = getStub(node);
-    if (!stub) {
+    Peer* peer = getPeer(node);
+    if (!peer) {
         return false;
     }
+    CallScope call(this, peer, MetricOp::RpcSet);
     
     // 构建gRPC请求
     cache::SetRequest request;
     request.set_key(key);
     request.set_value(value);
+    request.set_ttl_ms(ttl.ttl_ms);
+    request.set_soft_ttl_ms(ttl.soft_ttl_ms);
+    request.set_recompute_ms(ttl.recompute_ms);
     
     cache::SetResponse response;
     grpc::ClientContext context;
     
     // 发送gRPC请求
-    grpc::Status status = stub->Set(&context, request, &response);
+    grpc::Status status = peer->stub->Set(&context, request, &response);
+    call.finish(status, request.ByteSizeLong(), response.ByteSizeLong());
     
     // 检查响应状态和结果
     return status.ok() && response.success();
@@ -82,10 +150,11 @@ bool GrpcClient::set(const Node& node, const std::string& key, const std::string
  */
 bool GrpcClient::del(const Node& node, const std::string& key) {
     // 获取或创建到目标节点的gRPC连接
-    auto stub = getStub(node);
-    if (!stub) {
+    Peer* peer = getPeer(node);
+    if (!peer) {
         return false;
     }
+    CallScope call(this, peer, MetricOp::RpcDel);
     
     // 构建gRPC请求
     cache::DeleteRequest request;
@@ -95,12 +164,62 @@ bool GrpcClient::del(const Node& node, const std::string& key) {
     grpc::ClientContext context;
     
     // 发送gRPC请求
-    grpc::Status status = stub->Delete(&context, request, &response);
+    grpc::Status status = peer->stub->Delete(&context, request, &response);
+    call.finish(status, request.ByteSizeLong(), response.ByteSizeLong());
     
     // 检查响应状态和结果
     return status.ok() && response.success();
 }
 
+/**
+ * 从远程节点批量获取缓存值
+ * 通过一次gRPC调用获取属于同一节点的多个键，避免逐键转发的往返开销
+ * @param node 目标节点信息
+ * @param keys 属于该节点的缓存键列表
+ * @param results 输出参数，按键的顺序追加查询结果
+ * @return RPC是否成功
+ */
+bool GrpcClient::mget(const Node& node, const std::vector<std::string>& keys, std::vector<KeyValueResult>& results) {
+    // 获取或创建到目标节点的gRPC连接
+    Peer* peer = getPeer(node);
+    CallScope call(this, peer, MetricOp::RpcMGet);
+    
+    // 构建gRPC请求
+    cache::MGetRequest request;
+    for (const auto& key : keys) {
+        request.add_keys(key);
+    }
+    
+    cache::MGetResponse response;
+    grpc::ClientContext context;
+    
+    // 发送gRPC请求
+    grpc::Status status = peer ? peer->stub->MGet(&context, request, &response)
+                               : grpc::Status(grpc::StatusCode::UNAVAILABLE, "");
+    call.finish(status, request.ByteSizeLong(), response.ByteSizeLong());
+    
+    // RPC失败时所有键都标记为错误
+    if (!status.ok()) {
+        for (const auto& key : keys) {
+            KeyValueResult result;
+            result.key = key;
+            result.error = true;
+            results.push_back(result);
+        }
+        return false;
+    }
+    
+    for (const auto& entry : response.entries()) {
+        KeyValueResult result;
+        result.key = entry.key();
+        result.found = entry.found();
+        result.value = entry.value();
+        results.push_back(result);
+    }
+    
+    return true;
+}
+
 /**
  * 检查远程节点健康状态
  * 通过gRPC调用远程节点的Health服务检查节点是否正常运行
@@ -109,10 +228,11 @@ bool GrpcClient::del(const Node& node, const std::string& key) {
  */
 bool GrpcClient::health(const Node& node) {
     // 获取或创建到目标节点的gRPC连接
-    auto stub = getStub(node);
-    if (!stub) {
+    Peer* peer = getPeer(node);
+    if (!peer) {
         return false;
     }
+    CallScope call(this, peer, MetricOp::RpcHealth);
     
     // 构建gRPC请求
     cache::HealthRequest request;
@@ -120,19 +240,952 @@ bool GrpcClient::health(const Node& node) {
     grpc::ClientContext context;
     
     // 发送gRPC请求
-    grpc::Status status = stub->Health(&context, request, &response);
+    grpc::Status status = peer->stub->Health(&context, request, &response);
+    call.finish(status, request.ByteSizeLong(), response.ByteSizeLong());
     
     // 检查响应状态和健康状态
     return status.ok() && response.healthy();
 }
 
 /**
- * 获取或创建到指定节点的gRPC连接存根
- * 使用连接池管理gRPC连接，避免重复创建连接
+ * 获取远程节点的热点键
+ * 通过gRPC调用远程节点的HotKeys服务
+ * @param node 目标节点信息
+ * @param limit 最多返回的键数量
+ * @param hot_keys 输出参数，按估算访问次数从高到低排列的热点键
+ * @return 是否成功获取
+ */
+bool GrpcClient::hotKeys(const Node& node, size_t limit, std::vector<HotKey>& hot_keys) {
+    // 获取或创建到目标节点的gRPC连接
+    Peer* peer = getPeer(node);
+    if (!peer) {
+        return false;
+    }
+    CallScope call(this, peer, MetricOp::RpcHotKeys);
+    
+    // 构建gRPC请求
+    cache::HotKeysRequest request;
+    request.set_limit(static_cast<uint32_t>(limit));
+    
+    cache::HotKeysResponse response;
+    grpc::ClientContext context;
+    
+    // 发送gRPC请求
+    grpc::Status status = peer->stub->HotKeys(&context, request, &response);
+    call.finish(status, request.ByteSizeLong(), response.ByteSizeLong());
+    
+    if (!status.ok()) {
+        return false;
+    }
+    
+    for (const auto& entry : response.keys()) {
+        HotKey hot_key;
+        hot_key.key = entry.key();
+        hot_key.count = entry.count();
+        hot_key.error = entry.error();
+        hot_keys.push_back(hot_key);
+    }
+    return true;
+}
+
+/**
+ * 在远程节点上执行租约获取
+ * @param node 目标节点信息
+ * @param key 缓存键
+ * @param result 输出参数，存储租约获取结果
+ * @return 调用是否成功
+ */
+bool GrpcClient::leaseGet(const Node& node, const std::string& key, LeaseResult& result) {
+    // 获取或创建到目标节点的gRPC连接
+    Peer* peer = getPeer(node);
+    if (!peer) {
+        return false;
+    }
+    CallScope call(this, peer, MetricOp::RpcLeaseGet);
+    
+    // 构建gRPC请求
+    cache::LeaseGetRequest request;
+    request.set_key(key);
+    
+    cache::LeaseGetResponse response;
+    grpc::ClientContext context;
+    
+    // 发送gRPC请求
+    grpc::Status status = peer->stub->LeaseGet(&context, request, &response);
+    call.finish(status, request.ByteSizeLong(), response.ByteSizeLong());
+    
+    if (!status.ok()) {
+        return false;
+    }
+    result.found = response.found();
+    result.value = response.value();
+    result.token = response.lease_token();
+    result.wait = response.wait();
+    result.stale = response.stale();
+    return true;
+}
+
+/**
+ * 在远程节点上执行租约写入
+ * @param node 目标节点信息
+ * @param key 缓存键
+ * @param value 缓存值
+ * @param token LeaseGet发放的租约
+ * @return 租约有效并已写入时返回true
+ */
+bool GrpcClient::leaseSet(const Node& node, const std::string& key, const std::string& value, uint64_t token) {
+    // 获取或创建到目标节点的gRPC连接
+    Peer* peer = getPeer(node);
+    if (!peer) {
+        return false;
+    }
+    CallScope call(this, peer, MetricOp::RpcLeaseSet);
+    
+    // 构建gRPC请求
+    cache::LeaseSetRequest request;
+    request.set_key(key);
+    request.set_value(value);
+    request.set_lease_token(token);
+    
+    cache::LeaseSetResponse response;
+    grpc::ClientContext context;
+    
+    // 发送gRPC请求
+    grpc::Status status = peer->stub->LeaseSet(&context, request, &response);
+    call.finish(status, request.ByteSizeLong(), response.ByteSizeLong());
+    
+    return status.ok() && response.success();
+}
+
+/**
+ * 在远程节点上执行原子自增
+ * @param node 目标节点信息
+ * @param key 缓存键
+ * @param delta 增量
+ * @param result 输出参数，自增后的值
+ * @return 操作结果，调用失败时返回Unavailable
+ */
+OpStatus GrpcClient::incr(const Node& node, const std::string& key, int64_t delta, int64_t& result) {
+    // 获取或创建到目标节点的gRPC连接
+    Peer* peer = getPeer(node);
+    if (!peer) {
+        return OpStatus::Unavailable;
+    }
+    CallScope call(this, peer, MetricOp::RpcIncr);
+    
+    // 构建gRPC请求
+    cache::IncrRequest request;
+    request.set_key(key);
+    request.set_delta(delta);
+    
+    cache::IncrResponse response;
+    grpc::ClientContext context;
+    
+    // 发送gRPC请求
+    grpc::Status status = peer->stub->Incr(&context, request, &response);
+    call.finish(status, request.ByteSizeLong(), response.ByteSizeLong());
+    
+    if (!status.ok()) {
+        return OpStatus::Unavailable;
+    }
+    result = response.value();
+    return fromStatusCode(response.status());
+}
+
+/**
+ * 在远程节点上执行比较并交换
+ * @param node 目标节点信息
+ * @param key 缓存键
+ * @param value 要写入的值
+ * @param expected_version 期望的版本
+ * @param version 输出参数，成功时为新版本，冲突时为当前版本
+ * @return 操作结果，调用失败时返回Unavailable
+ */
+OpStatus GrpcClient::compareAndSwap(const Node& node, const std::string& key, const std::string& value,
+                                    uint64_t expected_version, uint64_t& version) {
+    // 获取或创建到目标节点的gRPC连接
+    Peer* peer = getPeer(node);
+    if (!peer) {
+        return OpStatus::Unavailable;
+    }
+    CallScope call(this, peer, MetricOp::RpcCompareAndSwap);
+    
+    // 构建gRPC请求
+    cache::CompareAndSwapRequest request;
+    request.set_key(key);
+    request.set_value(value);
+    request.set_version(expected_version);
+    
+    cache::CompareAndSwapResponse response;
+    grpc::ClientContext context;
+    
+    // 发送gRPC请求
+    grpc::Status status = peer->stub->CompareAndSwap(&context, request, &response);
+    call.finish(status, request.ByteSizeLong(), response.ByteSizeLong());
+    
+    if (!status.ok()) {
+        return OpStatus::Unavailable;
+    }
+    version = response.version();
+    return fromStatusCode(response.status());
+}
+
+/**
+ * 在远程节点上执行追加
+ * @param node 目标节点信息
+ * @param key 缓存键
+ * @param data 追加的数据
+ * @param length 输出参数，追加后的值长度
+ * @return 操作结果，调用失败时返回Unavailable
+ */
+OpStatus GrpcClient::append(const Node& node, const std::string& key, const std::string& data, size_t& length) {
+    // 获取或创建到目标节点的gRPC连接
+    Peer* peer = getPeer(node);
+    if (!peer) {
+        return OpStatus::Unavailable;
+    }
+    CallScope call(this, peer, MetricOp::RpcAppend);
+    
+    // 构建gRPC请求
+    cache::AppendRequest request;
+    request.set_key(key);
+    request.set_data(data);
+    
+    cache::AppendResponse response;
+    grpc::ClientContext context;
+    
+    // 发送gRPC请求
+    grpc::Status status = peer->stub->Append(&context, request, &response);
+    call.finish(status, request.ByteSizeLong(), response.ByteSizeLong());
+    
+    if (!status.ok()) {
+        return OpStatus::Unavailable;
+    }
+    length = response.length();
+    return fromStatusCode(response.status());
+}
+
+/**
+ * 从远程节点读取值的一段
+ * @param node 目标节点信息
+ * @param key 缓存键
+ * @param start 起始位置（包含）
+ * @param end 结束位置（包含）
+ * @param value 输出参数，读取到的片段
+ * @param length 输出参数，完整值的长度
+ * @return 键存在时返回true
+ */
+bool GrpcClient::getRange(const Node& node, const std::string& key, int64_t start, int64_t end,
+                          std::string& value, size_t& length) {
+    // 获取或创建到目标节点的gRPC连接
+    Peer* peer = getPeer(node);
+    if (!peer) {
+        return false;
+    }
+    CallScope call(this, peer, MetricOp::RpcGetRange);
+    
+    // 构建gRPC请求
+    cache::GetRangeRequest request;
+    request.set_key(key);
+    request.set_start(start);
+    request.set_end(end);
+    
+    cache::GetRangeResponse response;
+    grpc::ClientContext context;
+    
+    // 发送gRPC请求
+    grpc::Status status = peer->stub->GetRange(&context, request, &response);
+    call.finish(status, request.ByteSizeLong(), response.ByteSizeLong());
+    
+    if (status.ok() && response.found()) {
+        value = std::move(*response.mutable_value());
+        length = response.length();
+        return true;
+    }
+    return false;
+}
+
+/**
+ * 在远程节点上执行范围写入
+ * @param node 目标节点信息
+ * @param key 缓存键
+ * @param offset 写入位置
+ * @param data 写入的数据
+ * @param length 输出参数，写入后的值长度
+ * @return 操作结果，调用失败时返回Unavailable
+ */
+OpStatus GrpcClient::setRange(const Node& node, const std::string& key, size_t offset, const std::string& data,
+                              size_t& length) {
+    // 获取或创建到目标节点的gRPC连接
+    Peer* peer = getPeer(node);
+    if (!peer) {
+        return OpStatus::Unavailable;
+    }
+    CallScope call(this, peer, MetricOp::RpcSetRange);
+    
+    // 构建gRPC请求
+    cache::SetRangeRequest request;
+    request.set_key(key);
+    request.set_offset(offset);
+    request.set_data(data);
+    
+    cache::SetRangeResponse response;
+    grpc::ClientContext context;
+    
+    // 发送gRPC请求
+    grpc::Status status = peer->stub->SetRange(&context, request, &response);
+    call.finish(status, request.ByteSizeLong(), response.ByteSizeLong());
+    
+    if (!status.ok()) {
+        return OpStatus::Unavailable;
+    }
+    length = response.length();
+    return fromStatusCode(response.status());
+}
+
+/**
+ * 从远程节点读取哈希字段
+ * @param node 目标节点信息
+ * @param key 缓存键
+ * @param fields 输入要读取的字段名（为空表示全部），输出读取结果
+ * @return 操作结果，调用失败时返回Unavailable
+ */
+OpStatus GrpcClient::hashGet(const Node& node, const std::string& key, std::vector<FieldValue>& fields) {
+    // 获取或创建到目标节点的gRPC连接
+    Peer* peer = getPeer(node);
+    if (!peer) {
+        return OpStatus::Unavailable;
+    }
+    CallScope call(this, peer, MetricOp::RpcHashGet);
+    
+    // 构建gRPC请求
+    cache::HashGetRequest request;
+    request.set_key(key);
+    for (const auto& field : fields) {
+        request.add_fields(field.field);
+    }
+    
+    cache::HashGetResponse response;
+    grpc::ClientContext context;
+    
+    // 发送gRPC请求
+    grpc::Status status = peer->stub->HashGet(&context, request, &response);
+    call.finish(status, request.ByteSizeLong(), response.ByteSizeLong());
+    
+    if (!status.ok()) {
+        return OpStatus::Unavailable;
+    }
+    fields.clear();
+    fields.reserve(response.fields_size());
+    for (auto& item : *response.mutable_fields()) {
+        FieldValue field;
+        field.field = std::move(*item.mutable_field());
+        field.found = item.found();
+        field.value = std::move(*item.mutable_value());
+        fields.push_back(std::move(field));
+    }
+    return fromStatusCode(response.status());
+}
+
+/**
+ * 在远程节点上写入哈希字段
+ * @param node 目标节点信息
+ * @param key 缓存键
+ * @param fields 要写入的字段
+ * @param added 输出参数，新增的字段数量
+ * @return 操作结果，调用失败时返回Unavailable
+ */
+OpStatus GrpcClient::hashSet(const Node& node, const std::string& key, const std::vector<FieldValue>& fields,
+                             size_t& added) {
+    // 获取或创建到目标节点的gRPC连接
+    Peer* peer = getPeer(node);
+    if (!peer) {
+        return OpStatus::Unavailable;
+    }
+    CallScope call(this, peer, MetricOp::RpcHashSet);
+    
+    // 构建gRPC请求
+    cache::HashSetRequest request;
+    request.set_key(key);
+    for (const auto& field : fields) {
+        cache::HashField* item = request.add_fields();
+        item->set_field(field.field);
+        item->set_value(field.value);
+    }
+    
+    cache::HashSetResponse response;
+    grpc::ClientContext context;
+    
+    // 发送gRPC请求
+    grpc::Status status = peer->stub->HashSet(&context, request, &response);
+    call.finish(status, request.ByteSizeLong(), response.ByteSizeLong());
+    
+    if (!status.ok()) {
+        return OpStatus::Unavailable;
+    }
+    added = response.added();
+    return fromStatusCode(response.status());
+}
+
+/**
+ * 在远程节点上删除哈希字段
+ * @param node 目标节点信息
+ * @param key 缓存键
+ * @param fields 要删除的字段名
+ * @param removed 输出参数，实际删除的字段数量
+ * @return 操作结果，调用失败时返回Unavailable
+ */
+OpStatus GrpcClient::hashDel(const Node& node, const std::string& key, const std::vector<std::string>& fields,
+                             size_t& removed) {
+    // 获取或创建到目标节点的gRPC连接
+    Peer* peer = getPeer(node);
+    if (!peer) {
+        return OpStatus::Unavailable;
+    }
+    CallScope call(this, peer, MetricOp::RpcHashDel);
+    
+    // 构建gRPC请求
+    cache::HashDelRequest request;
+    request.set_key(key);
+    for (const auto& field : fields) {
+        request.add_fields(field);
+    }
+    
+    cache::HashDelResponse response;
+    grpc::ClientContext context;
+    
+    // 发送gRPC请求
+    grpc::Status status = peer->stub->HashDel(&context, request, &response);
+    call.finish(status, request.ByteSizeLong(), response.ByteSizeLong());
+    
+    if (!status.ok()) {
+        return OpStatus::Unavailable;
+    }
+    removed = response.removed();
+    return fromStatusCode(response.status());
+}
+
+/**
+ * 在远程节点上原子地写入多个键
+ * @param node 目标节点信息
+ * @param entries 键值对
+ * @param ttl 过期参数
+ * @param condition 写入的前提条件
+ * @return 操作结果，调用失败时返回Unavailable
+ */
+OpStatus GrpcClient::multiSet(const Node& node, const std::vector<std::pair<std::string, std::string>>& entries,
+                              const EntryTtl& ttl, WriteCondition condition) {
+    // 获取或创建到目标节点的gRPC连接
+    Peer* peer = getPeer(node);
+    if (!peer) {
+        return OpStatus::Unavailable;
+    }
+    CallScope call(this, peer, MetricOp::RpcMultiSet);
+    
+    // 构建gRPC请求
+    cache::MultiSetRequest request;
+    for (const auto& entry : entries) {
+        cache::KeyValue* item = request.add_entries();
+        item->set_key(entry.first);
+        item->set_found(true);
+        item->set_value(entry.second);
+    }
+    request.set_ttl_ms(ttl.ttl_ms);
+    request.set_soft_ttl_ms(ttl.soft_ttl_ms);
+    request.set_recompute_ms(ttl.recompute_ms);
+    switch (condition) {
+        case WriteCondition::IfNoneExist:
+            request.set_condition(cache::WRITE_IF_NONE_EXIST);
+            break;
+        case WriteCondition::IfAllExist:
+            request.set_condition(cache::WRITE_IF_ALL_EXIST);
+            break;
+        default:
+            request.set_condition(cache::WRITE_ALWAYS);
+            break;
+    }
+    
+    cache::MultiSetResponse response;
+    grpc::ClientContext context;
+    
+    // 发送gRPC请求
+    grpc::Status status = peer->stub->MultiSet(&context, request, &response);
+    call.finish(status, request.ByteSizeLong(), response.ByteSizeLong());
+    
+    if (!status.ok()) {
+        return OpStatus::Unavailable;
+    }
+    return fromStatusCode(response.status());
+}
+
+/**
+ * 在远程节点上原子地删除多个键
+ * @param node 目标节点信息
+ * @param keys 要删除的键
+ * @param deleted 输出参数，实际删除的键数量
+ * @return 操作结果，调用失败时返回Unavailable
+ */
+OpStatus GrpcClient::multiDel(const Node& node, const std::vector<std::string>& keys, size_t& deleted) {
+    // 获取或创建到目标节点的gRPC连接
+    Peer* peer = getPeer(node);
+    if (!peer) {
+        return OpStatus::Unavailable;
+    }
+    CallScope call(this, peer, MetricOp::RpcMultiDel);
+    
+    // 构建gRPC请求
+    cache::MultiDelRequest request;
+    for (const auto& key : keys) {
+        request.add_keys(key);
+    }
+    
+    cache::MultiDelResponse response;
+    grpc::ClientContext context;
+    
+    // 发送gRPC请求
+    grpc::Status status = peer->stub->MultiDel(&context, request, &response);
+    call.finish(status, request.ByteSizeLong(), response.ByteSizeLong());
+    
+    if (!status.ok()) {
+        return OpStatus::Unavailable;
+    }
+    deleted = response.deleted();
+    return fromStatusCode(response.status());
+}
+
+/**
+ * 按游标分批遍历远程节点上的键
+ * @param node 目标节点信息
+ * @param cursor 该节点的游标
+ * @param count 本次最多检查的条目数
+ * @param match glob模式
+ * @param keys 输出参数，追加本次找到的键
+ * @param next 输出参数，该节点下一次的游标
+ * @return 操作结果，调用失败时返回Unavailable
+ */
+OpStatus GrpcClient::scan(const Node& node, const std::string& cursor, size_t count, const std::string& match,
+                          std::vector<std::string>& keys, std::string& next) {
+    // 获取或创建到目标节点的gRPC连接
+    Peer* peer = getPeer(node);
+    if (!peer) {
+        return OpStatus::Unavailable;
+    }
+    CallScope call(this, peer, MetricOp::RpcScan);
+    
+    // 构建gRPC请求
+    cache::ScanRequest request;
+    request.set_cursor(cursor);
+    request.set_count(static_cast<uint32_t>(count));
+    request.set_match(match);
+    
+    cache::ScanResponse response;
+    grpc::ClientContext context;
+    
+    // 发送gRPC请求
+    grpc::Status status = peer->stub->Scan(&context, request, &response);
+    call.finish(status, request.ByteSizeLong(), response.ByteSizeLong());
+    
+    if (!status.ok()) {
+        return OpStatus::Unavailable;
+    }
+    keys.insert(keys.end(), response.keys().begin(), response.keys().end());
+    next = response.cursor();
+    return fromStatusCode(response.status());
+}
+
+/**
+ * 在远程节点上提交按模式删除的后台任务
+ * @param node 目标节点信息
+ * @param match glob模式，为空时删除全部
+ * @return 操作结果，调用失败时返回Unavailable
+ */
+OpStatus GrpcClient::deleteMatching(const Node& node, const std::string& match) {
+    // 获取或创建到目标节点的gRPC连接
+    Peer* peer = getPeer(node);
+    if (!peer) {
+        return OpStatus::Unavailable;
+    }
+    CallScope call(this, peer, MetricOp::RpcDeleteMatching);
+    
+    // 构建gRPC请求
+    cache::DeleteMatchingRequest request;
+    request.set_match(match);
+    
+    cache::DeleteMatchingResponse response;
+    grpc::ClientContext context;
+    
+    // 发送gRPC请求
+    grpc::Status status = peer->stub->DeleteMatching(&context, request, &response);
+    call.finish(status, request.ByteSizeLong(), response.ByteSizeLong());
+    
+    if (!status.ok()) {
+        return OpStatus::Unavailable;
+    }
+    return fromStatusCode(response.status());
+}
+
+/**
+ * 在远程节点上创建、修改或删除命名空间
+ * @param node 目标节点信息
+ * @param name 命名空间名称
+ * @param quota_bytes 内存配额（字节），0表示不限制
+ * @param remove 是否删除命名空间
+ * @return 操作结果，调用失败时返回Unavailable
+ */
+OpStatus GrpcClient::configureNamespace(const Node& node, const std::string& name, uint64_t quota_bytes,
+                                        bool remove) {
+    // 获取或创建到目标节点的gRPC连接
+    Peer* peer = getPeer(node);
+    if (!peer) {
+        return OpStatus::Unavailable;
+    }
+    CallScope call(this, peer, MetricOp::RpcConfigureNamespace);
+    
+    // 构建gRPC请求
+    cache::ConfigureNamespaceRequest request;
+    request.set_name(name);
+    request.set_quota_bytes(quota_bytes);
+    request.set_remove(remove);
+    
+    cache::ConfigureNamespaceResponse response;
+    grpc::ClientContext context;
+    
+    // 发送gRPC请求
+    grpc::Status status = peer->stub->ConfigureNamespace(&context, request, &response);
+    call.finish(status, request.ByteSizeLong(), response.ByteSizeLong());
+    
+    if (!status.ok()) {
+        return OpStatus::Unavailable;
+    }
+    return fromStatusCode(response.status());
+}
+
+/**
+ * 向远程节点推送热点键副本
+ * 节点间的后台广播设置较短的超时，避免故障节点拖住推送线程
+ * @param node 目标节点信息
+ * @param source_node 推送方节点ID
+ * @param entries 热点键及其当前值
+ * @param ttl_ms 副本存活时间（毫秒）
+ * @param timeout_ms 调用超时时间（毫秒）
+ * @return 是否推送成功
+ */
+bool GrpcClient::pushReplicas(const Node& node, const std::string& source_node,
+                              const std::vector<KeyValueResult>& entries, int ttl_ms, int timeout_ms) {
+    // 获取或创建到目标节点的gRPC连接
+    Peer* peer = getPeer(node);
+    if (!peer) {
+        return false;
+    }
+    CallScope call(this, peer, MetricOp::RpcPushReplicas);
+    
+    // 构建gRPC请求
+    cache::PushReplicasRequest request;
+    request.set_source_node(source_node);
+    request.set_ttl_ms(ttl_ms);
+    for (const auto& entry : entries) {
+        cache::KeyValue* kv = request.add_entries();
+        kv->set_key(entry.key);
+        kv->set_found(true);
+        kv->set_value(entry.value);
+    }
+    
+    cache::PushReplicasResponse response;
+    grpc::ClientContext context;
+    context.set_deadline(std::chrono::system_clock::now() + std::chrono::milliseconds(timeout_ms));
+    
+    // 发送gRPC请求
+    grpc::Status status = peer->stub->PushReplicas(&context, request, &response);
+    call.finish(status, request.ByteSizeLong(), response.ByteSizeLong());
+    
+    return status.ok();
+}
+
+/**
+ * 通知远程节点删除一组键的副本
+ * @param node 目标节点信息
+ * @param source_node 发送方节点ID
+ * @param keys 已被修改的键
+ * @param timeout_ms 调用超时时间（毫秒）
+ * @return 是否通知成功
+ */
+bool GrpcClient::invalidate(const Node& node, const std::string& source_node,
+                            const std::vector<std::string>& keys, int timeout_ms) {
+    // 获取或创建到目标节点的gRPC连接
+    Peer* peer = getPeer(node);
+    if (!peer) {
+        return false;
+    }
+    CallScope call(this, peer, MetricOp::RpcInvalidate);
+    
+    // 构建gRPC请求
+    cache::InvalidateRequest request;
+    request.set_source_node(source_node);
+    for (const auto& key : keys) {
+        request.add_keys(key);
+    }
+    
+    cache::InvalidateResponse response;
+    grpc::ClientContext context;
+    context.set_deadline(std::chrono::system_clock::now() + std::chrono::milliseconds(timeout_ms));
+    
+    // 发送gRPC请求
+    grpc::Status status = peer->stub->Invalidate(&context, request, &response);
+    call.finish(status, request.ByteSizeLong(), response.ByteSizeLong());
+    
+    return status.ok();
+}
+
+/**
+ * 调用作用域构造函数
+ * 记录开始时间并增加目标节点的在途请求数
+ * @param client 所属的gRPC客户端
+ * @param peer 目标节点，可以为空
+ * @param op 调用类型
+ */
+GrpcClient::CallScope::CallScope(GrpcClient* client, Peer* peer, MetricOp op)
+    : client_(client), peer_(peer), op_(op), finished_(false),
+      start_(std::chrono::steady_clock::now()) {
+    if (peer_) {
+        peer_->stats.inflight.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * 调用作用域析构函数
+ * 调用未正常完成（例如提前返回）时也要归还在途请求数
+ */
+GrpcClient::CallScope::~CallScope() {
+    if (!finished_ && peer_) {
+        peer_->stats.inflight.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * 记录一次gRPC调用的结果
+ * 同时写入全局操作指标和目标节点的指标：耗时、状态码、收发字节数
+ * @param status gRPC调用状态
+ * @param bytes_sent 请求消息的字节数
+ * @param bytes_received 响应消息的字节数
+ */
+void GrpcClient::CallScope::finish(const grpc::Status& status, size_t bytes_sent, size_t bytes_received) {
+    if (finished_) {
+        return;
+    }
+    finished_ = true;
+    
+    uint64_t latency_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start_).count();
+    
+    // 全局操作指标
+    if (client_->metrics_) {
+        client_->metrics_->recordLatency(op_, latency_ns);
+        if (!status.ok()) {
+            client_->metrics_->recordError(op_);
+        }
+        client_->metrics_->recordBytes(op_, bytes_received, bytes_sent);
+    }
+    
+    // 目标节点指标
+    if (peer_) {
+        PeerStats& stats = peer_->stats;
+        stats.latency[static_cast<int>(op_)].record(latency_ns);
+        int code = static_cast<int>(status.error_code());
+        if (code >= 0 && code < PeerStats::kStatusCodes) {
+            stats.status_codes[code].fetch_add(1, std::memory_order_relaxed);
+        }
+        stats.bytes_sent.fetch_add(bytes_sent, std::memory_order_relaxed);
+        stats.bytes_received.fetch_add(bytes_received, std::memory_order_relaxed);
+        stats.inflight.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * 以Prometheus文本格式输出各个目标节点的指标
+ * @return Prometheus文本
+ */
+std::string GrpcClient::renderPeerMetrics() {
+    std::vector<Peer*> peers = listPeers();
+    std::ostringstream oss;
+    
+    // 各节点各调用类型的耗时直方图
+    oss << "# HELP cache_peer_rpc_duration_seconds 发往各节点的gRPC调用耗时分布\n";
+    oss << "# TYPE cache_peer_rpc_duration_seconds histogram\n";
+    for (Peer* peer : peers) {
+        for (int op = 0; op < static_cast<int>(MetricOp::Count); ++op) {
+            HistogramSnapshot snapshot;
+            peer->stats.latency[op].mergeInto(snapshot);
+            if (snapshot.count == 0) {
+                continue;  // 只输出实际发生过的调用类型
+            }
+            appendHistogramFor(oss, peer, static_cast<MetricOp>(op), snapshot);
+        }
+    }
+    
+    // 在途请求数
+    oss << "# HELP cache_peer_inflight 发往各节点的在途gRPC请求数\n";
+    oss << "# TYPE cache_peer_inflight gauge\n";
+    for (Peer* peer : peers) {
+        oss << "cache_peer_inflight{peer=\"" << peer->node_id << "\"} "
+            << peer->stats.inflight.load(std::memory_order_relaxed) << "\n";
+    }
+    
+    // 状态码分布
+    oss << "# HELP cache_peer_rpc_status_total 发往各节点的gRPC调用状态码分布\n";
+    oss << "# TYPE cache_peer_rpc_status_total counter\n";
+    for (Peer* peer : peers) {
+        for (int code = 0; code < PeerStats::kStatusCodes; ++code) {
+            uint64_t count = peer->stats.status_codes[code].load(std::memory_order_relaxed);
+            if (count > 0) {
+                oss << "cache_peer_rpc_status_total{peer=\"" << peer->node_id << "\",code=\""
+                    << statusCodeName(code) << "\"} " << count << "\n";
+            }
+        }
+    }
+    
+    // 收发字节数
+    oss << "# HELP cache_peer_bytes_sent_total 发往各节点的请求字节数\n";
+    oss << "# TYPE cache_peer_bytes_sent_total counter\n";
+    for (Peer* peer : peers) {
+        oss << "cache_peer_bytes_sent_total{peer=\"" << peer->node_id << "\"} "
+            << peer->stats.bytes_sent.load(std::memory_order_relaxed) << "\n";
+    }
+    oss << "# HELP cache_peer_bytes_received_total 从各节点收到的响应字节数\n";
+    oss << "# TYPE cache_peer_bytes_received_total counter\n";
+    for (Peer* peer : peers) {
+        oss << "cache_peer_bytes_received_total{peer=\"" << peer->node_id << "\"} "
+            << peer->stats.bytes_received.load(std::memory_order_relaxed) << "\n";
+    }
+    
+    return oss.str();
+}
+
+/**
+ * 以JSON格式输出各个目标节点的概况
+ * 每个节点包含在途请求数、收发字节数、状态码分布以及每种调用的次数、错误数和尾延迟，
+ * 用于快速定位变慢或出错的节点
+ * @return JSON文本
+ */
+std::string GrpcClient::renderPeersJson() {
+    Json::Value root(Json::arrayValue);
+    
+    for (Peer* peer : listPeers()) {
+        Json::Value item;
+        item["node_id"] = peer->node_id;
+        item["address"] = peer->address;
+        item["inflight"] = static_cast<Json::Int64>(peer->stats.inflight.load(std::memory_order_relaxed));
+        item["bytes_sent"] = static_cast<Json::UInt64>(peer->stats.bytes_sent.load(std::memory_order_relaxed));
+        item["bytes_received"] = static_cast<Json::UInt64>(peer->stats.bytes_received.load(std::memory_order_relaxed));
+        
+        // 状态码分布
+        Json::Value codes(Json::objectValue);
+        uint64_t errors = 0;
+        for (int code = 0; code < PeerStats::kStatusCodes; ++code) {
+            uint64_t count = peer->stats.status_codes[code].load(std::memory_order_relaxed);
+            if (count > 0) {
+                codes[statusCodeName(code)] = static_cast<Json::UInt64>(count);
+                if (code != 0) {
+                    errors += count;
+                }
+            }
+        }
+        item["status_codes"] = codes;
+        item["errors"] = static_cast<Json::UInt64>(errors);
+        
+        // 每种调用的次数和延迟分位数（毫秒）
+        Json::Value ops(Json::objectValue);
+        for (int op = 0; op < static_cast<int>(MetricOp::Count); ++op) {
+            HistogramSnapshot snapshot;
+            peer->stats.latency[op].mergeInto(snapshot);
+            if (snapshot.count == 0) {
+                continue;
+            }
+            Json::Value op_item;
+            op_item["count"] = static_cast<Json::UInt64>(snapshot.count);
+            op_item["mean_ms"] = snapshot.sum / 1e6 / snapshot.count;
+            op_item["p50_ms"] = snapshot.valueAtQuantile(0.5) / 1e6;
+            op_item["p99_ms"] = snapshot.valueAtQuantile(0.99) / 1e6;
+            op_item["p999_ms"] = snapshot.valueAtQuantile(0.999) / 1e6;
+            ops[Metrics::opName(static_cast<MetricOp>(op))] = op_item;
+        }
+        item["ops"] = ops;
+        
+        root.append(item);
+    }
+    
+    Json::StreamWriterBuilder builder;
+    return Json::writeString(builder, root);
+}
+
+/**
+ * 输出某个节点某种调用的耗时直方图
+ * @param oss 输出流
+ * @param peer 目标节点
+ * @param op 调用类型
+ * @param snapshot 直方图快照
+ */
+void GrpcClient::appendHistogramFor(std::ostringstream& oss, Peer* peer, MetricOp op,
+                                    const HistogramSnapshot& snapshot) {
+    std::string labels = "peer=\"" + peer->node_id + "\"," + Metrics::labelFor(op);
+    Metrics::appendHistogram(oss, "cache_peer_rpc_duration_seconds", labels, snapshot);
+}
+
+/**
+ * 获取当前所有目标节点
+ * 节点一旦创建就不会被删除，返回的指针在客户端生命周期内有效
+ * @return 节点列表
+ */
+std::vector<GrpcClient::Peer*> GrpcClient::listPeers() {
+    std::lock_guard<std::mutex> lock(stubs_mutex_);
+    std::vector<Peer*> peers;
+    for (auto& entry : stubs_) {
+        peers.push_back(entry.second.get());
+    }
+    return peers;
+}
+
+/**
+ * 获取gRPC状态码的名称
+ * @param code 状态码
+ * @return 状态码名称
+ */
+const char* GrpcClient::statusCodeName(int code) {
+    static const char* names[PeerStats::kStatusCodes] = {
+        "OK", "CANCELLED", "UNKNOWN", "INVALID_ARGUMENT", "DEADLINE_EXCEEDED", "NOT_FOUND",
+        "ALREADY_EXISTS", "PERMISSION_DENIED", "RESOURCE_EXHAUSTED", "FAILED_PRECONDITION",
+        "ABORTED", "OUT_OF_RANGE", "UNIMPLEMENTED", "INTERNAL", "UNAVAILABLE", "DATA_LOSS",
+        "UNAUTHENTICATED"
+    };
+    return (code >= 0 && code < PeerStats::kStatusCodes) ? names[code] : "UNKNOWN";
+}
+
+/**
+ * 把协议中的操作结果转换为OpStatus
+ * @param code 协议中的操作结果
+ * @return 对应的OpStatus，未知取值按Invalid处理
+ */
+OpStatus GrpcClient::fromStatusCode(cache::OpStatusCode code) {
+    switch (code) {
+        case cache::OP_OK:
+            return OpStatus::Ok;
+        case cache::OP_NOT_FOUND:
+            return OpStatus::NotFound;
+        case cache::OP_CONFLICT:
+            return OpStatus::Conflict;
+        case cache::OP_CROSS_NODE:
+            return OpStatus::CrossNode;
+        default:
+            return OpStatus::Invalid;
+    }
+}
+
+/**
+ * 获取或创建到指定节点的连接
+ * 使用连接池管理gRPC连接，避免重复创建连接，每个连接附带该节点的调用指标
  * @param node 目标节点信息
- * @return gRPC服务存根指针，失败时返回nullptr
+ * @return 连接指针，失败时返回nullptr
  */
-cache::CacheService::Stub* GrpcClient::getStub(const Node& node) {
+GrpcClient::Peer* GrpcClient::getPeer(const Node& node) {
     // 使用互斥锁保护连接池的线程安全
     std::lock_guard<std::mutex> lock(stubs_mutex_);
     
@@ -146,13 +1199,16 @@ cache::CacheService::Stub* GrpcClient::getStub(const Node& node) {
     
     // 创建新的gRPC连接和存根
     auto channel = grpc::CreateChannel(address, grpc::InsecureChannelCredentials());
-    auto stub = cache::CacheService::NewStub(channel);
+    auto peer = std::make_unique<Peer>();
+    peer->node_id = node.id;
+    peer->address = address;
+    peer->stub = cache::CacheService::NewStub(channel);
     
-    // 保存存根指针并将其添加到连接池
-    cache::CacheService::Stub* stub_ptr = stub.get();
-    stubs_[address] = std::move(stub);
+    // 保存连接指针并将其添加到连接池
+    Peer* peer_ptr = peer.get();
+    stubs_[address] = std::move(peer);
     
-    return stub_ptr;
+    return peer_ptr;
 }
 
 /**
@@ -0,0 +1,228 @@
+#include "hash_value.h"
+#include <json/json.h>
+
+/**
+ * 创建空哈希，使用紧凑编码
+ */
+HashValue::HashValue() : compact_count_(0), table_bytes_(0) {}
+
+/**
+ * 读取字段
+ * @param field 字段名
+ * @param value 输出参数，字段值
+ * @return 字段是否存在
+ */
+bool HashValue::get(const std::string& field, std::string& value) const {
+    if (table_) {
+        auto it = table_->find(field);
+        if (it == table_->end()) {
+            return false;
+        }
+        value = it->second;
+        return true;
+    }
+
+    size_t entry_start, value_start, value_size;
+    if (!findCompact(field, entry_start, value_start, value_size)) {
+        return false;
+    }
+    value.assign(compact_, value_start, value_size);
+    return true;
+}
+
+/**
+ * 写入字段
+ * 紧凑编码中覆盖已有字段时原地替换该项，新增字段追加到末尾；超过阈值时先转换为哈希表
+ * @param field 字段名
+ * @param value 字段值
+ * @return 是否新增了字段
+ */
+bool HashValue::set(const std::string& field, const std::string& value) {
+    if (!table_ && (field.size() > kCompactMaxBytes || value.size() > kCompactMaxBytes)) {
+        convertToTable();
+    }
+    if (table_) {
+        auto it = table_->find(field);
+        if (it != table_->end()) {
+            table_bytes_ = table_bytes_ - it->second.size() + value.size();
+            it->second = value;
+            return false;
+        }
+        table_->emplace(field, value);
+        table_bytes_ += field.size() + value.size() + kTableEntryBytes;
+        return true;
+    }
+
+    size_t entry_start, value_start, value_size;
+    if (findCompact(field, entry_start, value_start, value_size)) {
+        // 字段值连同它的长度前缀一起替换
+        std::string encoded;
+        putLength(encoded, value.size());
+        encoded += value;
+        size_t length_start = entry_start;
+        getLength(compact_, length_start);
+        length_start += field.size();
+        compact_.replace(length_start, value_start + value_size - length_start, encoded);
+        return false;
+    }
+
+    if (compact_count_ + 1 > kCompactMaxEntries) {
+        convertToTable();
+        table_->emplace(field, value);
+        table_bytes_ += field.size() + value.size() + kTableEntryBytes;
+        return true;
+    }
+    putLength(compact_, field.size());
+    compact_ += field;
+    putLength(compact_, value.size());
+    compact_ += value;
+    compact_count_++;
+    return true;
+}
+
+/**
+ * 删除字段
+ * @param field 字段名
+ * @return 字段是否存在
+ */
+bool HashValue::erase(const std::string& field) {
+    if (table_) {
+        auto it = table_->find(field);
+        if (it == table_->end()) {
+            return false;
+        }
+        table_bytes_ -= it->first.size() + it->second.size() + kTableEntryBytes;
+        table_->erase(it);
+        return true;
+    }
+
+    size_t entry_start, value_start, value_size;
+    if (!findCompact(field, entry_start, value_start, value_size)) {
+        return false;
+    }
+    compact_.erase(entry_start, value_start + value_size - entry_start);
+    compact_count_--;
+    return true;
+}
+
+/**
+ * 字段数量
+ * @return 字段数量
+ */
+size_t HashValue::size() const {
+    return table_ ? table_->size() : compact_count_;
+}
+
+/**
+ * 按存储顺序遍历所有字段
+ * @param fn 回调，参数为字段名和字段值
+ */
+void HashValue::forEach(const std::function<void(const std::string&, const std::string&)>& fn) const {
+    if (table_) {
+        for (const auto& entry : *table_) {
+            fn(entry.first, entry.second);
+        }
+        return;
+    }
+
+    std::string field, value;
+    size_t pos = 0;
+    while (pos < compact_.size()) {
+        size_t field_size = getLength(compact_, pos);
+        field.assign(compact_, pos, field_size);
+        pos += field_size;
+        size_t value_size = getLength(compact_, pos);
+        value.assign(compact_, pos, value_size);
+        pos += value_size;
+        fn(field, value);
+    }
+}
+
+/**
+ * 序列化为JSON对象
+ * @return JSON文本
+ */
+std::string HashValue::toJson() const {
+    Json::Value json(Json::objectValue);
+    forEach([&json](const std::string& field, const std::string& value) {
+        json[field] = value;
+    });
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    return Json::writeString(builder, json);
+}
+
+/**
+ * 在紧凑编码中顺序查找字段
+ * @param field 字段名
+ * @param entry_start 输出参数，该项的起始偏移
+ * @param value_start 输出参数，字段值的起始偏移
+ * @param value_size 输出参数，字段值的长度
+ * @return 字段是否存在
+ */
+bool HashValue::findCompact(const std::string& field, size_t& entry_start, size_t& value_start,
+                            size_t& value_size) const {
+    size_t pos = 0;
+    while (pos < compact_.size()) {
+        entry_start = pos;
+        size_t field_size = getLength(compact_, pos);
+        bool match = field_size == field.size() && compact_.compare(pos, field_size, field) == 0;
+        pos += field_size;
+        value_size = getLength(compact_, pos);
+        value_start = pos;
+        pos += value_size;
+        if (match) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * 把紧凑编码转换为哈希表，并释放紧凑编码占用的内存
+ */
+void HashValue::convertToTable() {
+    auto table = std::make_unique<std::unordered_map<std::string, std::string>>();
+    table->reserve(compact_count_ + 1);
+    table_bytes_ = 0;
+    forEach([this, &table](const std::string& field, const std::string& value) {
+        table->emplace(field, value);
+        table_bytes_ += field.size() + value.size() + kTableEntryBytes;
+    });
+    table_ = std::move(table);
+    std::string().swap(compact_);
+    compact_count_ = 0;
+}
+
+/**
+ * 追加一个变长编码的长度：每字节低7位存数据，最高位表示后面还有字节
+ * @param out 输出缓冲区
+ * @param length 长度
+ */
+void HashValue::putLength(std::string& out, size_t length) {
+    while (length >= 0x80) {
+        out.push_back(static_cast<char>((length & 0x7f) | 0x80));
+        length >>= 7;
+    }
+    out.push_back(static_cast<char>(length));
+}
+
+/**
+ * 读取一个变长编码的长度
+ * @param data 缓冲区
+ * @param pos 输入输出参数，读取位置
+ * @return 长度
+ */
+size_t HashValue::getLength(const std::string& data, size_t& pos) {
+    size_t length = 0;
+    int shift = 0;
+    while (pos < data.size()) {
+        unsigned char byte = static_cast<unsigned char>(data[pos++]);
+        length |= static_cast<size_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            break;
+        }
+        shift += 7;
+    }
+    return length;
+}
\ No newline at end of file
@@ -0,0 +1,163 @@
+#include "hot_keys.h"
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+/**
+ * 热点键追踪器构造函数
+ * @param capacity 计数槽数量
+ * @param sample_rate 采样率，向上取整到2的幂
+ * @param decay_interval 计数减半的时间间隔
+ */
+HotKeyTracker::HotKeyTracker(size_t capacity, uint32_t sample_rate, std::chrono::seconds decay_interval)
+    : capacity_(capacity > 0 ? capacity : 1),
+      decay_interval_(decay_interval),
+      last_decay_(std::chrono::steady_clock::now()) {
+    // 采样率向上取整到2的幂，抽样判断只需要一次按位与
+    uint32_t rate = 1;
+    while (rate < sample_rate) {
+        rate <<= 1;
+    }
+    sample_mask_ = rate - 1;
+    heap_.reserve(capacity_);
+}
+
+/**
+ * 记录一次键访问
+ * 先用线程本地的xorshift随机数决定是否抽中，抽中的访问才加锁更新计数：
+ * 已在统计中的键计数加一；否则占用空槽，或替换计数最小的槽并继承其计数作为误差
+ * @param key 被访问的键
+ */
+void HotKeyTracker::record(const std::string& key) {
+    thread_local uint32_t rng = (0x9E3779B9u ^ static_cast<uint32_t>(
+        std::hash<std::thread::id>()(std::this_thread::get_id()))) | 1;  // xorshift的状态不能为0
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    if ((rng & sample_mask_) != 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    maybeDecay();
+
+    auto it = positions_.find(key);
+    if (it != positions_.end()) {
+        // 已统计的键：计数加一后向堆底调整
+        heap_[it->second].count++;
+        siftDown(it->second);
+        return;
+    }
+
+    if (heap_.size() < capacity_) {
+        // 还有空槽：直接加入
+        heap_.push_back({key, 1, 0});
+        positions_[key] = heap_.size() - 1;
+        siftUp(heap_.size() - 1);
+        return;
+    }
+
+    // 替换计数最小的槽（堆顶）
+    Slot& min_slot = heap_[0];
+    positions_.erase(min_slot.key);
+    min_slot.error = min_slot.count;
+    min_slot.count++;
+    min_slot.key = key;
+    positions_[key] = 0;
+    siftDown(0);
+}
+
+/**
+ * 获取访问最频繁的键
+ * 计数和误差按采样率放大为访问次数的估算值
+ * @param limit 最多返回的键数量
+ * @return 按估算访问次数从高到低排列的热点键
+ */
+std::vector<HotKey> HotKeyTracker::topK(size_t limit) const {
+    std::vector<HotKey> result;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        result.reserve(heap_.size());
+        for (const auto& slot : heap_) {
+            HotKey hot_key;
+            hot_key.key = slot.key;
+            hot_key.count = slot.count * (sample_mask_ + 1);
+            hot_key.error = slot.error * (sample_mask_ + 1);
+            result.push_back(hot_key);
+        }
+    }
+
+    std::sort(result.begin(), result.end(), [](const HotKey& a, const HotKey& b) {
+        return a.count > b.count;
+    });
+    if (result.size() > limit) {
+        result.resize(limit);
+    }
+    return result;
+}
+
+/**
+ * 把位置pos的槽向堆底移动
+ * @param pos 槽在堆中的位置
+ */
+void HotKeyTracker::siftDown(size_t pos) {
+    while (true) {
+        size_t smallest = pos;
+        size_t left = pos * 2 + 1;
+        size_t right = left + 1;
+        if (left < heap_.size() && heap_[left].count < heap_[smallest].count) {
+            smallest = left;
+        }
+        if (right < heap_.size() && heap_[right].count < heap_[smallest].count) {
+            smallest = right;
+        }
+        if (smallest == pos) {
+            return;
+        }
+        swapSlots(pos, smallest);
+        pos = smallest;
+    }
+}
+
+/**
+ * 把位置pos的槽向堆顶移动
+ * @param pos 槽在堆中的位置
+ */
+void HotKeyTracker::siftUp(size_t pos) {
+    while (pos > 0) {
+        size_t parent = (pos - 1) / 2;
+        if (heap_[parent].count <= heap_[pos].count) {
+            return;
+        }
+        swapSlots(pos, parent);
+        pos = parent;
+    }
+}
+
+/**
+ * 交换两个槽并更新位置映射
+ * @param a 第一个槽的位置
+ * @param b 第二个槽的位置
+ */
+void HotKeyTracker::swapSlots(size_t a, size_t b) {
+    std::swap(heap_[a], heap_[b]);
+    positions_[heap_[a].key] = a;
+    positions_[heap_[b].key] = b;
+}
+
+/**
+ * 时间到达时把所有计数减半
+ * 调用方必须持有mutex_
+ */
+void HotKeyTracker::maybeDecay() {
+    auto now = std::chrono::steady_clock::now();
+    if (now - last_decay_ < decay_interval_) {
+        return;
+    }
+    last_decay_ = now;
+
+    for (auto& slot : heap_) {
+        slot.count /= 2;
+        slot.error /= 2;
+    }
+}
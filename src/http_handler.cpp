@@ -1,11 +1,16 @@
 #include "http_handler.h"
 #include "cache_server.h"
 #include <sys/socket.h>
+#include <sys/time.h>
 #include <netinet/in.h>
 #include <unistd.h>
 #include <iostream>
 #include <sstream>
 #include <regex>
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <limits>
 #include <json/json.h>
 
 /**
@@ -13,9 +18,22 @@
  * 初始化HTTP服务器，设置缓存服务器引用和监听端口
  * @param server 缓存服务器实例指针
  * @param port HTTP服务监听端口
+ * @param limits 准入控制配置
  */
-HttpHandler::HttpHandler(CacheServer* server, int port) 
-    : server_(server), port_(port), running_(false), server_fd_(-1) {}
+HttpHandler::HttpHandler(CacheServer* server, int port, const HttpLimits& limits) 
+    : server_(server), port_(port), running_(false), server_fd_(-1),
+      limits_(limits), active_connections_(0), shed_requests_(0) {
+    if (limits_.address_rate > 0) {
+        address_limiter_ = std::make_unique<RateLimiter>(limits_.address_rate, limits_.address_burst, kRateLimitKeys);
+    }
+    if (limits_.api_key_rate > 0) {
+        api_key_limiter_ = std::make_unique<RateLimiter>(limits_.api_key_rate, limits_.api_key_burst, kRateLimitKeys);
+    }
+    if (limits_.namespace_rate > 0) {
+        namespace_limiter_ = std::make_unique<RateLimiter>(limits_.namespace_rate, limits_.namespace_burst,
+                                                           kRateLimitKeys);
+    }
+}
 
 /**
  * HTTP处理器析构函数
@@ -27,31 +45,52 @@ HttpHandler::~HttpHandler() {
 
 /**
  * 启动HTTP服务器
- * 设置运行标志并在新线程中启动服务器循环
+ * 设置运行标志，启动固定数量（至少一个）的工作线程，并在新线程中启动服务器循环
  */
 void HttpHandler::start() {
     running_ = true;
+    for (int i = 0; i < std::max(limits_.worker_threads, 1); ++i) {
+        workers_.emplace_back(&HttpHandler::workerLoop, this);
+    }
     server_thread_ = std::thread(&HttpHandler::serverLoop, this);
 }
 
 /**
  * 停止HTTP服务器
- * 设置停止标志，关闭套接字，等待服务器线程结束
+ * 设置停止标志，关闭套接字，唤醒并等待所有工作线程结束，关闭仍在排队的连接
  */
 void HttpHandler::stop() {
     running_ = false;
     if (server_fd_ >= 0) {
+        shutdown(server_fd_, SHUT_RDWR);  // 唤醒阻塞在accept上的服务器线程
         close(server_fd_);
         server_fd_ = -1;
     }
     if (server_thread_.joinable()) {
         server_thread_.join();
     }
+    
+    // 唤醒所有工作线程并等待退出
+    queue_cv_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers_.clear();
+    
+    // 关闭仍在队列中等待的连接
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    for (const auto& pending : queue_) {
+        closeConnection(pending.fd);
+    }
+    queue_.clear();
 }
 
 /**
  * HTTP服务器主循环
- * 创建套接字，绑定端口，监听连接，为每个客户端请求创建处理线程
+ * 创建套接字，绑定端口，监听连接，将接受的连接放入有界队列交给工作线程处理
+ * 连接数或队列长度超限时直接在接受线程上返回503，超出地址速率时返回429，不占用工作线程
  */
 void HttpHandler::serverLoop() {
     // 创建TCP套接字
@@ -78,8 +117,9 @@ void HttpHandler::serverLoop() {
         return;
     }
     
-    // 开始监听连接，设置最大等待队列长度为10
-    if (listen(server_fd_, 10) < 0) {
+    // 开始监听连接，内核等待队列只需容纳服务器线程两次accept之间到达的连接，
+    // 排队和过载拒绝由应用层的有界队列负责
+    if (listen(server_fd_, 128) < 0) {
         std::cerr << "监听套接字失败" << std::endl;
         close(server_fd_);
         return;
@@ -101,9 +141,179 @@ void HttpHandler::serverLoop() {
             continue;
         }
         
-        // 为每个客户端请求创建独立的处理线程
-        std::thread(&HttpHandler::handleRequest, this, client_fd).detach();
+        // 设置读写超时，防止慢客户端长期占用工作线程
+        struct timeval timeout;
+        timeout.tv_sec = limits_.io_timeout_ms / 1000;
+        timeout.tv_usec = (limits_.io_timeout_ms % 1000) * 1000;
+        setsockopt(client_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(client_fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        
+        // 连接数超限：直接拒绝
+        if (active_connections_.fetch_add(1) >= limits_.max_connections) {
+            shedRequest(client_fd);
+            continue;
+        }
+        
+        // 超出客户端地址的速率：还没有读取请求，直接拒绝
+        std::chrono::nanoseconds retry_after;
+        if (address_limiter_ &&
+            !address_limiter_->allow(std::string(reinterpret_cast<const char*>(&client_addr.sin_addr),
+                                                 sizeof(client_addr.sin_addr)), retry_after)) {
+            throttleRequest(client_fd, retry_after);
+            continue;
+        }
+        
+        // 放入有界队列，队列已满时直接拒绝
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            if (static_cast<int>(queue_.size()) < limits_.max_queue) {
+                queue_.push_back({client_fd, std::chrono::steady_clock::now()});
+                client_fd = -1;
+            }
+        }
+        if (client_fd >= 0) {
+            shedRequest(client_fd);
+            continue;
+        }
+        queue_cv_.notify_one();
+    }
+}
+
+/**
+ * 工作线程主循环
+ * 从队列中取出连接，排队时间超过截止时间的请求直接返回503，
+ * 因为客户端很可能已经放弃，处理它只会进一步拖慢后面的请求
+ */
+void HttpHandler::workerLoop() {
+    const auto queue_timeout = std::chrono::milliseconds(limits_.queue_timeout_ms);
+    
+    while (true) {
+        PendingConnection pending;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            queue_cv_.wait(lock, [this] { return !running_ || !queue_.empty(); });
+            if (!running_) {
+                return;
+            }
+            pending = queue_.front();
+            queue_.pop_front();
+        }
+        
+        // 截止时间检查：排队过久的请求快速拒绝
+        if (std::chrono::steady_clock::now() - pending.accepted_at > queue_timeout) {
+            shedRequest(pending.fd);
+            continue;
+        }
+        
+        handleRequest(pending.fd);
+    }
+}
+
+/**
+ * 拒绝过载时的请求
+ * 返回503和Retry-After响应头，提示客户端稍后重试，然后关闭连接
+ * @param client_fd 客户端套接字文件描述符
+ */
+void HttpHandler::shedRequest(int client_fd) {
+    shed_requests_++;
+    
+    Json::Value error_response;
+    error_response["detail"] = "服务繁忙，请稍后重试";
+    Json::StreamWriterBuilder builder;
+    std::string json_str = Json::writeString(builder, error_response);
+    std::string retry_after = "Retry-After: " + std::to_string(limits_.retry_after_sec) + "\r\n";
+    std::string response = createHttpResponse(503, "application/json", json_str, retry_after);
+    
+    // 先读走已到达的请求数据，避免关闭时内核发送RST导致客户端收不到503
+    char drain[4096];
+    recv(client_fd, drain, sizeof(drain), MSG_DONTWAIT);
+    send(client_fd, response.c_str(), response.length(), MSG_NOSIGNAL | MSG_DONTWAIT);
+    closeConnection(client_fd);
+}
+
+/**
+ * 拒绝超出速率的请求
+ * 返回429和按令牌恢复时间计算的Retry-After（向上取整到秒），然后关闭连接
+ * @param client_fd 客户端套接字文件描述符
+ * @param retry_after 令牌恢复所需的等待时间
+ */
+void HttpHandler::throttleRequest(int client_fd, std::chrono::nanoseconds retry_after) {
+    auto seconds = std::chrono::duration_cast<std::chrono::seconds>(retry_after + std::chrono::seconds(1) -
+                                                                    std::chrono::nanoseconds(1));
+    std::string retry_header = "Retry-After: " + std::to_string(std::max<int64_t>(seconds.count(), 1)) + "\r\n";
+    std::string response = createHttpResponse(429, "application/json", "{\"detail\":\"请求过于频繁\"}", retry_header);
+    
+    // 与shedRequest相同，先读走已到达的数据再发送，不等待慢客户端
+    char drain[4096];
+    recv(client_fd, drain, sizeof(drain), MSG_DONTWAIT);
+    send(client_fd, response.c_str(), response.length(), MSG_NOSIGNAL | MSG_DONTWAIT);
+    closeConnection(client_fd);
+}
+
+/**
+ * 按API密钥和命名空间检查请求速率
+ * API密钥取自X-Api-Key请求头；命名空间取自X-Namespace请求头，没有时取路径中键的第一个冒号之前的部分
+ * （/ns:key或/_hash/ns:key等），请求体中的键不参与限流
+ * @param request 已读取的请求数据
+ * @param header_end 请求头结束标记的位置
+ * @param retry_after 输出参数，拒绝时为令牌恢复所需的等待时间
+ * @return 放行时返回true
+ */
+bool HttpHandler::admitRequest(const std::string& request, size_t header_end,
+                               std::chrono::nanoseconds& retry_after) {
+    std::string api_key, ns;
+    size_t line_end = request.find("\r\n");
+    
+    // 逐行查找请求头，名称不区分大小写
+    size_t pos = line_end;
+    while (pos < header_end) {
+        size_t start = pos + 2;
+        pos = request.find("\r\n", start);
+        size_t colon = request.find(':', start);
+        if (colon >= pos) {
+            continue;
+        }
+        auto named = [&](const char* name, size_t length) {
+            return colon - start == length && std::equal(request.begin() + start, request.begin() + colon, name,
+                [](char a, char b) { return std::tolower(static_cast<unsigned char>(a)) == b; });
+        };
+        bool is_api_key = api_key_limiter_ && named("x-api-key", 9);
+        bool is_namespace = namespace_limiter_ && named("x-namespace", 11);
+        if (is_api_key || is_namespace) {
+            size_t value = request.find_first_not_of(' ', colon + 1);
+            (is_api_key ? api_key : ns) = request.substr(value, pos - std::min(value, pos));
+        }
+    }
+    
+    if (namespace_limiter_ && ns.empty()) {
+        // 请求行：方法 路径 协议版本
+        size_t path_start = request.find(' ');
+        size_t path_end = path_start < line_end ? request.find_first_of(" ?", path_start + 1) : std::string::npos;
+        if (path_end <= line_end && request.compare(path_start + 1, 1, "/") == 0) {
+            size_t key_start = path_start + 2;
+            if (request.compare(key_start, 1, "_") == 0) {
+                key_start = request.find('/', key_start);  // /_hash/ns:key等带键的路径
+                key_start = key_start < path_end ? key_start + 1 : path_end;
+            }
+            std::string key = urlDecode(request.substr(key_start, path_end - key_start));
+            size_t colon = key.find(':');
+            if (colon != std::string::npos && colon > 0) {
+                ns = key.substr(0, colon);
+            }
+        }
     }
+    
+    return (api_key.empty() || api_key_limiter_->allow(api_key, retry_after)) &&
+           (ns.empty() || namespace_limiter_->allow(ns, retry_after));
+}
+
+/**
+ * 关闭客户端连接并释放连接配额
+ * @param client_fd 客户端套接字文件描述符
+ */
+void HttpHandler::closeConnection(int client_fd) {
+    close(client_fd);
+    active_connections_--;
 }
 
 /**
@@ -112,25 +322,46 @@ void HttpHandler::serverLoop() {
  * @param client_fd 客户端套接字文件描述符
  */
 void HttpHandler::handleRequest(int client_fd) {
-    // 读取客户端请求数据
-    char buffer[4096];
-    ssize_t bytes_read = recv(client_fd, buffer, sizeof(buffer) - 1, 0);
+    // 读取完整的客户端请求
+    std::string request;
+    std::chrono::nanoseconds retry_after;
+    int read_status = readRequest(client_fd, request, retry_after);
     
-    if (bytes_read <= 0) {
-        close(client_fd);
+    if (read_status == 0) {
+        closeConnection(client_fd);
+        return;
+    }
+    if (read_status == 429) {
+        throttleRequest(client_fd, retry_after);
+        return;
+    }
+    if (read_status == 413) {
+        Json::Value error_response;
+        error_response["detail"] = "请求体过大";
+        sendAll(client_fd, createJsonResponse(413, error_response));
+        closeConnection(client_fd);
         return;
     }
     
-    // 确保字符串以null结尾
-    buffer[bytes_read] = '\0';
-    std::string request(buffer);
-    
-    // 解析HTTP请求，提取方法、路径和请求体
+    // 解析HTTP请求，提取方法、路径、请求头和请求体
     std::string method, path, body;
-    parseHttpRequest(request, method, path, body);
+    std::unordered_map<std::string, std::string> headers;
+    parseHttpRequest(request, method, path, body, headers);
+    
+    // 分离查询参数
+    std::unordered_map<std::string, std::string> query;
+    size_t query_start = path.find('?');
+    if (query_start != std::string::npos) {
+        query = parseQuery(path.substr(query_start + 1));
+        path = path.substr(0, query_start);
+    }
     
     std::string response;
     
+    // Range请求头解析出的字节范围
+    int64_t range_start = 0;
+    int64_t range_end = -1;
+    
     try {
         if (path == "/health") {
             // 健康检查端点：返回节点状态信息
@@ -142,12 +373,495 @@ void HttpHandler::handleRequest(int client_fd) {
             std::string json_str = Json::writeString(builder, json_response);
             response = createHttpResponse(200, "application/json", json_str);
         }
+        else if (method == "GET" && path == "/metrics") {
+            // 指标端点：Prometheus文本格式
+            std::ostringstream http_metrics;
+            http_metrics << "# HELP http_active_connections 当前打开的HTTP连接数\n";
+            http_metrics << "# TYPE http_active_connections gauge\n";
+            http_metrics << "http_active_connections " << active_connections_.load() << "\n";
+            http_metrics << "# HELP http_shed_requests_total 因过载被拒绝的HTTP请求数\n";
+            http_metrics << "# TYPE http_shed_requests_total counter\n";
+            http_metrics << "http_shed_requests_total " << shed_requests_.load() << "\n";
+            http_metrics << "# HELP http_throttled_requests_total 因超出速率被拒绝的HTTP请求数\n";
+            http_metrics << "# TYPE http_throttled_requests_total counter\n";
+            const std::pair<const char*, const RateLimiter*> limiters[] = {
+                {"address", address_limiter_.get()},
+                {"api_key", api_key_limiter_.get()},
+                {"namespace", namespace_limiter_.get()},
+            };
+            for (const auto& limiter : limiters) {
+                http_metrics << "http_throttled_requests_total{scope=\"" << limiter.first << "\"} "
+                             << (limiter.second ? limiter.second->rejected() : 0) << "\n";
+            }
+            response = createHttpResponse(200, "text/plain; version=0.0.4",
+                                          server_->renderMetrics() + http_metrics.str());
+        }
+        else if (method == "GET" && path == "/peers") {
+            // 对端节点概况：各节点的延迟、在途数、状态码和收发字节数
+            response = createHttpResponse(200, "application/json", server_->renderPeers());
+        }
+        else if (method == "GET" && path == "/_hotkeys") {
+            // 热点键：默认返回本节点，scope=cluster时返回每个节点各自的热点键
+            uint64_t limit = 20;
+            if (query.count("limit") && !parseUint64(query["limit"], limit)) {
+                Json::Value error_response;
+                error_response["detail"] = "limit应为非负整数";
+                response = createJsonResponse(400, error_response);
+            } else {
+                auto to_json = [](const std::vector<HotKey>& hot_keys) {
+                    Json::Value list(Json::arrayValue);
+                    for (const auto& hot_key : hot_keys) {
+                        Json::Value item;
+                        item["key"] = hot_key.key;
+                        item["count"] = static_cast<Json::UInt64>(hot_key.count);
+                        item["error"] = static_cast<Json::UInt64>(hot_key.error);
+                        list.append(item);
+                    }
+                    return list;
+                };
+            
+                Json::Value json_response;
+                if (query["scope"] == "cluster") {
+                    for (const auto& node_keys : server_->getClusterHotKeys(limit)) {
+                        json_response[node_keys.first] = to_json(node_keys.second);
+                    }
+                } else {
+                    json_response[server_->getNodeId()] = to_json(server_->getHotKeys(limit));
+                }
+                response = createJsonResponse(200, json_response);
+            }
+        }
+        else if (method == "GET" && path == "/_scan") {
+            // 按游标遍历键：cursor从"0"开始，返回的cursor为"0"时遍历结束；count为每次检查的条目数（默认100），
+            // match为glob模式，prefix为前缀（两者二选一，同时给出时使用match）；local=1时只遍历本节点
+            std::string cursor = query.count("cursor") ? query["cursor"] : "0";
+            uint64_t count = 100;
+            bool valid_count = !query.count("count") || parseUint64(query["count"], count);
+            std::string match = query.count("match") ? query["match"] : "";
+            if (match.empty() && query.count("prefix") && !query["prefix"].empty()) {
+                match = prefixPattern(query["prefix"]);
+            }
+            
+            std::vector<std::string> keys;
+            std::string next;
+            OpStatus status = OpStatus::Invalid;
+            if (!valid_count) {
+                // count无效时不遍历，直接返回400
+            } else if (query["local"] == "1") {
+                status = server_->scanLocal(cursor, count, match, keys, next) ? OpStatus::Ok : OpStatus::Invalid;
+            } else {
+                status = server_->scan(cursor, count, match, keys, next);
+            }
+            
+            Json::Value json_response;
+            if (status == OpStatus::Ok) {
+                json_response["cursor"] = next;
+                json_response["keys"] = Json::Value(Json::arrayValue);
+                for (const auto& key : keys) {
+                    json_response["keys"].append(key);
+                }
+                response = createJsonResponse(200, json_response);
+            } else if (status == OpStatus::Unavailable) {
+                json_response["detail"] = "节点不可用，可以稍后用同一个游标重试";
+                response = createJsonResponse(503, json_response);
+            } else {
+                json_response["detail"] = valid_count ? "无效的游标" : "count应为非负整数";
+                response = createJsonResponse(400, json_response);
+            }
+        }
+        else if (method == "POST" && (path == "/_delete" || path == "/_flush")) {
+            // 按模式删除：/_delete?prefix=...或?match=...删除匹配的键；/_flush?namespace=ns删除"ns:"开头的键，
+            // 不带namespace时清空整个集群。各节点在后台分批删除，请求提交后立即返回202
+            std::string match;
+            bool valid = true;
+            if (path == "/_flush") {
+                if (query.count("namespace") && !query["namespace"].empty()) {
+                    match = prefixPattern(query["namespace"] + ":");
+                }
+            } else if (query.count("match") && !query["match"].empty()) {
+                match = query["match"];
+            } else if (query.count("prefix") && !query["prefix"].empty()) {
+                match = prefixPattern(query["prefix"]);
+            } else {
+                valid = false;  // 清空全部必须显式使用/_flush
+            }
+            
+            Json::Value json_response;
+            if (!valid) {
+                json_response["detail"] = "缺少prefix或match参数，清空全部请使用/_flush";
+                response = createJsonResponse(400, json_response);
+            } else {
+                std::vector<std::string> failed;
+                OpStatus status = server_->deleteMatching(match, failed);
+                json_response["match"] = match;
+                if (status == OpStatus::Ok) {
+                    response = createJsonResponse(202, json_response);
+                } else {
+                    // 其他节点上的任务已经提交，重试是安全的
+                    json_response["detail"] = "部分节点不可用，可以稍后重试";
+                    json_response["failed"] = Json::Value(Json::arrayValue);
+                    for (const auto& node_id : failed) {
+                        json_response["failed"].append(node_id);
+                    }
+                    response = createJsonResponse(503, json_response);
+                }
+            }
+        }
+        else if (method == "GET" && path == "/_namespaces") {
+            // 命名空间统计：本节点各命名空间的用量、配额、命中和淘汰
+            Json::Value json_response(Json::arrayValue);
+            for (const auto& ns : server_->namespaceStats()) {
+                Json::Value item;
+                item["name"] = ns.name;
+                item["quota_bytes"] = static_cast<Json::UInt64>(ns.quota_bytes);
+                item["bytes"] = static_cast<Json::Int64>(ns.bytes);
+                item["keys"] = static_cast<Json::Int64>(ns.keys);
+                item["hits"] = static_cast<Json::UInt64>(ns.hits);
+                item["misses"] = static_cast<Json::UInt64>(ns.misses);
+                item["evictions"] = static_cast<Json::UInt64>(ns.evictions);
+                json_response.append(item);
+            }
+            response = createJsonResponse(200, json_response);
+        }
+        else if (path.compare(0, 13, "/_namespaces/") == 0 && path.length() > 13 &&
+                 (method == "POST" || method == "DELETE")) {
+            // 命名空间配置：POST创建命名空间或修改配额，请求体为{"quota_bytes": N}（每个节点的配额，0或省略表示不限制）；
+            // DELETE删除命名空间，其中的键保留并归入默认命名空间。配置发给集群所有节点
+            std::string name = urlDecode(path.substr(13));
+            uint64_t quota_bytes = 0;
+            bool valid = true;
+            if (method == "POST" && !body.empty()) {
+                Json::Value json_data;
+                Json::Reader reader;
+                valid = reader.parse(body, json_data) && json_data.isObject() &&
+                        (!json_data.isMember("quota_bytes") || json_data["quota_bytes"].isUInt64());
+                if (valid && json_data.isMember("quota_bytes")) {
+                    quota_bytes = json_data["quota_bytes"].asUInt64();
+                }
+            }
+            
+            Json::Value json_response;
+            std::vector<std::string> failed;
+            OpStatus status = valid ? server_->configureNamespace(name, quota_bytes, method == "DELETE", failed)
+                                    : OpStatus::Invalid;
+            json_response["namespace"] = name;
+            if (status == OpStatus::Ok) {
+                response = createJsonResponse(200, json_response);
+            } else if (status == OpStatus::NotFound) {
+                json_response["detail"] = "命名空间不存在";
+                response = createJsonResponse(404, json_response);
+            } else if (status == OpStatus::Invalid) {
+                json_response["detail"] = "名称不能为空、不能包含冒号或以下划线开头，请求体应为{\"quota_bytes\": N}";
+                response = createJsonResponse(400, json_response);
+            } else {
+                // 配置是幂等的，重试是安全的
+                json_response["detail"] = "部分节点不可用，可以稍后重试";
+                json_response["failed"] = Json::Value(Json::arrayValue);
+                for (const auto& node_id : failed) {
+                    json_response["failed"].append(node_id);
+                }
+                response = createJsonResponse(503, json_response);
+            }
+        }
+        else if (method == "POST" && path == "/_mget") {
+            // 批量获取：结果以NDJSON流式输出，直接写入客户端
+            if (handleMGet(client_fd, body)) {
+                closeConnection(client_fd);
+                return;
+            }
+            Json::Value error_response;
+            error_response["detail"] = "请求体应为{\"keys\": [...]}或键数组";
+            response = createJsonResponse(400, error_response);
+        }
+        else if (method == "GET" && path.compare(0, 8, "/_lease/") == 0 && path.length() > 8) {
+            // 租约获取：命中返回当前值，未命中时返回租约或等待标志，可能附带最近删除的旧值
+            std::string key = urlDecode(path.substr(8));
+            LeaseResult result;
+            
+            Json::Value json_response;
+            if (!server_->leaseGet(key, result)) {
+                json_response["detail"] = "负责节点不可用";
+                response = createJsonResponse(503, json_response);
+            } else if (result.found) {
+                json_response[key] = result.value;
+                response = createJsonResponse(200, json_response);
+            } else {
+                if (result.token != 0) {
+                    // 令牌以字符串返回，避免64位整数在JavaScript等客户端中丢失精度
+                    json_response["lease"] = std::to_string(result.token);
+                }
+                json_response["wait"] = result.wait;
+                if (result.stale) {
+                    json_response["stale"] = result.value;
+                }
+                response = createJsonResponse(404, json_response);
+            }
+        }
+        else if (method == "POST" && path == "/_lease") {
+            // 租约写入：请求体为{"key": ..., "value": ..., "lease": "..."}，租约无效时返回409
+            Json::Value json_data;
+            Json::Reader reader;
+            uint64_t token = 0;
+            
+            if (reader.parse(body, json_data) && json_data.isObject() &&
+                json_data["key"].isString() && json_data.isMember("value") && json_data["lease"].isString() &&
+                parseUint64(json_data["lease"].asString(), token)) {
+                std::string value;
+                if (json_data["value"].isString()) {
+                    value = json_data["value"].asString();
+                } else {
+                    Json::StreamWriterBuilder builder;
+                    value = Json::writeString(builder, json_data["value"]);
+                }
+                Json::Value json_response;
+                bool success = server_->leaseSet(json_data["key"].asString(), value, token);
+                json_response["success"] = success;
+                if (!success) {
+                    json_response["detail"] = "租约无效或已过期";
+                }
+                response = createJsonResponse(success ? 200 : 409, json_response);
+            } else {
+                Json::Value error_response;
+                error_response["detail"] = "请求体应为{\"key\": ..., \"value\": ..., \"lease\": \"...\"}";
+                response = createJsonResponse(400, error_response);
+            }
+        }
+        else if (method == "POST" && (path.compare(0, 7, "/_incr/") == 0 || path.compare(0, 7, "/_decr/") == 0) &&
+                 path.length() > 7) {
+            // 原子自增/自减：可选参数by指定步长（默认1），返回运算后的值
+            std::string key = urlDecode(path.substr(7));
+            int64_t by = 1;
+            bool valid_by = !query.count("by") || parseInt64(query["by"], by);
+            bool decrement = path[2] == 'd';
+            
+            Json::Value json_response;
+            int64_t result = 0;
+            OpStatus status = OpStatus::Invalid;
+            if (valid_by && (!decrement || by != std::numeric_limits<int64_t>::min())) {
+                status = server_->incr(key, decrement ? -by : by, result);
+            }
+            if (status == OpStatus::Ok) {
+                json_response[key] = Json::Int64(result);
+                response = createJsonResponse(200, json_response);
+            } else if (status == OpStatus::Unavailable) {
+                json_response["detail"] = "负责节点不可用";
+                response = createJsonResponse(503, json_response);
+            } else {
+                json_response["detail"] = valid_by ? "值不是整数或运算溢出" : "by应为64位整数";
+                response = createJsonResponse(400, json_response);
+            }
+        }
+        else if (method == "POST" && path == "/_cas") {
+            // 比较并交换：请求体为{"key": ..., "value": ..., "version": "..."}，
+            // version取自GET响应的ETag，"0"表示要求键不存在；版本不匹配时返回409和当前版本
+            Json::Value json_data;
+            Json::Reader reader;
+            uint64_t expected_version = 0;
+            
+            if (reader.parse(body, json_data) && json_data.isObject() &&
+                json_data["key"].isString() && json_data.isMember("value") && json_data["version"].isString() &&
+                parseUint64(json_data["version"].asString(), expected_version)) {
+                std::string value;
+                if (json_data["value"].isString()) {
+                    value = json_data["value"].asString();
+                } else {
+                    Json::StreamWriterBuilder builder;
+                    value = Json::writeString(builder, json_data["value"]);
+                }
+                Json::Value json_response;
+                uint64_t version = 0;
+                OpStatus status = server_->compareAndSwap(json_data["key"].asString(), value, expected_version, version);
+                if (status == OpStatus::Unavailable) {
+                    json_response["detail"] = "负责节点不可用";
+                    response = createJsonResponse(503, json_response);
+                } else {
+                    // 版本以字符串返回，与租约令牌一致
+                    json_response["success"] = status == OpStatus::Ok;
+                    json_response["version"] = std::to_string(version);
+                    response = createJsonResponse(status == OpStatus::Ok ? 200 : 409, json_response);
+                }
+            } else {
+                Json::Value error_response;
+                error_response["detail"] = "请求体应为{\"key\": ..., \"value\": ..., \"version\": \"十进制版本号\"}";
+                response = createJsonResponse(400, error_response);
+            }
+        }
+        else if (method == "POST" && ((path.compare(0, 9, "/_append/") == 0 && path.length() > 9) ||
+                                      (path.compare(0, 11, "/_setrange/") == 0 && path.length() > 11))) {
+            // 追加/范围写入：请求体为原始字节，只有这部分数据经过网络和复制，返回写入后的值长度
+            bool is_append = path[2] == 'a';
+            std::string key = urlDecode(path.substr(is_append ? 9 : 11));
+            
+            size_t length = 0;
+            uint64_t offset = 0;
+            OpStatus status = OpStatus::Invalid;
+            if (is_append) {
+                status = server_->append(key, body, length);
+            } else if (query.count("offset") && parseUint64(query["offset"], offset)) {
+                status = server_->setRange(key, offset, body, length);
+            }
+            
+            Json::Value json_response;
+            if (status == OpStatus::Ok) {
+                json_response[key] = Json::UInt64(length);
+                response = createJsonResponse(200, json_response);
+            } else if (status == OpStatus::Unavailable) {
+                json_response["detail"] = "负责节点不可用";
+                response = createJsonResponse(503, json_response);
+            } else {
+                json_response["detail"] = "缺少offset参数、offset不是非负整数或超过长度上限";
+                response = createJsonResponse(400, json_response);
+            }
+        }
+        else if (method == "POST" && (path == "/_mset" || path == "/_mdel")) {
+            // 多键事务：所有键必须属于同一个节点（例如使用相同的哈希标签），在负责节点上原子执行。
+            // /_mset请求体为键值对象，nx=1要求所有键都不存在，xx=1要求所有键都存在，条件不满足时返回409；
+            // /_mdel请求体为{"keys": [...]}，返回实际删除的键数量
+            Json::Value json_data;
+            Json::Reader reader;
+            bool parsed = reader.parse(body, json_data);
+            EntryTtl ttl;
+            bool valid_ttl = parseTtl(query, ttl);
+            
+            Json::Value json_response;
+            OpStatus status = OpStatus::Invalid;
+            if (path == "/_mset" && parsed && json_data.isObject() && valid_ttl) {
+                std::vector<std::pair<std::string, std::string>> entries;
+                for (const auto& key : json_data.getMemberNames()) {
+                    std::string value;
+                    if (json_data[key].isString()) {
+                        value = json_data[key].asString();
+                    } else {
+                        Json::StreamWriterBuilder builder;
+                        value = Json::writeString(builder, json_data[key]);
+                    }
+                    entries.emplace_back(key, value);
+                }
+                
+                WriteCondition condition = WriteCondition::Always;
+                if (query.count("nx") && query["nx"] == "1") {
+                    condition = WriteCondition::IfNoneExist;
+                } else if (query.count("xx") && query["xx"] == "1") {
+                    condition = WriteCondition::IfAllExist;
+                }
+                
+                status = server_->multiSet(entries, ttl, condition);
+                json_response["success"] = status == OpStatus::Ok;
+            } else if (path == "/_mdel" && parsed && json_data.isObject() && json_data["keys"].isArray()) {
+                std::vector<std::string> keys;
+                for (const auto& item : json_data["keys"]) {
+                    if (item.isString()) {
+                        keys.push_back(item.asString());
+                    }
+                }
+                size_t deleted = 0;
+                status = server_->multiDel(keys, deleted);
+                json_response["deleted"] = Json::UInt64(deleted);
+            }
+            
+            if (status == OpStatus::Ok) {
+                response = createJsonResponse(200, json_response);
+            } else if (status == OpStatus::Conflict) {
+                json_response["detail"] = "写入条件不满足，未写入任何键";
+                response = createJsonResponse(409, json_response);
+            } else {
+                Json::Value error_response;
+                int status_code = 400;
+                if (status == OpStatus::Unavailable) {
+                    status_code = 503;
+                    error_response["detail"] = "负责节点不可用";
+                } else if (status == OpStatus::CrossNode) {
+                    error_response["detail"] = "键不属于同一个节点，请使用相同的哈希标签";
+                } else if (path == "/_mset" && !valid_ttl) {
+                    error_response["detail"] = "ttl_ms、soft_ttl_ms和recompute_ms应为整数（毫秒）";
+                } else {
+                    error_response["detail"] = "请求体应为非空键值对象或{\"keys\": [...]}";
+                }
+                response = createJsonResponse(status_code, error_response);
+            }
+        }
+        else if (path.compare(0, 7, "/_hash/") == 0 && path.length() > 7 &&
+                 (method == "GET" || method == "POST" || method == "DELETE")) {
+            // 哈希类型：GET读取字段（fields=a,b，省略时读取全部），POST写入请求体中的字段，DELETE删除fields中的字段
+            std::string key = urlDecode(path.substr(7));
+            std::vector<std::string> names;
+            if (query.count("fields")) {
+                std::istringstream fields_stream(query["fields"]);
+                std::string name;
+                while (std::getline(fields_stream, name, ',')) {
+                    if (!name.empty()) {
+                        names.push_back(name);
+                    }
+                }
+            }
+            
+            Json::Value json_response;
+            OpStatus status = OpStatus::Invalid;
+            if (method == "GET") {
+                std::vector<FieldValue> fields(names.size());
+                for (size_t i = 0; i < names.size(); i++) {
+                    fields[i].field = names[i];
+                }
+                status = server_->hashGet(key, fields);
+                json_response = Json::Value(Json::objectValue);
+                for (const auto& field : fields) {
+                    // 不存在的字段返回null
+                    json_response[field.field] = field.found ? Json::Value(field.value) : Json::Value();
+                }
+            } else if (method == "POST") {
+                Json::Value json_data;
+                Json::Reader reader;
+                if (reader.parse(body, json_data) && json_data.isObject() && !json_data.empty()) {
+                    std::vector<FieldValue> fields;
+                    for (const auto& name : json_data.getMemberNames()) {
+                        std::string value;
+                        if (json_data[name].isString()) {
+                            value = json_data[name].asString();
+                        } else {
+                            Json::StreamWriterBuilder builder;
+                            value = Json::writeString(builder, json_data[name]);
+                        }
+                        fields.emplace_back(name, value);
+                    }
+                    size_t added = 0;
+                    status = server_->hashSet(key, fields, added);
+                    json_response["added"] = Json::UInt64(added);
+                }
+            } else if (!names.empty()) {
+                size_t removed = 0;
+                status = server_->hashDel(key, names, removed);
+                json_response["removed"] = Json::UInt64(removed);
+            }
+            
+            if (status == OpStatus::Ok) {
+                response = createJsonResponse(200, json_response);
+            } else {
+                Json::Value error_response;
+                int status_code = 400;
+                if (status == OpStatus::NotFound) {
+                    status_code = 404;
+                    error_response["detail"] = "未找到";
+                } else if (status == OpStatus::Unavailable) {
+                    status_code = 503;
+                    error_response["detail"] = "负责节点不可用";
+                } else {
+                    error_response["detail"] = "键不是哈希类型，或请求体不是非空JSON对象，或缺少fields参数";
+                }
+                response = createJsonResponse(status_code, error_response);
+            }
+        }
         else if (method == "POST" && path == "/") {
             // 设置操作：批量设置键值对
             Json::Value json_data;
             Json::Reader reader;
+            // 可选的过期参数，作用于本次请求中的所有键
+            EntryTtl ttl;
             
-            if (reader.parse(body, json_data)) {
+            if (!parseTtl(query, ttl)) {
+                Json::Value error_response;
+                error_response["detail"] = "ttl_ms、soft_ttl_ms和recompute_ms应为整数（毫秒）";
+                response = createJsonResponse(400, error_response);
+            } else if (reader.parse(body, json_data)) {
                 Json::Value json_response;
                 bool all_success = true;
                 
@@ -161,7 +875,7 @@ void HttpHandler::handleRequest(int client_fd) {
                     }
                     
                     // 调用缓存服务器的设置方法
-                    if (!server_->set(key, value)) {
+                    if (!server_->set(key, value, ttl)) {
                         all_success = false;
                     }
                 }
@@ -179,18 +893,58 @@ void HttpHandler::handleRequest(int client_fd) {
                 response = createHttpResponse(400, "application/json", json_str);
             }
         }
+        else if (method == "GET" && path.length() > 1 && headers.count("range") &&
+                 parseRange(headers["range"], range_start, range_end)) {
+            // 范围读取：支持单个字节范围bytes=a-b、bytes=a-、bytes=-n，返回值的原始字节；
+            // 无法识别的Range请求头按普通读取处理
+            std::string key = urlDecode(path.substr(1)); // 移除路径前的'/'
+            std::string value;
+            size_t length = 0;
+            int64_t first = range_start;
+            int64_t last = range_end;
+            if (!server_->getRange(key, range_start, range_end, value, length)) {
+                Json::Value error_response;
+                error_response["detail"] = "未找到";
+                response = createJsonResponse(404, error_response);
+            } else if (!LocalStore::clampRange(first, last, length)) {
+                // 范围完全在值之外
+                Json::Value error_response;
+                error_response["detail"] = "范围无法满足";
+                std::string extra_headers = "Content-Range: bytes */" + std::to_string(length) + "\r\n";
+                Json::StreamWriterBuilder builder;
+                response = createHttpResponse(416, "application/json", Json::writeString(builder, error_response),
+                                              extra_headers);
+            } else {
+                std::string extra_headers = "Content-Range: bytes " + std::to_string(first) + "-" +
+                                            std::to_string(last) + "/" + std::to_string(length) + "\r\n";
+                response = createHttpResponse(206, "application/octet-stream", value, extra_headers);
+            }
+        }
         else if (method == "GET" && path.length() > 1) {
             // 获取操作：根据键获取值
             std::string key = urlDecode(path.substr(1)); // 移除路径前的'/'
             std::string value;
+            ReadMeta meta;
             
-            if (server_->get(key, value)) {
-                // 成功获取到值，返回JSON格式响应
+            if (server_->get(key, value, &meta)) {
+                // 成功获取到值，返回JSON格式响应；软过期状态通过响应头返回
                 Json::Value json_response;
                 json_response[key] = value;
                 Json::StreamWriterBuilder builder;
                 std::string json_str = Json::writeString(builder, json_response);
-                response = createHttpResponse(200, "application/json", json_str);
+                std::string extra_headers;
+                if (meta.stale) {
+                    extra_headers += "X-Cache-Stale: 1\r\n";
+                }
+                if (meta.refresh) {
+                    extra_headers += "X-Cache-Refresh: 1\r\n";
+                }
+                if (meta.version != 0) {
+                    // 版本只由负责节点返回，可用作比较并交换的期望版本
+                    extra_headers += "ETag: \"" + std::to_string(meta.version) + "\"\r\n";
+                }
+                extra_headers += "Accept-Ranges: bytes\r\n";
+                response = createHttpResponse(200, "application/json", json_str, extra_headers);
             } else {
                 // 键不存在，返回404错误
                 Json::Value error_response;
@@ -226,21 +980,192 @@ void HttpHandler::handleRequest(int client_fd) {
     }
     
     // 发送响应并关闭连接
-    send(client_fd, response.c_str(), response.length(), 0);
-    close(client_fd);
+    sendAll(client_fd, response);
+    closeConnection(client_fd);
+}
+
+/**
+ * 读取完整的HTTP请求
+ * 先读取到请求头结束标记，再按Content-Length读取完整的请求体，
+ * 单次recv无法保证读到完整请求，批量请求的请求体往往超过一个缓冲区。
+ * 读到请求头后先检查API密钥和命名空间的速率，超出速率的请求不再读取请求体
+ * @param client_fd 客户端套接字文件描述符
+ * @param request 输出参数，原始HTTP请求字符串
+ * @param retry_after 输出参数，超出速率时为令牌恢复所需的等待时间
+ * @return 读取成功返回200，请求过大返回413，超出速率返回429，连接异常返回0
+ */
+int HttpHandler::readRequest(int client_fd, std::string& request, std::chrono::nanoseconds& retry_after) {
+    const size_t max_header_bytes = 64 * 1024;
+    char buffer[4096];
+    
+    // 读取请求头
+    size_t header_end = std::string::npos;
+    while (header_end == std::string::npos) {
+        ssize_t bytes_read = recv(client_fd, buffer, sizeof(buffer), 0);
+        if (bytes_read <= 0) {
+            return request.empty() ? 0 : 200;  // 没有完整头部时按已读内容处理
+        }
+        request.append(buffer, bytes_read);
+        header_end = request.find("\r\n\r\n");
+        if (header_end == std::string::npos && request.size() > max_header_bytes) {
+            return 413;
+        }
+    }
+    
+    if ((api_key_limiter_ || namespace_limiter_) && !admitRequest(request, header_end, retry_after)) {
+        return 429;
+    }
+    
+    // 从请求头中查找Content-Length
+    std::string header_block = request.substr(0, header_end);
+    std::transform(header_block.begin(), header_block.end(), header_block.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    size_t content_length = 0;
+    size_t pos = header_block.find("\r\ncontent-length:");
+    if (pos != std::string::npos) {
+        try {
+            content_length = std::stoull(header_block.substr(pos + 17));
+        } catch (const std::exception& e) {
+            content_length = 0;
+        }
+    }
+    if (content_length > limits_.max_body_bytes) {
+        return 413;
+    }
+    
+    // 读取剩余的请求体
+    size_t total_length = header_end + 4 + content_length;
+    while (request.size() < total_length) {
+        ssize_t bytes_read = recv(client_fd, buffer, std::min(sizeof(buffer), total_length - request.size()), 0);
+        if (bytes_read <= 0) {
+            return 0;
+        }
+        request.append(buffer, bytes_read);
+    }
+    
+    return 200;
+}
+
+/**
+ * 处理批量获取请求
+ * 请求体可以是{"keys": ["k1", "k2"]}或["k1", "k2"]
+ * 响应使用分块传输编码，每个节点的结果到达后立即作为一个分块写出，
+ * 每行一个JSON对象：{"key":...,"value":...}、{"key":...,"found":false}或{"key":...,"error":true}
+ * @param client_fd 客户端套接字文件描述符
+ * @param body 请求体
+ * @return 是否已经直接向客户端输出了响应，请求体无效时返回false
+ */
+bool HttpHandler::handleMGet(int client_fd, const std::string& body) {
+    Json::Value json_data;
+    Json::Reader reader;
+    if (!reader.parse(body, json_data)) {
+        return false;
+    }
+    
+    const Json::Value& key_list = json_data.isObject() ? json_data["keys"] : json_data;
+    if (!key_list.isArray()) {
+        return false;
+    }
+    
+    std::vector<std::string> keys;
+    for (const auto& key : key_list) {
+        if (!key.isString()) {
+            return false;
+        }
+        keys.push_back(key.asString());
+    }
+    
+    // 先发送响应头，之后逐个分块输出
+    std::ostringstream header;
+    header << "HTTP/1.1 200 " << statusText(200) << "\r\n";
+    header << "Content-Type: application/x-ndjson\r\n";
+    header << "Transfer-Encoding: chunked\r\n";
+    header << "Connection: close\r\n";
+    header << "\r\n";
+    bool connected = sendAll(client_fd, header.str());
+    
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    
+    server_->mget(keys, [&](const std::vector<KeyValueResult>& results) {
+        if (!connected || results.empty()) {
+            return;
+        }
+        
+        std::string lines;
+        for (const auto& result : results) {
+            Json::Value line;
+            line["key"] = result.key;
+            if (result.error) {
+                line["error"] = true;
+            } else if (result.found) {
+                line["value"] = result.value;
+            } else {
+                line["found"] = false;
+            }
+            lines += Json::writeString(builder, line);
+            lines += "\n";
+        }
+        
+        // 分块格式：十六进制长度\r\n数据\r\n
+        std::ostringstream chunk;
+        chunk << std::hex << lines.size() << "\r\n" << lines << "\r\n";
+        connected = sendAll(client_fd, chunk.str());
+    });
+    
+    // 结束分块
+    if (connected) {
+        sendAll(client_fd, "0\r\n\r\n");
+    }
+    return true;
+}
+
+/**
+ * 完整发送数据
+ * send可能只发送部分数据，循环直到全部发送或连接出错
+ * @param client_fd 客户端套接字文件描述符
+ * @param data 要发送的数据
+ * @return 是否全部发送成功
+ */
+bool HttpHandler::sendAll(int client_fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(client_fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        sent += n;
+    }
+    return true;
+}
+
+/**
+ * 创建JSON格式的HTTP响应
+ * @param status_code HTTP状态码
+ * @param json 响应体JSON对象
+ * @return 完整的HTTP响应字符串
+ */
+std::string HttpHandler::createJsonResponse(int status_code, const Json::Value& json) {
+    Json::StreamWriterBuilder builder;
+    std::string json_str = Json::writeString(builder, json);
+    return createHttpResponse(status_code, "application/json", json_str);
 }
 
 /**
  * 解析HTTP请求
- * 从原始HTTP请求字符串中提取方法、路径和请求体
+ * 从原始HTTP请求字符串中提取方法、路径、请求头和请求体
  * @param request 原始HTTP请求字符串
  * @param method 输出参数，HTTP方法（GET、POST、DELETE等）
  * @param path 输出参数，请求路径
- * @param body 输出参数，请求体内容
+ * @param body 输出参数，请求体内容（原样保留，包括换行）
+ * @param headers 输出参数，请求头，名称统一转为小写
  * @return 空字符串（保留用于扩展）
  */
-std::string HttpHandler::parseHttpRequest(const std::string& request, std::string& method, std::string& path, std::string& body) {
-    std::istringstream iss(request);
+std::string HttpHandler::parseHttpRequest(const std::string& request, std::string& method, std::string& path, std::string& body,
+                                          std::unordered_map<std::string, std::string>& headers) {
+    // 头部和体以空行分隔
+    size_t header_end = request.find("\r\n\r\n");
+    std::istringstream iss(request.substr(0, header_end));
     std::string line;
     
     // 解析请求行：提取HTTP方法和路径
@@ -249,21 +1174,25 @@ std::string HttpHandler::parseHttpRequest(const std::string& request, std::strin
         first_line >> method >> path;
     }
     
-    // 跳过HTTP头部，寻找空行（头部和体的分隔符）
-    bool in_body = false;
+    // 解析请求头
     while (std::getline(iss, line)) {
-        if (line == "\r" || line.empty()) {
-            in_body = true;
-            break;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) {
+            continue;
         }
+        std::string name = line.substr(0, colon);
+        std::transform(name.begin(), name.end(), name.begin(),
+                       [](unsigned char c) { return std::tolower(c); });
+        size_t value_start = line.find_first_not_of(' ', colon + 1);
+        headers[name] = value_start == std::string::npos ? "" : line.substr(value_start);
     }
     
     // 读取请求体内容
-    if (in_body) {
-        std::string body_line;
-        while (std::getline(iss, body_line)) {
-            body += body_line;
-        }
+    if (header_end != std::string::npos) {
+        body = request.substr(header_end + 4);
     }
     
     return "";
@@ -275,25 +1204,18 @@ std::string HttpHandler::parseHttpRequest(const std::string& request, std::strin
  * @param status_code HTTP状态码
  * @param content_type 内容类型（如application/json、text/plain）
  * @param body 响应体内容
+ * @param extra_headers 额外的响应头，每行以\r\n结尾
  * @return 完整的HTTP响应字符串
  */
-std::string HttpHandler::createHttpResponse(int status_code, const std::string& content_type, const std::string& body) {
+std::string HttpHandler::createHttpResponse(int status_code, const std::string& content_type, const std::string& body,
+                                            const std::string& extra_headers) {
     std::ostringstream oss;
     
-    // 根据状态码确定状态文本
-    std::string status_text;
-    switch (status_code) {
-        case 200: status_text = "成功"; break;
-        case 400: status_text = "请求错误"; break;
-        case 404: status_text = "未找到"; break;
-        case 500: status_text = "内部服务器错误"; break;
-        default: status_text = "未知"; break;
-    }
-    
     // 构建HTTP响应头
-    oss << "HTTP/1.1 " << status_code << " " << status_text << "\r\n";
+    oss << "HTTP/1.1 " << status_code << " " << statusText(status_code) << "\r\n";
     oss << "Content-Type: " << content_type << "\r\n";
     oss << "Content-Length: " << body.length() << "\r\n";
+    oss << extra_headers;
     oss << "Connection: close\r\n";
     oss << "\r\n";  // 头部和体之间的空行
     oss << body;     // 响应体
@@ -301,6 +1223,149 @@ std::string HttpHandler::createHttpResponse(int status_code, const std::string&
     return oss.str();
 }
 
+/**
+ * 解析URL查询字符串
+ * @param query_string 问号之后的查询字符串，例如limit=10&scope=cluster
+ * @return 参数名到参数值的映射，参数名和值都已URL解码
+ */
+std::unordered_map<std::string, std::string> HttpHandler::parseQuery(const std::string& query_string) {
+    std::unordered_map<std::string, std::string> params;
+    std::istringstream iss(query_string);
+    std::string pair;
+    while (std::getline(iss, pair, '&')) {
+        if (pair.empty()) {
+            continue;
+        }
+        size_t eq = pair.find('=');
+        if (eq == std::string::npos) {
+            params[urlDecode(pair)] = "";
+        } else {
+            params[urlDecode(pair.substr(0, eq))] = urlDecode(pair.substr(eq + 1));
+        }
+    }
+    return params;
+}
+
+/**
+ * 解析十进制有符号整数
+ * @param text 文本
+ * @param value 输出参数，解析结果
+ * @return 是否解析成功
+ */
+bool HttpHandler::parseInt64(const std::string& text, int64_t& value) {
+    const char* end = text.data() + text.size();
+    auto result = std::from_chars(text.data(), end, value);
+    return !text.empty() && result.ec == std::errc() && result.ptr == end;
+}
+
+/**
+ * 解析十进制无符号整数
+ * @param text 文本
+ * @param value 输出参数，解析结果
+ * @return 是否解析成功
+ */
+bool HttpHandler::parseUint64(const std::string& text, uint64_t& value) {
+    const char* end = text.data() + text.size();
+    auto result = std::from_chars(text.data(), end, value);
+    return !text.empty() && result.ec == std::errc() && result.ptr == end;
+}
+
+/**
+ * 解析查询参数中的过期参数
+ * @param query 查询参数
+ * @param ttl 输出参数，过期参数
+ * @return 是否解析成功
+ */
+bool HttpHandler::parseTtl(std::unordered_map<std::string, std::string>& query, EntryTtl& ttl) {
+    return (!query.count("ttl_ms") || parseInt64(query["ttl_ms"], ttl.ttl_ms)) &&
+           (!query.count("soft_ttl_ms") || parseInt64(query["soft_ttl_ms"], ttl.soft_ttl_ms)) &&
+           (!query.count("recompute_ms") || parseInt64(query["recompute_ms"], ttl.recompute_ms));
+}
+
+/**
+ * 解析Range请求头
+ * 只支持单个字节范围，多个范围或其他单位返回false，由调用方按普通读取处理
+ * @param header Range请求头的值，例如bytes=0-99、bytes=100-、bytes=-50
+ * @param start 输出参数，起始位置（包含），后缀范围为负数
+ * @param end 输出参数，结束位置（包含），-1表示到末尾
+ * @return 是否解析成功
+ */
+bool HttpHandler::parseRange(const std::string& header, int64_t& start, int64_t& end) {
+    const std::string prefix = "bytes=";
+    if (header.compare(0, prefix.size(), prefix) != 0 || header.find(',') != std::string::npos) {
+        return false;
+    }
+    std::string spec = header.substr(prefix.size());
+    size_t dash = spec.find('-');
+    if (dash == std::string::npos) {
+        return false;
+    }
+    std::string first = spec.substr(0, dash);
+    std::string last = spec.substr(dash + 1);
+    // 只接受数字，超出int64范围的位置无法满足，和其他无法识别的范围一样按普通读取处理
+    auto to_position = [](const std::string& s, int64_t& position) {
+        return !s.empty() && std::all_of(s.begin(), s.end(), ::isdigit) && parseInt64(s, position);
+    };
+    
+    int64_t suffix = 0;
+    if (first.empty()) {
+        // 最后n个字节，n为0时无法满足，按普通读取处理
+        if (!to_position(last, suffix) || suffix == 0) {
+            return false;
+        }
+        start = -suffix;
+        end = -1;
+        return true;
+    }
+    if (!to_position(first, start) || (!last.empty() && !to_position(last, end))) {
+        return false;
+    }
+    if (last.empty()) {
+        end = -1;
+    }
+    return end < 0 || start <= end;
+}
+
+/**
+ * 获取HTTP状态码对应的状态文本
+ * @param status_code HTTP状态码
+ * @return 状态文本
+ */
+std::string HttpHandler::statusText(int status_code) {
+    switch (status_code) {
+        case 200: return "成功";
+        case 202: return "已接受";
+        case 206: return "部分内容";
+        case 400: return "请求错误";
+        case 404: return "未找到";
+        case 409: return "冲突";
+        case 413: return "请求体过大";
+        case 416: return "范围无法满足";
+        case 429: return "请求过多";
+        case 500: return "内部服务器错误";
+        case 503: return "服务不可用";
+        default: return "未知";
+    }
+}
+
+/**
+ * 把前缀转换为glob模式
+ * 转义前缀中的glob特殊字符，再在末尾加上*
+ * @param prefix 键前缀
+ * @return glob模式
+ */
+std::string HttpHandler::prefixPattern(const std::string& prefix) {
+    std::string pattern;
+    for (char c : prefix) {
+        if (c == '*' || c == '?' || c == '[' || c == ']' || c == '\\') {
+            pattern += '\\';
+        }
+        pattern += c;
+    }
+    pattern += '*';
+    return pattern;
+}
+
 /**
  * URL解码
  * 将URL编码的字符串解码为原始字符串
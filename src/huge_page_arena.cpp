@@ -0,0 +1,283 @@
+#include "huge_page_arena.h"
+#include "numa_topology.h"
+#include <sys/mman.h>
+#include <algorithm>
+#include <cstring>
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+
+/**
+ * 大页内存来源构造函数
+ * @param page_bytes 首选的页大小
+ * @param node NUMA节点的系统编号
+ */
+HugePageArena::HugePageArena(size_t page_bytes, int node)
+    : page_bytes_(page_bytes), node_(node), chunks_(nullptr), next_(nullptr), chunk_end_(nullptr) {
+    for (auto& mapped : mapped_) {
+        mapped.store(0, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * 析构函数
+ * 使用这些内存的容器先于本对象析构，大块已经归还；内存块的头部信息保存在块内，先读出下一个再解除映射
+ */
+HugePageArena::~HugePageArena() {
+    while (chunks_) {
+        Chunk* next = chunks_->next;
+        munmap(chunks_, chunks_->bytes);
+        chunks_ = next;
+    }
+}
+
+/**
+ * 从当前内存块中切出一段内存
+ * 内存块的开头一个缓存行用来保存块的头部信息
+ * @param bytes 字节数
+ * @return 内存，映射失败时为空
+ */
+void* HugePageArena::carve(size_t bytes) {
+    const size_t kCacheLine = 64;
+    bytes = (bytes + kCacheLine - 1) / kCacheLine * kCacheLine;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (static_cast<size_t>(chunk_end_ - next_) < bytes) {
+        size_t chunk_bytes = std::max(page_bytes_, kMinChunkBytes);
+        PageKind kind;
+        void* memory = mapPages(chunk_bytes, page_bytes_, kind);
+        if (!memory) {
+            return nullptr;
+        }
+        mapped_[static_cast<int>(kind)].fetch_add(chunk_bytes, std::memory_order_relaxed);
+        Chunk* chunk = static_cast<Chunk*>(memory);
+        chunk->next = chunks_;
+        chunk->bytes = chunk_bytes;
+        chunk->kind = kind;
+        chunks_ = chunk;
+        next_ = static_cast<char*>(memory) + kCacheLine;
+        chunk_end_ = static_cast<char*>(memory) + chunk_bytes;
+    }
+    void* memory = next_;
+    next_ += bytes;
+    return memory;
+}
+
+/**
+ * 为大块内存单独映射
+ * 大块内存只有大分片的桶数组，按2MB页映射，不使用1GB页
+ * @param bytes 字节数
+ * @return 内存，映射失败时为空
+ */
+void* HugePageArena::allocateLarge(size_t bytes) {
+    size_t mapped = largeBytes(bytes);
+    PageKind kind;
+    void* memory = mapPages(mapped, kLargePageBytes, kind);
+    if (memory) {
+        mapped_[static_cast<int>(kind)].fetch_add(mapped, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(mutex_);
+        large_[memory] = kind;
+    }
+    return memory;
+}
+
+/**
+ * 解除大块内存的映射
+ * @param memory allocateLarge返回的内存
+ * @param bytes 分配时的字节数
+ */
+void HugePageArena::freeLarge(void* memory, size_t bytes) {
+    size_t mapped = largeBytes(bytes);
+    PageKind kind;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = large_.find(memory);
+        kind = it->second;
+        large_.erase(it);
+    }
+    mapped_[static_cast<int>(kind)].fetch_sub(mapped, std::memory_order_relaxed);
+    munmap(memory, mapped);
+}
+
+/**
+ * 页面类型的名称
+ * @param kind 页面类型
+ * @return 名称
+ */
+const char* HugePageArena::kindName(PageKind kind) {
+    switch (kind) {
+        case PageKind::HugeTlb1G: return "hugetlb_1g";
+        case PageKind::HugeTlb2M: return "hugetlb_2m";
+        case PageKind::Transparent: return "transparent";
+        case PageKind::Normal: return "normal";
+        default: return "unknown";
+    }
+}
+
+/**
+ * 映射内存并设置NUMA节点
+ * 显式大页在映射时只预留，和普通页一样在首次访问时才分配物理页，因此映射之后设置策略仍然有效
+ * @param bytes 字节数，按实际页大小取整后写回
+ * @param page_bytes 首选的页大小
+ * @param kind 输出参数，实际的页面类型
+ * @return 内存，全部失败时为空
+ */
+void* HugePageArena::mapPages(size_t& bytes, size_t page_bytes, PageKind& kind) const {
+    void* memory = mapAnyPages(bytes, page_bytes, kind);
+    if (memory && node_ >= 0) {
+        NumaTopology::preferMemory(memory, bytes, node_);
+    }
+    return memory;
+}
+
+/**
+ * 映射内存
+ * 1GB显式大页失败时尝试2MB显式大页，再失败时映射普通内存并按2MB对齐，用madvise请求透明大页；
+ * 内核不支持透明大页时就是普通页
+ * @param bytes 字节数，按实际页大小取整后写回
+ * @param page_bytes 首选的页大小
+ * @param kind 输出参数，实际的页面类型
+ * @return 内存，全部失败时为空
+ */
+void* HugePageArena::mapAnyPages(size_t& bytes, size_t page_bytes, PageKind& kind) {
+    const size_t kGigaPageBytes = 1024 * 1024 * 1024;
+    const int protection = PROT_READ | PROT_WRITE;
+    const int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+
+    if (page_bytes >= kGigaPageBytes) {
+        size_t rounded = (bytes + kGigaPageBytes - 1) / kGigaPageBytes * kGigaPageBytes;
+        void* memory = mmap(nullptr, rounded, protection, flags | MAP_HUGETLB | (30 << MAP_HUGE_SHIFT), -1, 0);
+        if (memory != MAP_FAILED) {
+            bytes = rounded;
+            kind = PageKind::HugeTlb1G;
+            return memory;
+        }
+    }
+
+    size_t rounded = largeBytes(bytes);
+    void* memory = mmap(nullptr, rounded, protection, flags | MAP_HUGETLB | (21 << MAP_HUGE_SHIFT), -1, 0);
+    if (memory != MAP_FAILED) {
+        bytes = rounded;
+        kind = PageKind::HugeTlb2M;
+        return memory;
+    }
+
+    // 多映射2MB再裁掉首尾，得到2MB对齐的区域，透明大页才能覆盖整个区域
+    size_t padded = rounded + kLargePageBytes;
+    char* raw = static_cast<char*>(mmap(nullptr, padded, protection, flags, -1, 0));
+    if (raw == MAP_FAILED) {
+        return nullptr;
+    }
+    uintptr_t address = reinterpret_cast<uintptr_t>(raw);
+    char* aligned = raw + ((kLargePageBytes - address % kLargePageBytes) % kLargePageBytes);
+    if (aligned > raw) {
+        munmap(raw, aligned - raw);
+    }
+    if (raw + padded > aligned + rounded) {
+        munmap(aligned + rounded, raw + padded - (aligned + rounded));
+    }
+    bytes = rounded;
+    kind = madvise(aligned, rounded, MADV_HUGEPAGE) == 0 ? PageKind::Transparent : PageKind::Normal;
+    return aligned;
+}
+
+/**
+ * 大块内存实际映射的字节数
+ * @param bytes 请求的字节数
+ * @return 按2MB取整后的字节数
+ */
+size_t HugePageArena::largeBytes(size_t bytes) {
+    return (bytes + kLargePageBytes - 1) / kLargePageBytes * kLargePageBytes;
+}
+
+/**
+ * slab分配器构造函数
+ * @param arena 大页内存来源
+ */
+SlabAllocator::SlabAllocator(HugePageArena* arena) : arena_(arena), cursor_(nullptr), slab_end_(nullptr) {
+    std::memset(free_lists_, 0, sizeof(free_lists_));
+    std::memset(medium_lists_, 0, sizeof(medium_lists_));
+}
+
+/**
+ * 分配内存
+ * 小块优先从对应级别的空闲链表取，其次从当前slab切分，slab不足时取新的slab（剩余部分舍弃）；
+ * 中等块优先从对应级别的空闲链表取，否则直接从内存块中切出
+ * @param bytes 字节数
+ * @return 内存
+ */
+void* SlabAllocator::allocate(size_t bytes) {
+    if (bytes > HugePageArena::kLargePageBytes) {
+        void* memory = arena_->allocateLarge(bytes);
+        if (!memory) {
+            throw std::bad_alloc();
+        }
+        return memory;
+    }
+    if (bytes > kMaxSmall) {
+        size_t size_class = mediumClass(bytes);
+        void* memory = medium_lists_[size_class];
+        if (memory) {
+            medium_lists_[size_class] = *static_cast<void**>(memory);
+            return memory;
+        }
+        memory = arena_->carve(kMinMedium << size_class);
+        if (!memory) {
+            throw std::bad_alloc();
+        }
+        return memory;
+    }
+
+    size_t size_class = (std::max<size_t>(bytes, 1) - 1) / kAlignment;
+    if (void* memory = free_lists_[size_class]) {
+        free_lists_[size_class] = *static_cast<void**>(memory);
+        return memory;
+    }
+    size_t rounded = (size_class + 1) * kAlignment;
+    if (static_cast<size_t>(slab_end_ - cursor_) < rounded) {
+        cursor_ = static_cast<char*>(arena_->carve(HugePageArena::kSlabBytes));
+        if (!cursor_) {
+            slab_end_ = nullptr;
+            throw std::bad_alloc();
+        }
+        slab_end_ = cursor_ + HugePageArena::kSlabBytes;
+    }
+    void* memory = cursor_;
+    cursor_ += rounded;
+    return memory;
+}
+
+/**
+ * 释放内存
+ * 小块和中等块放回对应级别的空闲链表，大块解除映射
+ * @param memory allocate返回的内存
+ * @param bytes 分配时的字节数
+ */
+void SlabAllocator::deallocate(void* memory, size_t bytes) {
+    if (bytes > HugePageArena::kLargePageBytes) {
+        arena_->freeLarge(memory, bytes);
+        return;
+    }
+    if (bytes > kMaxSmall) {
+        size_t size_class = mediumClass(bytes);
+        *static_cast<void**>(memory) = medium_lists_[size_class];
+        medium_lists_[size_class] = memory;
+        return;
+    }
+    size_t size_class = (std::max<size_t>(bytes, 1) - 1) / kAlignment;
+    *static_cast<void**>(memory) = free_lists_[size_class];
+    free_lists_[size_class] = memory;
+}
+
+/**
+ * 中等块的级别
+ * @param bytes 字节数
+ * @return 能容纳bytes的最小级别
+ */
+size_t SlabAllocator::mediumClass(size_t bytes) {
+    size_t size_class = 0;
+    while ((kMinMedium << size_class) < bytes) {
+        size_class++;
+    }
+    return size_class;
+}
\ No newline at end of file
@@ -0,0 +1,1574 @@
+#include "local_store.h"
+#include "key_hash.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <vector>
+
+/**
+ * 本地存储构造函数
+ * @param shard_count 分片数量
+ * @param art_index 是否用自适应基数树代替哈希表索引键
+ * @param lazy_free_bytes 交给后台释放的值的最小字节数，0表示总是就地释放
+ * @param huge_page_bytes 哈希表索引使用的页大小，0表示使用普通的堆内存
+ * @param shard_nodes 各分片的大页内存所在的NUMA节点，为空时不指定
+ */
+LocalStore::LocalStore(size_t shard_count, bool art_index, size_t lazy_free_bytes, size_t huge_page_bytes,
+                       const std::vector<int>& shard_nodes)
+    : next_version_(0), next_lease_token_(0), lazy_free_bytes_(lazy_free_bytes) {
+    if (lazy_free_bytes_ > 0) {
+        freer_ = std::make_unique<BackgroundFreer>();
+    }
+    size_t count = 1;
+    while (count < shard_count) {
+        count <<= 1;
+    }
+    shards_.reset(new Shard[count]);
+    shard_mask_ = count - 1;
+    for (size_t i = 0; i < count; i++) {
+        shards_[i].index = i;
+        shards_[i].random = 0x9E3779B97F4A7C15ULL * (i + 1);
+    }
+    default_namespace_ = newNamespace(kDefaultNamespace, 0);
+    if (art_index) {
+        for (size_t i = 0; i < count; i++) {
+            shards_[i].tree = std::make_unique<ArtIndex>();
+        }
+    } else if (huge_page_bytes > 0) {
+        // 同一NUMA节点上的分片共用一个内存来源，每个分片有自己的slab分配器，由分片锁保护
+        for (size_t i = 0; i < count; i++) {
+            int node = shard_nodes.empty() ? -1 : shard_nodes[i % shard_nodes.size()];
+            HugePageArena* arena = nullptr;
+            for (const auto& existing : arenas_) {
+                if (existing->node() == node) {
+                    arena = existing.get();
+                }
+            }
+            if (!arena) {
+                arenas_.push_back(std::make_unique<HugePageArena>(huge_page_bytes, node));
+                arena = arenas_.back().get();
+            }
+            shards_[i].slabs = std::make_unique<SlabAllocator>(arena);
+            shards_[i].entries = EntryMap(0, std::hash<std::string>(), std::equal_to<std::string>(),
+                                          EntryMap::allocator_type(shards_[i].slabs.get()));
+        }
+    }
+}
+
+/**
+ * 哈希表索引映射的内存，各NUMA节点的内存来源合计
+ * @param kind 页面类型
+ * @return 字节数
+ */
+uint64_t LocalStore::hugePageBytes(PageKind kind) const {
+    uint64_t bytes = 0;
+    for (const auto& arena : arenas_) {
+        bytes += arena->mappedBytes(kind);
+    }
+    return bytes;
+}
+
+/**
+ * 读取值
+ * @param key 缓存键
+ * @param value 输出参数，存储读取到的值
+ * @param meta 输出参数（可为空），值的元数据
+ * @param claim_refresh 是否允许本次读取领取刷新任务
+ * @return 键存在且未硬过期时返回true
+ */
+bool LocalStore::get(const std::string& key, std::string& value, ReadMeta* meta, bool claim_refresh) {
+    int64_t now = CacheEntry::nowNanos();
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    CacheEntry* entry = findLive(shard, key, now);
+    NamespaceUsage& usage = namespaceOf(shard, key)->usage[shard.index];
+    if (!entry) {
+        usage.misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    usage.hits.fetch_add(1, std::memory_order_relaxed);
+    value = entry->stringValue();
+    if (meta) {
+        entry->inspect(now, claim_refresh, *meta);
+    }
+    return true;
+}
+
+/**
+ * 写入值
+ * 新条目的刷新任务状态随之重置，未完成的租约随之失效
+ * @param key 缓存键
+ * @param value 缓存值
+ * @param ttl 过期参数
+ * @return 新版本
+ */
+uint64_t LocalStore::set(const std::string& key, const std::string& value, const EntryTtl& ttl) {
+    CacheEntry entry(value, ttl, CacheEntry::nowNanos());
+    entry.version = ++next_version_;
+    uint64_t version = entry.version;
+
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    CacheEntry* old = findEntry(shard, key);
+    size_t before = old ? entryBytes(key, *old) : 0;
+    CacheEntry& stored = old ? *old : insertEntry(shard, key);
+    dispose(stored);
+    stored = std::move(entry);
+    shard.leases.erase(key);
+    charge(shard, key, before, entryBytes(key, stored));
+    return version;
+}
+
+/**
+ * 键不存在时写入值
+ * @param key 缓存键
+ * @param value 输入要写入的值；键已存在时输出当前值
+ * @return 是否写入
+ */
+bool LocalStore::insertIfAbsent(const std::string& key, std::string& value) {
+    int64_t now = CacheEntry::nowNanos();
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    CacheEntry* existing = findLive(shard, key, now);
+    if (existing) {
+        value = existing->stringValue();
+        return false;
+    }
+    CacheEntry& entry = insertEntry(shard, key);
+    entry = CacheEntry(value, EntryTtl(), now);
+    entry.version = ++next_version_;
+    charge(shard, key, 0, entryBytes(key, entry));
+    return true;
+}
+
+/**
+ * 删除键
+ * @param key 缓存键
+ * @param old_value 输出参数（可为空），被删除的值
+ * @return 键存在且未硬过期时返回true
+ */
+bool LocalStore::del(const std::string& key, std::string* old_value) {
+    int64_t now = CacheEntry::nowNanos();
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    shard.leases.erase(key);
+    CacheEntry* entry = findLive(shard, key, now);
+    if (!entry) {
+        return false;
+    }
+    eraseEntry(shard, key, old_value);
+    return true;
+}
+
+/**
+ * 把十进制整数值加上delta
+ * 整个读-改-写在分片锁内完成，并发自增不会丢失更新
+ * @param key 缓存键
+ * @param delta 增量
+ * @param result 输出参数，运算后的值
+ * @return Ok或Invalid
+ */
+OpStatus LocalStore::incr(const std::string& key, int64_t delta, int64_t& result) {
+    int64_t now = CacheEntry::nowNanos();
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    CacheEntry* entry = findLive(shard, key, now);
+    int64_t current = 0;
+    if (entry && entry->hash) {
+        return OpStatus::Invalid;
+    }
+    if (entry) {
+        const std::string& text = entry->value;
+        if (text.empty() || text.size() > 20) {
+            return OpStatus::Invalid;
+        }
+        char* end = nullptr;
+        errno = 0;
+        long long parsed = std::strtoll(text.c_str(), &end, 10);
+        if (errno != 0 || end != text.c_str() + text.size()) {
+            return OpStatus::Invalid;
+        }
+        current = parsed;
+    }
+
+    // 溢出检查
+    if ((delta > 0 && current > std::numeric_limits<int64_t>::max() - delta) ||
+        (delta < 0 && current < std::numeric_limits<int64_t>::min() - delta)) {
+        return OpStatus::Invalid;
+    }
+    result = current + delta;
+
+    size_t before = entry ? entryBytes(key, *entry) : 0;
+    if (!entry) {
+        entry = &findOrCreate(shard, key, now);
+    }
+    entry->value = std::to_string(result);
+    entry->version = ++next_version_;
+    shard.leases.erase(key);
+    charge(shard, key, before, entryBytes(key, *entry));
+    return OpStatus::Ok;
+}
+
+/**
+ * 比较并交换
+ * 写入的条目不带过期时间
+ * @param key 缓存键
+ * @param value 要写入的值
+ * @param expected_version 期望的版本，0表示要求键不存在
+ * @param version 输出参数，成功时为新版本，失败时为当前版本
+ * @return Ok或Conflict
+ */
+OpStatus LocalStore::compareAndSwap(const std::string& key, const std::string& value,
+                                    uint64_t expected_version, uint64_t& version) {
+    int64_t now = CacheEntry::nowNanos();
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    CacheEntry* entry = findLive(shard, key, now);
+    uint64_t current = entry ? entry->version : 0;
+    if (current != expected_version) {
+        version = current;
+        return OpStatus::Conflict;
+    }
+
+    size_t before = entry ? entryBytes(key, *entry) : 0;
+    if (!entry) {
+        entry = &insertEntry(shard, key);
+    }
+    dispose(*entry);
+    *entry = CacheEntry(value, EntryTtl(), now);
+    entry->version = ++next_version_;
+    version = entry->version;
+    shard.leases.erase(key);
+    charge(shard, key, before, entryBytes(key, *entry));
+    return OpStatus::Ok;
+}
+
+/**
+ * 在值的末尾追加数据
+ * 追加在分片锁内原地完成，复制量只与追加的字节数有关
+ * @param key 缓存键
+ * @param data 追加的数据
+ * @param length 输出参数，追加后的值长度
+ * @return Ok或Invalid
+ */
+OpStatus LocalStore::append(const std::string& key, const std::string& data, size_t& length) {
+    int64_t now = CacheEntry::nowNanos();
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    CacheEntry* existing = findLive(shard, key, now);
+    if (existing && existing->hash) {
+        return OpStatus::Invalid;
+    }
+    size_t current = existing ? existing->value.size() : 0;
+    if (data.size() > kMaxValueSize - current) {
+        return OpStatus::Invalid;
+    }
+
+    size_t before = existing ? entryBytes(key, *existing) : 0;
+    CacheEntry& entry = existing ? *existing : findOrCreate(shard, key, now);
+    entry.value.append(data);
+    entry.version = ++next_version_;
+    shard.leases.erase(key);
+    length = entry.value.size();
+    charge(shard, key, before, entryBytes(key, entry));
+    return OpStatus::Ok;
+}
+
+/**
+ * 读取值的一段
+ * @param key 缓存键
+ * @param start 起始位置（包含）
+ * @param end 结束位置（包含）
+ * @param value 输出参数，读取到的片段
+ * @param length 输出参数，完整值的长度
+ * @return 键存在且未硬过期时返回true
+ */
+bool LocalStore::getRange(const std::string& key, int64_t start, int64_t end, std::string& value, size_t& length) {
+    int64_t now = CacheEntry::nowNanos();
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    CacheEntry* entry = findLive(shard, key, now);
+    if (!entry) {
+        return false;
+    }
+    std::string json;
+    if (entry->hash) {
+        json = entry->hash->toJson();
+    }
+    const std::string& whole = entry->hash ? json : entry->value;
+    length = whole.size();
+    if (clampRange(start, end, length)) {
+        value.assign(whole, static_cast<size_t>(start), static_cast<size_t>(end - start + 1));
+    } else {
+        value.clear();
+    }
+    return true;
+}
+
+/**
+ * 从offset开始覆盖写入数据
+ * @param key 缓存键
+ * @param offset 写入位置
+ * @param data 写入的数据
+ * @param length 输出参数，写入后的值长度
+ * @return Ok或Invalid
+ */
+OpStatus LocalStore::setRange(const std::string& key, size_t offset, const std::string& data, size_t& length) {
+    if (offset > kMaxValueSize || data.size() > kMaxValueSize - offset) {
+        return OpStatus::Invalid;
+    }
+
+    int64_t now = CacheEntry::nowNanos();
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    CacheEntry* existing = findLive(shard, key, now);
+    if (existing && existing->hash) {
+        return OpStatus::Invalid;
+    }
+    size_t before = existing ? entryBytes(key, *existing) : 0;
+    CacheEntry& entry = existing ? *existing : findOrCreate(shard, key, now);
+    if (entry.value.size() < offset + data.size()) {
+        entry.value.resize(offset + data.size(), '\0');
+    }
+    entry.value.replace(offset, data.size(), data);
+    entry.version = ++next_version_;
+    shard.leases.erase(key);
+    length = entry.value.size();
+    charge(shard, key, before, entryBytes(key, entry));
+    return OpStatus::Ok;
+}
+
+/**
+ * 读取哈希字段
+ * @param key 缓存键
+ * @param fields 输入要读取的字段名，输出各字段是否存在及字段值；为空时读取全部字段
+ * @return Ok；键不存在时返回NotFound；键不是哈希类型时返回Invalid
+ */
+OpStatus LocalStore::hashGet(const std::string& key, std::vector<FieldValue>& fields) {
+    int64_t now = CacheEntry::nowNanos();
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    CacheEntry* entry = findLive(shard, key, now);
+    if (!entry) {
+        return OpStatus::NotFound;
+    }
+    if (!entry->hash) {
+        return OpStatus::Invalid;
+    }
+
+    if (fields.empty()) {
+        fields.reserve(entry->hash->size());
+        entry->hash->forEach([&fields](const std::string& field, const std::string& value) {
+            fields.emplace_back(field, value);
+        });
+        return OpStatus::Ok;
+    }
+    for (auto& field : fields) {
+        field.found = entry->hash->get(field.field, field.value);
+    }
+    return OpStatus::Ok;
+}
+
+/**
+ * 写入哈希字段，键不存在时创建
+ * 只修改给出的字段，其余字段不动；保留原有的过期时间
+ * @param key 缓存键
+ * @param fields 要写入的字段
+ * @param added 输出参数，新增的字段数量
+ * @return Ok；键不是哈希类型时返回Invalid
+ */
+OpStatus LocalStore::hashSet(const std::string& key, const std::vector<FieldValue>& fields, size_t& added) {
+    int64_t now = CacheEntry::nowNanos();
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    CacheEntry* existing = findLive(shard, key, now);
+    if (existing && !existing->hash) {
+        return OpStatus::Invalid;
+    }
+    size_t before = existing ? entryBytes(key, *existing) : 0;
+    CacheEntry& entry = existing ? *existing : findOrCreate(shard, key, now);
+    if (!entry.hash) {
+        entry.hash = std::make_unique<HashValue>();
+    }
+
+    added = 0;
+    for (const auto& field : fields) {
+        if (entry.hash->set(field.field, field.value)) {
+            added++;
+        }
+    }
+    entry.version = ++next_version_;
+    shard.leases.erase(key);
+    charge(shard, key, before, entryBytes(key, entry));
+    return OpStatus::Ok;
+}
+
+/**
+ * 删除哈希字段，最后一个字段删除后键也被删除
+ * @param key 缓存键
+ * @param fields 要删除的字段名
+ * @param removed 输出参数，实际删除的字段数量
+ * @return Ok；键不存在时返回NotFound；键不是哈希类型时返回Invalid
+ */
+OpStatus LocalStore::hashDel(const std::string& key, const std::vector<std::string>& fields, size_t& removed) {
+    int64_t now = CacheEntry::nowNanos();
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    CacheEntry* entry = findLive(shard, key, now);
+    if (!entry) {
+        return OpStatus::NotFound;
+    }
+    if (!entry->hash) {
+        return OpStatus::Invalid;
+    }
+
+    size_t before = entryBytes(key, *entry);
+    removed = 0;
+    for (const auto& field : fields) {
+        if (entry->hash->erase(field)) {
+            removed++;
+        }
+    }
+    charge(shard, key, before, entryBytes(key, *entry));
+    if (entry->hash->size() == 0) {
+        eraseEntry(shard, key);
+    } else if (removed > 0) {
+        entry->version = ++next_version_;
+    }
+    return OpStatus::Ok;
+}
+
+/**
+ * 原子地写入多个键
+ * @param entries 键值对
+ * @param ttl 过期参数
+ * @param condition 写入的前提条件
+ * @return Ok或Conflict
+ */
+OpStatus LocalStore::multiSet(const std::vector<std::pair<std::string, std::string>>& entries, const EntryTtl& ttl,
+                              WriteCondition condition) {
+    std::vector<std::string> keys;
+    keys.reserve(entries.size());
+    for (const auto& entry : entries) {
+        keys.push_back(entry.first);
+    }
+
+    int64_t now = CacheEntry::nowNanos();
+    auto locks = lockShards(keys);
+
+    // 先检查全部条件，任何一个键不满足时整批放弃
+    if (condition != WriteCondition::Always) {
+        for (const auto& key : keys) {
+            bool exists = findLive(shardFor(key), key, now) != nullptr;
+            if (exists != (condition == WriteCondition::IfAllExist)) {
+                return OpStatus::Conflict;
+            }
+        }
+    }
+
+    // 先写入全部键并记账，再按分片和命名空间统一淘汰，淘汰时排除整批键，
+    // 避免写入后面的键时淘汰掉同一批中前面的键，使其他读者看到只写入了一部分的批次
+    struct PendingEviction {
+        Shard* shard;
+        Namespace* ns;
+        size_t writes;   // 该分片上使该命名空间超出配额的写入次数
+    };
+    std::vector<PendingEviction> pending;
+    for (const auto& entry : entries) {
+        Shard& shard = shardFor(entry.first);
+        CacheEntry* old = findEntry(shard, entry.first);
+        size_t before = old ? entryBytes(entry.first, *old) : 0;
+        CacheEntry& stored = old ? *old : insertEntry(shard, entry.first);
+        dispose(stored);
+        stored = CacheEntry(entry.second, ttl, now);
+        stored.version = ++next_version_;
+        shard.leases.erase(entry.first);
+        Namespace* ns = account(shard, entry.first, before, entryBytes(entry.first, stored));
+        if (!ns) {
+            continue;
+        }
+        auto it = std::find_if(pending.begin(), pending.end(), [&](const PendingEviction& item) {
+            return item.shard == &shard && item.ns == ns;
+        });
+        if (it == pending.end()) {
+            pending.push_back(PendingEviction{&shard, ns, 1});
+        } else {
+            it->writes++;
+        }
+    }
+
+    if (!pending.empty()) {
+        std::unordered_set<std::string> batch(keys.begin(), keys.end());
+        for (const auto& item : pending) {
+            evict(*item.shard, *item.ns, batch, kEvictionsPerWrite * item.writes);
+        }
+    }
+    return OpStatus::Ok;
+}
+
+/**
+ * 原子地删除多个键
+ * @param keys 要删除的键
+ * @param removed 输出参数，实际删除的键及其旧值
+ */
+void LocalStore::multiDel(const std::vector<std::string>& keys,
+                          std::vector<std::pair<std::string, std::string>>& removed) {
+    int64_t now = CacheEntry::nowNanos();
+    auto locks = lockShards(keys);
+
+    for (const auto& key : keys) {
+        Shard& shard = shardFor(key);
+        shard.leases.erase(key);
+        CacheEntry* entry = findLive(shard, key, now);
+        if (!entry) {
+            continue;
+        }
+        removed.emplace_back(key, std::string());
+        eraseEntry(shard, key, &removed.back().second);
+    }
+}
+
+/**
+ * 把范围规整到[0, length)内
+ * @param start 输入输出参数，起始位置
+ * @param end 输入输出参数，结束位置
+ * @param length 值的长度
+ * @return 规整后的范围非空时返回true
+ */
+bool LocalStore::clampRange(int64_t& start, int64_t& end, size_t length) {
+    int64_t size = static_cast<int64_t>(length);
+    if (start < 0) {
+        start = std::max<int64_t>(size + start, 0);
+    }
+    if (end < 0) {
+        end = size + end;
+    }
+    end = std::min(end, size - 1);
+    return start <= end;
+}
+
+/**
+ * 租约获取
+ * @param key 缓存键
+ * @param lease_ttl 新租约的有效期
+ * @param result 输出参数，租约获取结果
+ */
+void LocalStore::leaseGet(const std::string& key, std::chrono::milliseconds lease_ttl, LeaseResult& result) {
+    auto now = std::chrono::steady_clock::now();
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    CacheEntry* entry = findLive(shard, key, CacheEntry::nowNanos());
+    if (entry) {
+        result.found = true;
+        result.value = entry->stringValue();
+        return;
+    }
+
+    auto it = shard.leases.find(key);
+    if (it != shard.leases.end() && it->second.expires_at > now) {
+        result.wait = true;
+        return;
+    }
+    Lease& lease = shard.leases[key];
+    lease.token = ++next_lease_token_;
+    lease.expires_at = now + lease_ttl;
+    result.token = lease.token;
+}
+
+/**
+ * 租约写入
+ * 租约在键被写入或删除时失效，回源期间键已被修改时迟到的旧值不会覆盖新值
+ * @param key 缓存键
+ * @param value 缓存值
+ * @param token 租约令牌
+ * @return 租约有效并已写入时返回true
+ */
+bool LocalStore::leaseSet(const std::string& key, const std::string& value, uint64_t token) {
+    auto now = std::chrono::steady_clock::now();
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.leases.find(key);
+    if (token == 0 || it == shard.leases.end() || it->second.token != token || it->second.expires_at <= now) {
+        return false;
+    }
+    shard.leases.erase(it);
+    CacheEntry* old = findEntry(shard, key);
+    size_t before = old ? entryBytes(key, *old) : 0;
+    CacheEntry& entry = old ? *old : insertEntry(shard, key);
+    dispose(entry);
+    entry = CacheEntry(value, EntryTtl(), 0);
+    entry.version = ++next_version_;
+    entry.accessed_at = CacheEntry::accessTick(CacheEntry::nowNanos());
+    charge(shard, key, before, entryBytes(key, entry));
+    return true;
+}
+
+/**
+ * 清理已经过期的租约
+ * 持有者回源失败或放弃写入时，租约在这里被回收
+ */
+void LocalStore::purgeLeases() {
+    auto now = std::chrono::steady_clock::now();
+    for (size_t i = 0; i <= shard_mask_; i++) {
+        Shard& shard = shards_[i];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (auto it = shard.leases.begin(); it != shard.leases.end();) {
+            if (it->second.expires_at <= now) {
+                it = shard.leases.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+/**
+ * 分批清理已经硬过期的条目
+ * 逐个分片按哈希桶顺序扫描，每批最多1024个桶，批与批之间释放锁，避免长时间阻塞读写；
+ * 两批之间哈希表扩容时本轮可能漏掉部分条目，由下一轮补上
+ */
+void LocalStore::sweepExpired() {
+    const size_t buckets_per_batch = 1024;
+    std::vector<std::string> expired;
+
+    for (size_t i = 0; i <= shard_mask_; i++) {
+        Shard& shard = shards_[i];
+        if (shard.tree) {
+            sweepTree(shard);
+            continue;
+        }
+        size_t cursor = 0;
+        while (true) {
+            int64_t now = CacheEntry::nowNanos();
+            std::lock_guard<std::mutex> lock(shard.mutex);
+
+            size_t bucket_count = shard.entries.bucket_count();
+            if (cursor >= bucket_count) {
+                break;
+            }
+
+            size_t end = std::min(cursor + buckets_per_batch, bucket_count);
+            expired.clear();
+            for (size_t bucket = cursor; bucket < end; bucket++) {
+                for (auto it = shard.entries.begin(bucket); it != shard.entries.end(bucket); ++it) {
+                    if (it->second.expired(now)) {
+                        expired.push_back(it->first);
+                    }
+                }
+            }
+            for (const auto& key : expired) {
+                eraseEntry(shard, key);  // 删除不会触发重新哈希，桶编号保持不变
+            }
+            cursor = end;
+        }
+    }
+}
+
+/**
+ * 分批清理基数树索引中已经硬过期的条目
+ * 按键的顺序每批检查1024个条目，下一批从上一批最后一个键之后继续，批与批之间释放锁
+ * @param shard 分片（调用方不持有其锁）
+ */
+void LocalStore::sweepTree(Shard& shard) {
+    const size_t entries_per_batch = 1024;
+    std::vector<std::string> expired;
+    std::string start;
+
+    bool more = true;
+    while (more) {
+        int64_t now = CacheEntry::nowNanos();
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        expired.clear();
+        size_t visited = 0;
+        more = !shard.tree->forEachFrom(start, [&](const std::string& key, CacheEntry& entry) {
+            if (entry.expired(now)) {
+                expired.push_back(key);
+            }
+            if (++visited >= entries_per_batch) {
+                start = key + '\0';
+                return false;
+            }
+            return true;
+        });
+        for (const auto& key : expired) {
+            eraseEntry(shard, key);
+        }
+    }
+}
+
+/**
+ * 键数量
+ * @return 各分片键数量之和
+ */
+size_t LocalStore::size() {
+    size_t total = 0;
+    for (size_t i = 0; i <= shard_mask_; i++) {
+        std::lock_guard<std::mutex> lock(shards_[i].mutex);
+        total += shards_[i].tree ? shards_[i].tree->size() : shards_[i].entries.size();
+    }
+    return total;
+}
+
+/**
+ * 创建命名空间或修改其配额
+ * 新建时逐个分片加锁，把已有的同前缀键的用量从默认命名空间转入，再登记到分片上；
+ * 同一把锁内完成，转入期间的写入不会被重复计算
+ * @param name 命名空间名称
+ * @param quota_bytes 内存配额，0表示不限制
+ * @return 名称无效时返回false
+ */
+bool LocalStore::setNamespace(const std::string& name, uint64_t quota_bytes) {
+    if (name == kDefaultNamespace) {
+        default_namespace_->quota_bytes = quota_bytes;
+        return true;
+    }
+    if (name.empty() || name[0] == '_' || name.find(':') != std::string::npos) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> admin(namespaces_mutex_);
+    auto it = namespaces_.find(name);
+    if (it != namespaces_.end()) {
+        it->second->quota_bytes = quota_bytes;
+        return true;
+    }
+
+    std::unique_ptr<Namespace> created = newNamespace(name, quota_bytes);
+    Namespace* ns = created.get();
+    namespaces_.emplace(name, std::move(created));
+
+    const std::string prefix = name + ":";
+    for (size_t i = 0; i <= shard_mask_; i++) {
+        Shard& shard = shards_[i];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        int64_t bytes = 0;
+        int64_t keys = 0;
+        auto count = [&](const std::string& key, const CacheEntry& entry) {
+            bytes += static_cast<int64_t>(entryBytes(key, entry));
+            keys++;
+        };
+        if (shard.tree) {
+            shard.tree->forEachFrom(prefix, [&](const std::string& key, CacheEntry& entry) {
+                if (key.compare(0, prefix.size(), prefix) != 0) {
+                    return false;
+                }
+                count(key, entry);
+                return true;
+            });
+        } else {
+            for (const auto& entry : shard.entries) {
+                if (entry.first.compare(0, prefix.size(), prefix) == 0) {
+                    count(entry.first, entry.second);
+                }
+            }
+        }
+
+        default_namespace_->usage[i].bytes -= bytes;
+        default_namespace_->usage[i].keys -= keys;
+        ns->usage[i].bytes += bytes;
+        ns->usage[i].keys += keys;
+        shard.namespaces[name] = ns;
+    }
+    return true;
+}
+
+/**
+ * 删除命名空间
+ * 逐个分片加锁注销，并把该分片上的用量转回默认命名空间；所有分片注销后才释放命名空间对象，
+ * 此时已经没有持锁的操作能看到它
+ * @param name 命名空间名称
+ * @return 命名空间存在时返回true
+ */
+bool LocalStore::removeNamespace(const std::string& name) {
+    std::lock_guard<std::mutex> admin(namespaces_mutex_);
+    auto it = namespaces_.find(name);
+    if (it == namespaces_.end()) {
+        return false;
+    }
+
+    Namespace* ns = it->second.get();
+    for (size_t i = 0; i <= shard_mask_; i++) {
+        Shard& shard = shards_[i];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.namespaces.erase(name);
+        default_namespace_->usage[i].bytes += ns->usage[i].bytes.load();
+        default_namespace_->usage[i].keys += ns->usage[i].keys.load();
+    }
+    namespaces_.erase(it);
+    return true;
+}
+
+/**
+ * 各命名空间的统计
+ * 按分片累加，不加分片锁，各分片的数值不是同一时刻的快照
+ * @return 统计列表，默认命名空间在最前，其余按名称排序
+ */
+std::vector<NamespaceStats> LocalStore::namespaceStats() {
+    std::vector<const Namespace*> list;
+    std::lock_guard<std::mutex> admin(namespaces_mutex_);
+    for (const auto& entry : namespaces_) {
+        list.push_back(entry.second.get());
+    }
+    std::sort(list.begin(), list.end(), [](const Namespace* a, const Namespace* b) { return a->name < b->name; });
+    list.insert(list.begin(), default_namespace_.get());
+
+    std::vector<NamespaceStats> stats;
+    for (const Namespace* ns : list) {
+        NamespaceStats item;
+        item.name = ns->name;
+        item.quota_bytes = ns->quota_bytes.load();
+        item.bytes = 0;
+        item.keys = 0;
+        item.hits = 0;
+        item.misses = 0;
+        item.evictions = 0;
+        for (size_t i = 0; i <= shard_mask_; i++) {
+            const NamespaceUsage& usage = ns->usage[i];
+            item.bytes += usage.bytes.load(std::memory_order_relaxed);
+            item.keys += usage.keys.load(std::memory_order_relaxed);
+            item.hits += usage.hits.load(std::memory_order_relaxed);
+            item.misses += usage.misses.load(std::memory_order_relaxed);
+            item.evictions += usage.evictions.load(std::memory_order_relaxed);
+        }
+        stats.push_back(item);
+    }
+    return stats;
+}
+
+/**
+ * 淘汰超出配额的命名空间中的键
+ * 对每个超出配额的命名空间轮流在各分片上淘汰，每次加锁最多淘汰kEvictionsPerWrite个键，
+ * 各分片按相同的节奏淘汰，不会先把某一个分片上的键（包括常用的键）淘汰光；
+ * 一整轮都没有淘汰掉任何键时停止
+ */
+void LocalStore::enforceQuotas() {
+    std::vector<Namespace*> list;
+    std::lock_guard<std::mutex> admin(namespaces_mutex_);   // 期间命名空间不会被删除
+    list.push_back(default_namespace_.get());
+    for (const auto& entry : namespaces_) {
+        list.push_back(entry.second.get());
+    }
+
+    for (Namespace* ns : list) {
+        bool progress = true;
+        while (progress) {
+            uint64_t quota = ns->quota_bytes.load();
+            if (quota == 0 || namespaceBytes(*ns) <= static_cast<int64_t>(quota)) {
+                break;
+            }
+            progress = false;
+            for (size_t i = 0; i <= shard_mask_; i++) {
+                std::lock_guard<std::mutex> lock(shards_[i].mutex);
+                if (evict(shards_[i], *ns, std::unordered_set<std::string>(), kEvictionsPerWrite) > 0) {
+                    progress = true;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * 按游标分批遍历键
+ * @param cursor 游标，"0"表示从头开始
+ * @param count 本次最多检查的条目数
+ * @param match glob模式，为空时不过滤
+ * @param keys 输出参数，追加本次找到的键
+ * @param next 输出参数，下一次的游标，遍历结束时为"0"
+ * @return 游标格式不正确时返回false
+ */
+bool LocalStore::scan(const std::string& cursor, size_t count, const std::string& match,
+                      std::vector<std::string>& keys, std::string& next) {
+    return scanBatch(cursor, count, match, false, keys, next);
+}
+
+/**
+ * 按游标分批删除匹配的键
+ * 每次调用只持有一个分片的锁，检查最多count个条目，批与批之间其他请求可以正常读写
+ * @param cursor 游标，"0"表示从头开始
+ * @param count 本次最多检查的条目数
+ * @param match glob模式，为空时删除全部
+ * @param keys 输出参数，追加本次删除的键
+ * @param next 输出参数，下一次的游标，删除结束时为"0"
+ * @return 游标格式不正确时返回false
+ */
+bool LocalStore::deleteMatching(const std::string& cursor, size_t count, const std::string& match,
+                                std::vector<std::string>& keys, std::string& next) {
+    return scanBatch(cursor, count, match, true, keys, next);
+}
+
+/**
+ * 按游标分批遍历键，erase为true时同时删除找到的键
+ * 基数树索引的游标为"分片.k十六进制键"，按键的顺序从上次最后一个键之后继续，插入和删除都不影响续扫，
+ * 有字面前缀的模式直接从前缀处开始、越过前缀即结束。
+ * 哈希表索引的游标格式为"分片.桶.桶数量"。std::unordered_map只在插入时扩容且不会缩容，
+ * 桶数量不变时桶下标可以直接续用；变了说明扩容过，键被重新分布到新的桶里，只能从头扫描该分片。
+ * 扩容每次至少翻倍，同一个分片的重扫次数是对数级的
+ * @param cursor 游标，"0"表示从头开始
+ * @param count 本次最多检查的条目数
+ * @param match glob模式，为空时不过滤
+ * @param erase 是否删除找到的键。删除在同一把锁内完成，不会引起哈希表重新哈希，游标不受影响
+ * @param keys 输出参数，追加本次找到的键
+ * @param next 输出参数，下一次的游标，遍历结束时为"0"
+ * @return 游标格式不正确时返回false
+ */
+bool LocalStore::scanBatch(const std::string& cursor, size_t count, const std::string& match, bool erase,
+                           std::vector<std::string>& keys, std::string& next) {
+    size_t shard_index = 0;
+    size_t bucket = 0;
+    size_t cursor_buckets = 0;
+    std::string resume_key;   // 基数树索引：上次最后检查的键，从它之后继续
+    bool resume = false;
+    if (cursor != "0") {
+        const char* begin = cursor.c_str();
+        char* end = nullptr;
+        errno = 0;
+        shard_index = std::strtoull(begin, &end, 10);
+        if (errno != 0 || end == begin || *end != '.' || shard_index > shard_mask_) {
+            return false;
+        }
+        begin = end + 1;
+
+        if (*begin == 'k') {
+            if (!shards_[shard_index].tree || !fromHex(begin + 1, resume_key)) {
+                return false;
+            }
+            resume = true;
+        } else {
+            size_t parts[2];
+            for (int i = 0; i < 2; i++) {
+                errno = 0;
+                parts[i] = std::strtoull(begin, &end, 10);
+                char expected = i == 0 ? '.' : '\0';
+                if (errno != 0 || end == begin || *end != expected) {
+                    return false;
+                }
+                begin = end + 1;
+            }
+            bucket = parts[0];
+            cursor_buckets = parts[1];
+        }
+    }
+    // 基数树按键有序，模式的字面前缀之前和之后的键都不用看
+    std::string literal = globPrefix(match);
+
+    count = std::min(std::max<size_t>(count, 1), kMaxScanCount);
+    // 空桶也算工作量，避免稀疏的表在一次调用里扫过大量空桶
+    const size_t max_buckets = count * 10;
+    size_t examined = 0;
+    size_t visited = 0;
+
+    for (; shard_index <= shard_mask_; shard_index++) {
+        if (examined >= count || visited >= max_buckets) {
+            next = std::to_string(shard_index) + ".0.0";
+            return true;
+        }
+
+        Shard& shard = shards_[shard_index];
+        int64_t now = CacheEntry::nowNanos();
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        size_t found = keys.size();   // 本分片找到的键从这里开始
+
+        if (shard.tree) {
+            // 比上次最后一个键大的最小字符串是在它后面加一个零字节
+            std::string start = literal;
+            if (resume && resume_key + '\0' > start) {
+                start = resume_key + '\0';
+            }
+            resume = false;
+
+            bool stopped = false;
+            std::string last;
+            shard.tree->forEachFrom(start, [&](const std::string& key, CacheEntry& entry) {
+                if (key.compare(0, literal.size(), literal) != 0) {
+                    return false;  // 超出字面前缀的范围，本分片已经遍历完
+                }
+                examined++;
+                if (!entry.expired(now) && (match.empty() || globMatch(match, key))) {
+                    keys.push_back(key);
+                }
+                if (examined >= count) {
+                    last = key;
+                    stopped = true;
+                    return false;
+                }
+                return true;
+            });
+            if (erase) {
+                eraseKeys(shard, keys, found);
+            }
+            if (stopped) {
+                next = std::to_string(shard_index) + ".k" + toHex(last);
+                return true;
+            }
+            continue;
+        }
+
+        size_t bucket_count = shard.entries.bucket_count();
+        if (cursor_buckets != bucket_count) {
+            // 上次调用之后扩容过（或者是新分片），从头扫描
+            bucket = 0;
+        }
+        for (; bucket < bucket_count && examined < count && visited < max_buckets; bucket++, visited++) {
+            for (auto it = shard.entries.begin(bucket); it != shard.entries.end(bucket); ++it) {
+                examined++;
+                if (!it->second.expired(now) && (match.empty() || globMatch(match, it->first))) {
+                    keys.push_back(it->first);
+                }
+            }
+        }
+        if (erase) {
+            eraseKeys(shard, keys, found);
+        }
+        if (bucket < bucket_count) {
+            next = std::to_string(shard_index) + "." + std::to_string(bucket) + "." + std::to_string(bucket_count);
+            return true;
+        }
+        bucket = 0;
+        cursor_buckets = 0;
+    }
+
+    next = "0";
+    return true;
+}
+
+/**
+ * 检查字符串是否匹配glob模式
+ * 遇到*时记下位置，后续不匹配时回到最近的*多吞一个字符，最坏情况为O(模式长度*字符串长度)
+ * @param pattern glob模式
+ * @param text 要检查的字符串
+ * @return 是否匹配
+ */
+bool LocalStore::globMatch(const std::string& pattern, const std::string& text) {
+    size_t p = 0;
+    size_t t = 0;
+    size_t star_p = std::string::npos;
+    size_t star_t = 0;
+
+    while (t < text.size()) {
+        if (p < pattern.size()) {
+            char pc = pattern[p];
+            if (pc == '*') {
+                star_p = ++p;
+                star_t = t;
+                continue;
+            }
+
+            size_t after = p;
+            bool matched;
+            if (pc == '?') {
+                matched = true;
+                after = p + 1;
+            } else if (pc == '[') {
+                matched = matchClass(pattern, after, text[t]);
+            } else {
+                if (pc == '\\' && p + 1 < pattern.size()) {
+                    after++;
+                }
+                matched = pattern[after] == text[t];
+                after++;
+            }
+            if (matched) {
+                p = after;
+                t++;
+                continue;
+            }
+        }
+        if (star_p == std::string::npos) {
+            return false;
+        }
+        // 回到最近的*，让它多匹配一个字符
+        p = star_p;
+        t = ++star_t;
+    }
+
+    while (p < pattern.size() && pattern[p] == '*') {
+        p++;
+    }
+    return p == pattern.size();
+}
+
+/**
+ * 匹配glob模式中的一个字符类
+ * 支持[abc]、[a-z]、[^abc]和类中的\转义；缺少']'时字符类延续到模式末尾
+ * @param pattern glob模式
+ * @param pos 输入'['的位置，输出字符类之后的位置
+ * @param c 要匹配的字符
+ * @return 是否匹配
+ */
+bool LocalStore::matchClass(const std::string& pattern, size_t& pos, char c) {
+    size_t p = pos + 1;
+    bool negate = p < pattern.size() && pattern[p] == '^';
+    if (negate) {
+        p++;
+    }
+
+    bool matched = false;
+    while (p < pattern.size() && pattern[p] != ']') {
+        if (pattern[p] == '\\' && p + 1 < pattern.size()) {
+            matched = matched || pattern[p + 1] == c;
+            p += 2;
+        } else if (p + 2 < pattern.size() && pattern[p + 1] == '-' && pattern[p + 2] != ']') {
+            unsigned char low = pattern[p];
+            unsigned char high = pattern[p + 2];
+            if (low > high) {
+                std::swap(low, high);
+            }
+            unsigned char value = c;
+            matched = matched || (value >= low && value <= high);
+            p += 3;
+        } else {
+            matched = matched || pattern[p] == c;
+            p++;
+        }
+    }
+    if (p < pattern.size()) {
+        p++;  // 跳过']'
+    }
+    pos = p;
+    return matched != negate;
+}
+
+/**
+ * 获取键所在的分片
+ * @param key 缓存键
+ * @return 分片
+ */
+LocalStore::Shard& LocalStore::shardFor(const std::string& key) {
+    return shards_[shardOf(key)];
+}
+
+/**
+ * 键所在的分片编号
+ * @param key 缓存键
+ * @return 分片编号
+ */
+size_t LocalStore::shardOf(const std::string& key) const {
+    return KeyHash::mix(key) & shard_mask_;
+}
+
+/**
+ * 提取glob模式开头不含通配符的部分
+ * @param pattern glob模式
+ * @return 所有匹配的字符串共同的前缀
+ */
+std::string LocalStore::globPrefix(const std::string& pattern) {
+    std::string literal;
+    for (size_t i = 0; i < pattern.size(); i++) {
+        char c = pattern[i];
+        if (c == '*' || c == '?' || c == '[') {
+            break;
+        }
+        if (c == '\\' && i + 1 < pattern.size()) {
+            c = pattern[++i];
+        }
+        literal.push_back(c);
+    }
+    return literal;
+}
+
+/**
+ * 把键编码为十六进制，用于游标
+ * @param bytes 原始字节
+ * @return 十六进制字符串
+ */
+std::string LocalStore::toHex(const std::string& bytes) {
+    static const char digits[] = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(bytes.size() * 2);
+    for (unsigned char c : bytes) {
+        hex.push_back(digits[c >> 4]);
+        hex.push_back(digits[c & 0xf]);
+    }
+    return hex;
+}
+
+/**
+ * 解码十六进制字符串
+ * @param hex 十六进制字符串
+ * @param bytes 输出参数，原始字节
+ * @return 格式正确时返回true
+ */
+bool LocalStore::fromHex(const std::string& hex, std::string& bytes) {
+    if (hex.size() % 2 != 0) {
+        return false;
+    }
+    bytes.clear();
+    for (size_t i = 0; i < hex.size(); i += 2) {
+        int value = 0;
+        for (size_t j = i; j < i + 2; j++) {
+            char c = hex[j];
+            int digit;
+            if (c >= '0' && c <= '9') {
+                digit = c - '0';
+            } else if (c >= 'a' && c <= 'f') {
+                digit = c - 'a' + 10;
+            } else {
+                return false;
+            }
+            value = value * 16 + digit;
+        }
+        bytes.push_back(static_cast<char>(value));
+    }
+    return true;
+}
+
+/**
+ * 查找未硬过期的条目，找到时记录访问时间供配额淘汰使用
+ * @param shard 分片（调用方持有其锁）
+ * @param key 缓存键
+ * @param now 当前时间
+ * @return 条目指针，不存在或已硬过期时为空
+ */
+CacheEntry* LocalStore::findLive(Shard& shard, const std::string& key, int64_t now) {
+    CacheEntry* entry = findEntry(shard, key);
+    if (!entry) {
+        return nullptr;
+    }
+    if (entry->expired(now)) {
+        eraseEntry(shard, key);
+        return nullptr;
+    }
+    entry->accessed_at = CacheEntry::accessTick(now);
+    return entry;
+}
+
+/**
+ * 查找条目
+ * @param shard 分片（调用方持有其锁）
+ * @param key 缓存键
+ * @return 条目指针，不存在时为空
+ */
+CacheEntry* LocalStore::findEntry(Shard& shard, const std::string& key) {
+    if (shard.tree) {
+        return shard.tree->find(key);
+    }
+    auto it = shard.entries.find(key);
+    return it == shard.entries.end() ? nullptr : &it->second;
+}
+
+/**
+ * 查找条目，不存在时插入默认构造的条目
+ * @param shard 分片（调用方持有其锁）
+ * @param key 缓存键
+ * @return 条目
+ */
+CacheEntry& LocalStore::insertEntry(Shard& shard, const std::string& key) {
+    if (shard.tree) {
+        return shard.tree->findOrInsert(key);
+    }
+    return shard.entries[key];
+}
+
+/**
+ * 删除条目
+ * 先从命名空间扣除用量，再取出旧值或把值交给dispose，大值的释放不计入持锁时间
+ * @param shard 分片（调用方持有其锁）
+ * @param key 缓存键
+ * @param old_value 输出参数（可为空），被删除的值；交给后台释放的大值不输出
+ */
+void LocalStore::eraseEntry(Shard& shard, const std::string& key, std::string* old_value) {
+    CacheEntry* entry = findEntry(shard, key);
+    if (!entry) {
+        return;
+    }
+    charge(shard, key, entryBytes(key, *entry), 0);
+    if (old_value && !lazyFreeable(*entry)) {
+        *old_value = entry->hash ? entry->hash->toJson() : std::move(entry->value);
+    }
+    dispose(*entry);
+    if (shard.tree) {
+        shard.tree->erase(key);
+    } else {
+        shard.entries.erase(key);
+    }
+}
+
+/**
+ * 删除一批键及其租约
+ * @param shard 分片（调用方持有其锁）
+ * @param keys 缓存键
+ * @param from 从keys的这个下标开始删除
+ */
+void LocalStore::eraseKeys(Shard& shard, const std::vector<std::string>& keys, size_t from) {
+    for (size_t i = from; i < keys.size(); i++) {
+        eraseEntry(shard, keys[i]);
+        shard.leases.erase(keys[i]);
+    }
+}
+
+/**
+ * 释放条目占用的值
+ * 移交只是把条目移进队列，锁内的开销是常数
+ * @param entry 条目（调用方持有其分片的锁）
+ */
+void LocalStore::dispose(CacheEntry& entry) {
+    if (lazyFreeable(entry)) {
+        freer_->retire(std::move(entry));
+    }
+}
+
+/**
+ * 条目是否应该交给后台释放
+ * 字符串值按容量判断；哈希类型的紧凑编码大小有上限，只有转成表结构之后才算大值
+ * @param entry 条目
+ * @return 启用了惰性释放且条目是大值时返回true
+ */
+bool LocalStore::lazyFreeable(const CacheEntry& entry) const {
+    if (!freer_) {
+        return false;
+    }
+    return entry.value.capacity() >= lazy_free_bytes_ || (entry.hash && !entry.hash->compact());
+}
+
+/**
+ * 创建命名空间对象
+ * @param name 名称
+ * @param quota_bytes 内存配额
+ * @return 命名空间
+ */
+std::unique_ptr<LocalStore::Namespace> LocalStore::newNamespace(const std::string& name, uint64_t quota_bytes) {
+    auto ns = std::make_unique<Namespace>();
+    ns->name = name;
+    ns->quota_bytes = quota_bytes;
+    ns->usage.reset(new NamespaceUsage[shard_mask_ + 1]);
+    return ns;
+}
+
+/**
+ * 键所属的命名空间
+ * 没有创建任何命名空间时不解析键，直接返回默认命名空间
+ * @param shard 键所在的分片（调用方持有其锁）
+ * @param key 缓存键
+ * @return 命名空间
+ */
+LocalStore::Namespace* LocalStore::namespaceOf(Shard& shard, const std::string& key) {
+    if (shard.namespaces.empty()) {
+        return default_namespace_.get();
+    }
+    size_t colon = key.find(':');
+    if (colon == std::string::npos) {
+        return default_namespace_.get();
+    }
+    auto it = shard.namespaces.find(key.substr(0, colon));
+    return it == shard.namespaces.end() ? default_namespace_.get() : it->second;
+}
+
+/**
+ * 条目占用的内存（估算）
+ * 字符串值按长度计算，哈希类型按HashValue::bytes计算；键和条目结构各算一份
+ * @param key 缓存键
+ * @param entry 条目
+ * @return 字节数
+ */
+size_t LocalStore::entryBytes(const std::string& key, const CacheEntry& entry) {
+    size_t value_bytes = entry.hash ? entry.hash->bytes() : entry.value.size();
+    return key.size() + sizeof(CacheEntry) + value_bytes;
+}
+
+/**
+ * 命名空间在所有分片上占用的内存之和
+ * @param ns 命名空间
+ * @return 字节数
+ */
+int64_t LocalStore::namespaceBytes(const Namespace& ns) const {
+    int64_t total = 0;
+    for (size_t i = 0; i <= shard_mask_; i++) {
+        total += ns.usage[i].bytes.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+/**
+ * 把条目的大小变化计入所属命名空间
+ * 只有变大的写入会触发淘汰，删除和缩小不会
+ * @param shard 分片（调用方持有其锁）
+ * @param key 缓存键
+ * @param before 修改前的大小，新键为0
+ * @param after 修改后的大小，删除为0
+ */
+void LocalStore::charge(Shard& shard, const std::string& key, size_t before, size_t after) {
+    if (Namespace* ns = account(shard, key, before, after)) {
+        evict(shard, *ns, std::unordered_set<std::string>{key}, kEvictionsPerWrite);
+    }
+}
+
+/**
+ * 只把条目的大小变化计入所属命名空间
+ * @param shard 分片（调用方持有其锁）
+ * @param key 缓存键
+ * @param before 修改前的大小，新键为0
+ * @param after 修改后的大小，删除为0
+ * @return 需要淘汰时返回所属命名空间
+ */
+LocalStore::Namespace* LocalStore::account(Shard& shard, const std::string& key, size_t before, size_t after) {
+    Namespace* ns = namespaceOf(shard, key);
+    NamespaceUsage& usage = ns->usage[shard.index];
+    usage.bytes.fetch_add(static_cast<int64_t>(after) - static_cast<int64_t>(before), std::memory_order_relaxed);
+    int64_t key_delta = (after > 0 ? 1 : 0) - (before > 0 ? 1 : 0);
+    if (key_delta != 0) {
+        usage.keys.fetch_add(key_delta, std::memory_order_relaxed);
+    }
+
+    uint64_t quota = ns->quota_bytes.load(std::memory_order_relaxed);
+    if (after > before && quota != 0 && namespaceBytes(*ns) > static_cast<int64_t>(quota)) {
+        return ns;
+    }
+    return nullptr;
+}
+
+/**
+ * 在一个分片上淘汰命名空间中的键
+ * 每次抽样选出最久未访问的一个键删除，回到配额以内或达到limit时停止
+ * @param shard 分片（调用方持有其锁）
+ * @param ns 命名空间
+ * @param keep 不淘汰的键
+ * @param limit 最多淘汰的键数量
+ * @return 淘汰的键数量
+ */
+size_t LocalStore::evict(Shard& shard, Namespace& ns, const std::unordered_set<std::string>& keep, size_t limit) {
+    size_t evicted = 0;
+    std::string victim;
+    while (evicted < limit) {
+        uint64_t quota = ns.quota_bytes.load(std::memory_order_relaxed);
+        if (quota == 0 || namespaceBytes(ns) <= static_cast<int64_t>(quota)) {
+            break;
+        }
+        if (!sampleVictim(shard, ns, keep, victim)) {
+            break;  // 本分片上没有可以淘汰的键
+        }
+        eraseEntry(shard, victim);
+        shard.leases.erase(victim);
+        ns.usage[shard.index].evictions.fetch_add(1, std::memory_order_relaxed);
+        evicted++;
+    }
+    return evicted;
+}
+
+/**
+ * 抽样选出命名空间中最久未访问的键（近似LRU）
+ * 哈希表索引从随机的桶开始顺序检查。基数树索引中命名空间的键是连续且有序的，随机起点会偏向
+ * 某些分支，因此从上次抽样结束的位置继续，到达前缀末尾后绕回前缀开头，像时钟指针一样轮流覆盖所有键。
+ * 默认命名空间的键分散在整个分片中，两种索引都可能检查更多无关条目
+ * @param shard 分片（调用方持有其锁）
+ * @param ns 命名空间
+ * @param keep 不选择的键
+ * @param victim 输出参数，选中的键
+ * @return 找到候选键时返回true
+ */
+bool LocalStore::sampleVictim(Shard& shard, Namespace& ns, const std::unordered_set<std::string>& keep,
+                              std::string& victim) {
+    // xorshift64
+    shard.random ^= shard.random << 13;
+    shard.random ^= shard.random >> 7;
+    shard.random ^= shard.random << 17;
+    uint64_t random = shard.random;
+
+    uint32_t now = CacheEntry::accessTick(CacheEntry::nowNanos());
+    size_t samples = 0;
+    size_t examined = 0;
+    uint32_t oldest = 0;
+    auto consider = [&](const std::string& key, const CacheEntry& entry) {
+        examined++;
+        if (keep.count(key) || namespaceOf(shard, key) != &ns) {
+            return;
+        }
+        uint32_t age = now - entry.accessed_at;   // 无符号减法，时钟回绕不影响
+        if (samples == 0 || age > oldest) {
+            oldest = age;
+            victim = key;
+        }
+        samples++;
+    };
+    auto done = [&]() { return samples >= kEvictionSamples || examined >= kEvictionScanLimit; };
+
+    if (shard.tree) {
+        std::string prefix = &ns == default_namespace_.get() ? std::string() : ns.name + ":";
+        std::string& from = ns.usage[shard.index].evict_from;
+        std::string start = from > prefix ? from : prefix;
+        bool wrapped = false;
+        auto visit = [&](const std::string& key, CacheEntry& entry) {
+            if (key.compare(0, prefix.size(), prefix) != 0 || (wrapped && key >= start)) {
+                return false;
+            }
+            consider(key, entry);
+            if (done()) {
+                from = key + '\0';
+                return false;
+            }
+            return true;
+        };
+        if (shard.tree->forEachFrom(start, visit) || !done()) {
+            // 到达前缀末尾，绕回前缀开头检查起点之前的键
+            from = prefix;
+            wrapped = true;
+            shard.tree->forEachFrom(prefix, visit);
+        }
+        return samples > 0;
+    }
+
+    size_t bucket_count = shard.entries.bucket_count();
+    size_t first = static_cast<size_t>(random % bucket_count);
+    for (size_t i = 0; i < bucket_count && !done(); i++) {
+        size_t bucket = (first + i) % bucket_count;
+        for (auto it = shard.entries.begin(bucket); it != shard.entries.end(bucket); ++it) {
+            consider(it->first, it->second);
+        }
+    }
+    return samples > 0;
+}
+
+/**
+ * 查找未硬过期的条目，不存在时创建空值条目
+ * @param shard 分片（调用方持有其锁）
+ * @param key 缓存键
+ * @param now 当前时间
+ * @return 条目
+ */
+CacheEntry& LocalStore::findOrCreate(Shard& shard, const std::string& key, int64_t now) {
+    CacheEntry* entry = findLive(shard, key, now);
+    if (entry) {
+        return *entry;
+    }
+    CacheEntry& created = insertEntry(shard, key);
+    created = CacheEntry(std::string(), EntryTtl(), now);
+    return created;
+}
+
+/**
+ * 按分片编号从小到大锁住一组键涉及的所有分片
+ * @param keys 缓存键
+ * @return 持有的锁
+ */
+std::vector<std::unique_lock<std::mutex>> LocalStore::lockShards(const std::vector<std::string>& keys) {
+    std::vector<size_t> indexes;
+    indexes.reserve(keys.size());
+    for (const auto& key : keys) {
+        indexes.push_back(static_cast<size_t>(&shardFor(key) - shards_.get()));
+    }
+    std::sort(indexes.begin(), indexes.end());
+    indexes.erase(std::unique(indexes.begin(), indexes.end()), indexes.end());
+
+    std::vector<std::unique_lock<std::mutex>> locks;
+    locks.reserve(indexes.size());
+    for (size_t index : indexes) {
+        locks.emplace_back(shards_[index].mutex);
+    }
+    return locks;
+}
\ No newline at end of file
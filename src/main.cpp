@@ -22,6 +22,25 @@ void signalHandler(int signal) {
     exit(0); // 退出程序
 }
 
+/**
+ * 从环境变量读取整数配置
+ * @param name 环境变量名
+ * @param default_value 环境变量不存在或无效时使用的默认值
+ * @return 配置值
+ */
+int envInt(const char* name, int default_value) {
+    const char* value = std::getenv(name);
+    if (!value) {
+        return default_value;
+    }
+    try {
+        return std::stoi(value);
+    } catch (const std::exception& e) {
+        std::cerr << "环境变量 " << name << " 的值无效，使用默认值 " << default_value << std::endl;
+        return default_value;
+    }
+}
+
 /**
  * 设置集群配置函数
  * @param server 当前服务器实例指针
@@ -89,6 +108,42 @@ int main(int argc, char* argv[]) {
         return 1;  // 退出程序
     }
     
+    // 从环境变量读取运行配置
+    ServerOptions options;
+    options.http.max_connections = envInt("HTTP_MAX_CONNECTIONS", options.http.max_connections);
+    options.http.worker_threads = envInt("HTTP_WORKER_THREADS", options.http.worker_threads);
+    options.http.max_queue = envInt("HTTP_MAX_QUEUE", options.http.max_queue);
+    options.http.queue_timeout_ms = envInt("HTTP_QUEUE_TIMEOUT_MS", options.http.queue_timeout_ms);
+    options.http.address_rate = envInt("RATE_LIMIT_ADDRESS", options.http.address_rate);
+    options.http.address_burst = envInt("RATE_LIMIT_ADDRESS_BURST", options.http.address_burst);
+    options.http.api_key_rate = envInt("RATE_LIMIT_API_KEY", options.http.api_key_rate);
+    options.http.api_key_burst = envInt("RATE_LIMIT_API_KEY_BURST", options.http.api_key_burst);
+    options.http.namespace_rate = envInt("RATE_LIMIT_NAMESPACE", options.http.namespace_rate);
+    options.http.namespace_burst = envInt("RATE_LIMIT_NAMESPACE_BURST", options.http.namespace_burst);
+    options.grpc_max_threads = envInt("GRPC_MAX_THREADS", options.grpc_max_threads);
+    options.hot_key_capacity = envInt("HOT_KEY_CAPACITY", options.hot_key_capacity);
+    options.hot_key_sample_rate = envInt("HOT_KEY_SAMPLE_RATE", options.hot_key_sample_rate);
+    options.hot_key_replication = envInt("HOT_KEY_REPLICATION", options.hot_key_replication ? 1 : 0) != 0;
+    options.replica_ttl_ms = envInt("REPLICA_TTL_MS", options.replica_ttl_ms);
+    options.replication_interval_ms = envInt("REPLICATION_INTERVAL_MS", options.replication_interval_ms);
+    options.replica_min_count = envInt("REPLICA_MIN_COUNT", options.replica_min_count);
+    options.near_cache = envInt("NEAR_CACHE", options.near_cache ? 1 : 0) != 0;
+    options.near_cache_ttl_ms = envInt("NEAR_CACHE_TTL_MS", options.near_cache_ttl_ms);
+    options.near_cache_capacity = envInt("NEAR_CACHE_CAPACITY", options.near_cache_capacity);
+    options.negative_cache = envInt("NEGATIVE_CACHE", options.negative_cache ? 1 : 0) != 0;
+    options.negative_cache_ttl_ms = envInt("NEGATIVE_CACHE_TTL_MS", options.negative_cache_ttl_ms);
+    options.negative_cache_capacity = envInt("NEGATIVE_CACHE_CAPACITY", options.negative_cache_capacity);
+    options.lease_ttl_ms = envInt("LEASE_TTL_MS", options.lease_ttl_ms);
+    options.store_shards = envInt("STORE_SHARDS", options.store_shards);
+    options.store_art_index = envInt("STORE_ART_INDEX", options.store_art_index ? 1 : 0) != 0;
+    options.lazy_free_bytes = envInt("LAZY_FREE_BYTES", options.lazy_free_bytes);
+    options.thread_per_core = envInt("THREAD_PER_CORE", options.thread_per_core);
+    options.numa_bind = envInt("NUMA_BIND", options.numa_bind ? 1 : 0) != 0;
+    options.huge_pages = envInt("HUGE_PAGES", options.huge_pages);
+    if (const char* namespaces = std::getenv("NAMESPACES")) {
+        options.namespaces = namespaces;
+    }
+    
     // 输出服务器启动信息
     std::cout << "正在启动缓存服务器..." << std::endl;
     std::cout << "节点ID: " << node_id << std::endl;
@@ -97,7 +152,7 @@ int main(int argc, char* argv[]) {
     
     try {
         // 创建并启动服务器实例
-        server = std::make_unique<CacheServer>(node_id, host, grpc_port, http_port);
+        server = std::make_unique<CacheServer>(node_id, host, grpc_port, http_port, options);
         server->start();  // 启动gRPC和HTTP服务
         
         // 在后台线程中设置集群配置
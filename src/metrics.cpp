@@ -0,0 +1,404 @@
+#include "metrics.h"
+#include <iomanip>
+
+/**
+ * 直方图快照构造函数
+ * 预先分配所有桶
+ */
+HistogramSnapshot::HistogramSnapshot()
+    : counts(LatencyHistogram::kBucketCount, 0), count(0), sum(0) {}
+
+/**
+ * 计算分位数
+ * 从最小的桶开始累加，找到累计数量达到目标排名的桶
+ * @param quantile 分位点（0~1）
+ * @return 分位数对应的值（纳秒）
+ */
+uint64_t HistogramSnapshot::valueAtQuantile(double quantile) const {
+    if (count == 0) {
+        return 0;
+    }
+
+    uint64_t rank = static_cast<uint64_t>(quantile * count);
+    if (rank >= count) {
+        rank = count - 1;
+    }
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen > rank) {
+            return LatencyHistogram::bucketUpperBound(static_cast<int>(i));
+        }
+    }
+    return LatencyHistogram::bucketUpperBound(LatencyHistogram::kBucketCount - 1);
+}
+
+/**
+ * 统计小于等于给定值的样本数
+ * 桶上界不超过给定值的桶全部计入，用于生成Prometheus的le桶
+ * @param value_ns 上界（纳秒）
+ * @return 样本数
+ */
+uint64_t HistogramSnapshot::countAtOrBelow(uint64_t value_ns) const {
+    uint64_t total = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        if (LatencyHistogram::bucketUpperBound(static_cast<int>(i)) > value_ns) {
+            break;
+        }
+        total += counts[i];
+    }
+    return total;
+}
+
+/**
+ * 延迟直方图构造函数
+ * 所有桶计数清零
+ */
+LatencyHistogram::LatencyHistogram() : sum_(0) {
+    for (auto& count : counts_) {
+        count.store(0, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * 记录一个样本
+ * 只有两次relaxed原子加法，不加锁
+ * @param value_ns 样本值（纳秒）
+ */
+void LatencyHistogram::record(uint64_t value_ns) {
+    counts_[bucketIndex(value_ns)].fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value_ns, std::memory_order_relaxed);
+}
+
+/**
+ * 把当前计数累加到快照中
+ * @param snapshot 目标快照
+ */
+void LatencyHistogram::mergeInto(HistogramSnapshot& snapshot) const {
+    for (int i = 0; i < kBucketCount; ++i) {
+        uint64_t count = counts_[i].load(std::memory_order_relaxed);
+        snapshot.counts[i] += count;
+        snapshot.count += count;
+    }
+    snapshot.sum += sum_.load(std::memory_order_relaxed);
+}
+
+/**
+ * 计算样本值所在的桶下标
+ * 小于16的值各占一个桶；更大的值先按最高位所在的级别分级，
+ * 再取最高位之后的4位作为级内的子桶编号
+ * @param value_ns 样本值（纳秒）
+ * @return 桶下标
+ */
+int LatencyHistogram::bucketIndex(uint64_t value_ns) {
+    if (value_ns < static_cast<uint64_t>(kSubBuckets)) {
+        return static_cast<int>(value_ns);
+    }
+
+    int exponent = 63 - __builtin_clzll(value_ns);
+    if (exponent > kMaxExponent) {
+        return kBucketCount - 1;  // 超出范围的值计入最后一个桶
+    }
+
+    int level = exponent - kSubBucketBits + 1;
+    int sub_bucket = static_cast<int>((value_ns >> (exponent - kSubBucketBits)) & (kSubBuckets - 1));
+    return level * kSubBuckets + sub_bucket;
+}
+
+/**
+ * 计算桶所能表示的最大值
+ * @param index 桶下标
+ * @return 桶上界（纳秒）
+ */
+uint64_t LatencyHistogram::bucketUpperBound(int index) {
+    if (index < kSubBuckets) {
+        return static_cast<uint64_t>(index);
+    }
+
+    int level = index / kSubBuckets;
+    int sub_bucket = index % kSubBuckets;
+    int shift = level - 1;
+    uint64_t lower = static_cast<uint64_t>(kSubBuckets + sub_bucket) << shift;
+    return lower + (1ULL << shift) - 1;
+}
+
+/**
+ * 分片构造函数
+ * 所有全局计数器清零
+ */
+Metrics::Shard::Shard() {
+    for (auto& counter : counters) {
+        counter.store(0, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * 指标注册表构造函数
+ * 预先创建所有分片，之后分片列表不再变化，读写都不需要加锁
+ */
+Metrics::Metrics() {
+    for (int i = 0; i < kShards; ++i) {
+        shards_.push_back(std::make_unique<Shard>());
+    }
+}
+
+/**
+ * 获取当前线程对应的分片
+ * 线程第一次记录指标时按轮转方式分配一个分片，之后固定使用该分片
+ * @return 分片引用
+ */
+Metrics::Shard& Metrics::localShard() {
+    static std::atomic<unsigned> next_shard(0);
+    thread_local unsigned shard_index = next_shard.fetch_add(1, std::memory_order_relaxed) % kShards;
+    return *shards_[shard_index];
+}
+
+/**
+ * 记录一次操作的耗时
+ * @param op 操作类型
+ * @param latency_ns 耗时（纳秒）
+ */
+void Metrics::recordLatency(MetricOp op, uint64_t latency_ns) {
+    localShard().ops[static_cast<int>(op)].latency.record(latency_ns);
+}
+
+/**
+ * 记录一次操作的错误
+ * @param op 操作类型
+ */
+void Metrics::recordError(MetricOp op) {
+    localShard().ops[static_cast<int>(op)].errors.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * 记录一次操作传输的字节数
+ * @param op 操作类型
+ * @param bytes_in 接收的字节数
+ * @param bytes_out 发送的字节数
+ */
+void Metrics::recordBytes(MetricOp op, uint64_t bytes_in, uint64_t bytes_out) {
+    OpStats& stats = localShard().ops[static_cast<int>(op)];
+    if (bytes_in) {
+        stats.bytes_in.fetch_add(bytes_in, std::memory_order_relaxed);
+    }
+    if (bytes_out) {
+        stats.bytes_out.fetch_add(bytes_out, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * 增加全局计数器
+ * @param counter 计数器类型
+ * @param delta 增量
+ */
+void Metrics::increment(MetricCounter counter, uint64_t delta) {
+    localShard().counters[static_cast<int>(counter)].fetch_add(delta, std::memory_order_relaxed);
+}
+
+/**
+ * 合并所有分片中某个操作的延迟直方图
+ * @param op 操作类型
+ * @return 直方图快照
+ */
+HistogramSnapshot Metrics::snapshot(MetricOp op) const {
+    HistogramSnapshot result;
+    for (const auto& shard : shards_) {
+        shard->ops[static_cast<int>(op)].latency.mergeInto(result);
+    }
+    return result;
+}
+
+/**
+ * 合并所有分片中某个全局计数器的值
+ * @param counter 计数器类型
+ * @return 计数器值
+ */
+uint64_t Metrics::counterValue(MetricCounter counter) const {
+    uint64_t total = 0;
+    for (const auto& shard : shards_) {
+        total += shard->counters[static_cast<int>(counter)].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+/**
+ * 以Prometheus文本格式输出所有指标
+ * 包括每个操作的延迟直方图和分位数、错误数、收发字节数，以及全局计数器
+ * @return Prometheus文本
+ */
+std::string Metrics::renderPrometheus() const {
+    std::ostringstream oss;
+
+    // 延迟直方图和分位数
+    std::vector<HistogramSnapshot> snapshots;
+    for (int i = 0; i < kOpCount; ++i) {
+        snapshots.push_back(snapshot(static_cast<MetricOp>(i)));
+    }
+    oss << "# HELP cache_op_duration_seconds 缓存操作耗时分布\n";
+    oss << "# TYPE cache_op_duration_seconds histogram\n";
+    for (int i = 0; i < kOpCount; ++i) {
+        appendHistogram(oss, "cache_op_duration_seconds", labelFor(static_cast<MetricOp>(i)), snapshots[i]);
+    }
+    oss << "# HELP cache_op_duration_quantile_seconds 缓存操作耗时分位数\n";
+    oss << "# TYPE cache_op_duration_quantile_seconds gauge\n";
+    for (int i = 0; i < kOpCount; ++i) {
+        appendQuantiles(oss, "cache_op_duration_quantile_seconds", labelFor(static_cast<MetricOp>(i)), snapshots[i]);
+    }
+
+    // 每个操作的错误数和收发字节数
+    const struct {
+        const char* name;
+        const char* help;
+        std::atomic<uint64_t> OpStats::*field;
+    } op_counters[] = {
+        {"cache_op_errors_total", "缓存操作失败次数", &OpStats::errors},
+        {"cache_op_bytes_in_total", "缓存操作接收的字节数", &OpStats::bytes_in},
+        {"cache_op_bytes_out_total", "缓存操作发送的字节数", &OpStats::bytes_out},
+    };
+    for (const auto& counter : op_counters) {
+        oss << "# HELP " << counter.name << " " << counter.help << "\n";
+        oss << "# TYPE " << counter.name << " counter\n";
+        for (int i = 0; i < kOpCount; ++i) {
+            uint64_t total = 0;
+            for (const auto& shard : shards_) {
+                total += (shard->ops[i].*counter.field).load(std::memory_order_relaxed);
+            }
+            oss << counter.name << "{op=\"" << opName(static_cast<MetricOp>(i)) << "\"} " << total << "\n";
+        }
+    }
+
+    // 全局计数器
+    const struct {
+        MetricCounter counter;
+        const char* name;
+        const char* help;
+    } global_counters[] = {
+        {MetricCounter::Hits, "cache_hits_total", "读取命中次数"},
+        {MetricCounter::Misses, "cache_misses_total", "读取未命中次数"},
+        {MetricCounter::LocalOps, "cache_local_ops_total", "由本节点直接处理的操作次数"},
+        {MetricCounter::Forwarded, "cache_forwarded_ops_total", "转发到其他节点的操作次数"},
+        {MetricCounter::ReplicaHits, "cache_replica_hits_total", "由热点副本直接返回的读取次数"},
+        {MetricCounter::NearHits, "cache_near_cache_hits_total", "由近端缓存直接返回的读取次数"},
+        {MetricCounter::NegativeHits, "cache_negative_cache_hits_total", "由负缓存直接返回不存在的读取次数"},
+        {MetricCounter::Coalesced, "cache_coalesced_gets_total", "合并到其他在途请求、没有单独执行的读取次数"},
+        {MetricCounter::Loads, "cache_loads_total", "本地未命中时通过加载函数读取的次数"},
+        {MetricCounter::LeasesGranted, "cache_leases_granted_total", "发放的租约数量"},
+        {MetricCounter::LeaseWaits, "cache_lease_waits_total", "租约被他人持有、被告知等待的未命中次数"},
+        {MetricCounter::LeaseRejects, "cache_lease_rejects_total", "因租约无效被拒绝的写入次数"},
+    };
+    for (const auto& counter : global_counters) {
+        oss << "# HELP " << counter.name << " " << counter.help << "\n";
+        oss << "# TYPE " << counter.name << " counter\n";
+        oss << counter.name << " " << counterValue(counter.counter) << "\n";
+    }
+
+    return oss.str();
+}
+
+/**
+ * 以Prometheus文本格式输出一个直方图
+ * 内部的细粒度桶按固定的le边界累加输出
+ * @param oss 输出流
+ * @param name 指标名称（不含后缀）
+ * @param labels 标签，例如op="get"
+ * @param snapshot 直方图快照
+ */
+void Metrics::appendHistogram(std::ostringstream& oss, const std::string& name,
+                              const std::string& labels, const HistogramSnapshot& snapshot) {
+    // le边界（秒）
+    static const double bounds[] = {
+        0.000005, 0.00001, 0.000025, 0.00005, 0.0001, 0.00025, 0.0005,
+        0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10
+    };
+    for (double bound : bounds) {
+        uint64_t bound_ns = static_cast<uint64_t>(bound * 1e9);
+        oss << name << "_bucket{" << labels << ",le=\"" << bound << "\"} "
+            << snapshot.countAtOrBelow(bound_ns) << "\n";
+    }
+    oss << name << "_bucket{" << labels << ",le=\"+Inf\"} " << snapshot.count << "\n";
+    oss << name << "_sum{" << labels << "} " << std::setprecision(9) << snapshot.sum / 1e9 << "\n";
+    oss << name << "_count{" << labels << "} " << snapshot.count << "\n";
+    oss << std::setprecision(6);
+}
+
+/**
+ * 以Prometheus文本格式输出常用分位数
+ * 从HDR直方图精确计算，便于在没有histogram_quantile查询的情况下直接查看尾延迟
+ * @param oss 输出流
+ * @param name 指标名称
+ * @param labels 标签，例如op="get"
+ * @param snapshot 直方图快照
+ */
+void Metrics::appendQuantiles(std::ostringstream& oss, const std::string& name,
+                              const std::string& labels, const HistogramSnapshot& snapshot) {
+    static const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+
+    for (double quantile : quantiles) {
+        oss << name << "{" << labels << ",quantile=\"" << quantile << "\"} "
+            << snapshot.valueAtQuantile(quantile) / 1e9 << "\n";
+    }
+}
+
+/**
+ * 生成操作类型的Prometheus标签
+ * @param op 操作类型
+ * @return 形如op="get"的标签
+ */
+std::string Metrics::labelFor(MetricOp op) {
+    return std::string("op=\"") + opName(op) + "\"";
+}
+
+/**
+ * 获取操作类型的名称
+ * @param op 操作类型
+ * @return 操作名称，用作Prometheus标签值
+ */
+const char* Metrics::opName(MetricOp op) {
+    switch (op) {
+        case MetricOp::Get: return "get";
+        case MetricOp::Set: return "set";
+        case MetricOp::Del: return "del";
+        case MetricOp::MGet: return "mget";
+        case MetricOp::Incr: return "incr";
+        case MetricOp::Cas: return "cas";
+        case MetricOp::Append: return "append";
+        case MetricOp::GetRange: return "get_range";
+        case MetricOp::SetRange: return "set_range";
+        case MetricOp::HashGet: return "hash_get";
+        case MetricOp::HashSet: return "hash_set";
+        case MetricOp::HashDel: return "hash_del";
+        case MetricOp::MultiSet: return "multi_set";
+        case MetricOp::MultiDel: return "multi_del";
+        case MetricOp::Scan: return "scan";
+        case MetricOp::DeleteMatching: return "delete_matching";
+        case MetricOp::ConfigureNamespace: return "configure_namespace";
+        case MetricOp::GetLocal: return "get_local";
+        case MetricOp::SetLocal: return "set_local";
+        case MetricOp::DelLocal: return "del_local";
+        case MetricOp::RpcGet: return "rpc_get";
+        case MetricOp::RpcSet: return "rpc_set";
+        case MetricOp::RpcDel: return "rpc_del";
+        case MetricOp::RpcMGet: return "rpc_mget";
+        case MetricOp::RpcHealth: return "rpc_health";
+        case MetricOp::RpcHotKeys: return "rpc_hot_keys";
+        case MetricOp::RpcPushReplicas: return "rpc_push_replicas";
+        case MetricOp::RpcInvalidate: return "rpc_invalidate";
+        case MetricOp::RpcLeaseGet: return "rpc_lease_get";
+        case MetricOp::RpcLeaseSet: return "rpc_lease_set";
+        case MetricOp::RpcIncr: return "rpc_incr";
+        case MetricOp::RpcCompareAndSwap: return "rpc_compare_and_swap";
+        case MetricOp::RpcAppend: return "rpc_append";
+        case MetricOp::RpcGetRange: return "rpc_get_range";
+        case MetricOp::RpcSetRange: return "rpc_set_range";
+        case MetricOp::RpcHashGet: return "rpc_hash_get";
+        case MetricOp::RpcHashSet: return "rpc_hash_set";
+        case MetricOp::RpcHashDel: return "rpc_hash_del";
+        case MetricOp::RpcMultiSet: return "rpc_multi_set";
+        case MetricOp::RpcMultiDel: return "rpc_multi_del";
+        case MetricOp::RpcScan: return "rpc_scan";
+        case MetricOp::RpcDeleteMatching: return "rpc_delete_matching";
+        case MetricOp::RpcConfigureNamespace: return "rpc_configure_namespace";
+        default: return "unknown";
+    }
+}
\ No newline at end of file
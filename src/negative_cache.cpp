@@ -0,0 +1,83 @@
+#include "negative_cache.h"
+#include "cache_entry.h"
+#include "key_hash.h"
+
+/**
+ * 负缓存构造函数
+ * @param capacity 最多保存的条目数量
+ */
+NegativeCache::NegativeCache(size_t capacity) {
+    size_t buckets = 1;
+    while (buckets * kWays < capacity) {
+        buckets <<= 1;
+    }
+    bucket_mask_ = buckets - 1;
+    slots_.assign(buckets * kWays, Slot{0, 0});
+}
+
+/**
+ * 判断键是否被记录为不存在
+ * @param key 缓存键
+ * @return 存在未过期的条目时返回true
+ */
+bool NegativeCache::contains(const std::string& key) {
+    uint64_t fingerprint = KeyHash::fingerprint(key);
+    Slot* bucket = &slots_[(fingerprint & bucket_mask_) * kWays];
+    int64_t now = CacheEntry::nowNanos();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < kWays; i++) {
+        if (bucket[i].fingerprint == fingerprint) {
+            return bucket[i].expires_at > now;
+        }
+    }
+    return false;
+}
+
+/**
+ * 记录键不存在
+ * 优先刷新同一指纹的条目，其次使用空条目或已过期的条目，桶满时替换最早过期的条目
+ * @param key 缓存键
+ * @param ttl 存活时间
+ */
+void NegativeCache::insert(const std::string& key, std::chrono::milliseconds ttl) {
+    uint64_t fingerprint = KeyHash::fingerprint(key);
+    Slot* bucket = &slots_[(fingerprint & bucket_mask_) * kWays];
+    int64_t now = CacheEntry::nowNanos();
+    int64_t expires_at = now + std::chrono::duration_cast<std::chrono::nanoseconds>(ttl).count();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    Slot* victim = &bucket[0];
+    for (size_t i = 0; i < kWays; i++) {
+        if (bucket[i].fingerprint == fingerprint) {
+            victim = &bucket[i];
+            break;
+        }
+        if (bucket[i].expires_at < victim->expires_at) {
+            victim = &bucket[i];
+        }
+    }
+    victim->fingerprint = fingerprint;
+    victim->expires_at = expires_at;
+}
+
+/**
+ * 删除键的记录
+ * @param key 缓存键
+ * @return 是否存在未过期的条目
+ */
+bool NegativeCache::erase(const std::string& key) {
+    uint64_t fingerprint = KeyHash::fingerprint(key);
+    Slot* bucket = &slots_[(fingerprint & bucket_mask_) * kWays];
+    int64_t now = CacheEntry::nowNanos();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < kWays; i++) {
+        if (bucket[i].fingerprint == fingerprint) {
+            bool live = bucket[i].expires_at > now;
+            bucket[i] = Slot{0, 0};
+            return live;
+        }
+    }
+    return false;
+}
\ No newline at end of file
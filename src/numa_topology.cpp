@@ -0,0 +1,140 @@
+#include "numa_topology.h"
+#include <dirent.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+
+/**
+ * 探测当前机器的拓扑
+ * 节点按系统编号排序，没有可用CPU的节点（例如只有内存的节点）被忽略
+ * @return 拓扑
+ */
+NumaTopology NumaTopology::detect() {
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        CPU_ZERO(&allowed);
+    }
+
+    std::vector<int> ids;
+    if (DIR* dir = opendir("/sys/devices/system/node")) {
+        while (dirent* entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            if (name.compare(0, 4, "node") == 0 && name.size() > 4 &&
+                std::all_of(name.begin() + 4, name.end(), ::isdigit)) {
+                ids.push_back(std::stoi(name.substr(4)));
+            }
+        }
+        closedir(dir);
+    }
+    std::sort(ids.begin(), ids.end());
+
+    NumaTopology topology;
+    for (int id : ids) {
+        std::ifstream file("/sys/devices/system/node/node" + std::to_string(id) + "/cpulist");
+        std::string text;
+        std::getline(file, text);
+        std::vector<int> cpus;
+        for (int cpu : parseCpuList(text)) {
+            if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed)) {
+                cpus.push_back(cpu);
+            }
+        }
+        if (!cpus.empty()) {
+            topology.cpus_.push_back(cpus);
+            topology.node_ids_.push_back(id);
+        }
+    }
+
+    // 不是NUMA机器或无法读取时，所有可用CPU属于同一个节点
+    if (topology.cpus_.empty()) {
+        std::vector<int> cpus;
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &allowed)) {
+                cpus.push_back(cpu);
+            }
+        }
+        if (cpus.empty()) {
+            cpus.push_back(0);
+        }
+        topology.cpus_.push_back(cpus);
+        topology.node_ids_.push_back(0);
+    }
+
+    for (size_t node = 0; node < topology.cpus_.size(); node++) {
+        for (int cpu : topology.cpus_[node]) {
+            if (topology.node_of_cpu_.size() <= static_cast<size_t>(cpu)) {
+                topology.node_of_cpu_.resize(cpu + 1, 0);
+            }
+            topology.node_of_cpu_[cpu] = node;
+        }
+    }
+    return topology;
+}
+
+/**
+ * CPU所在的节点
+ * @param cpu CPU编号
+ * @return 节点下标
+ */
+size_t NumaTopology::nodeOfCpu(int cpu) const {
+    return cpu >= 0 && static_cast<size_t>(cpu) < node_of_cpu_.size() ? node_of_cpu_[cpu] : 0;
+}
+
+/**
+ * 设置当前线程的内存策略为优先使用指定节点
+ * 直接调用set_mempolicy系统调用；策略只影响之后首次访问的页面，已分配的内存不会迁移
+ * @param node 节点下标
+ * @return 设置成功时返回true
+ */
+bool NumaTopology::preferMemory(size_t node) const {
+    const int kMpolPreferred = 1;   // 与<numaif.h>中的MPOL_PREFERRED相同
+    int id = node_ids_[node];
+    const size_t kBitsPerWord = sizeof(unsigned long) * 8;
+    std::vector<unsigned long> mask(id / kBitsPerWord + 1, 0);
+    mask[id / kBitsPerWord] |= 1UL << (id % kBitsPerWord);
+    return syscall(SYS_set_mempolicy, kMpolPreferred, mask.data(), mask.size() * kBitsPerWord + 1) == 0;
+}
+
+/**
+ * 设置一段内存的策略为优先使用指定节点
+ * 直接调用mbind系统调用；页面在首次访问时按该策略分配
+ * @param memory 内存的开头
+ * @param bytes 字节数
+ * @param node_id 系统中的节点编号
+ * @return 设置成功时返回true
+ */
+bool NumaTopology::preferMemory(void* memory, size_t bytes, int node_id) {
+    const int kMpolPreferred = 1;   // 与<numaif.h>中的MPOL_PREFERRED相同
+    const size_t kBitsPerWord = sizeof(unsigned long) * 8;
+    std::vector<unsigned long> mask(node_id / kBitsPerWord + 1, 0);
+    mask[node_id / kBitsPerWord] |= 1UL << (node_id % kBitsPerWord);
+    return syscall(SYS_mbind, memory, bytes, kMpolPreferred, mask.data(), mask.size() * kBitsPerWord + 1, 0) == 0;
+}
+
+/**
+ * 解析cpulist格式
+ * @param text 逗号分隔的CPU编号或闭区间，如"0-3,8-11"
+ * @return CPU编号列表
+ */
+std::vector<int> NumaTopology::parseCpuList(const std::string& text) {
+    std::vector<int> cpus;
+    std::stringstream stream(text);
+    std::string range;
+    while (std::getline(stream, range, ',')) {
+        if (range.empty() || !::isdigit(static_cast<unsigned char>(range[0]))) {
+            continue;
+        }
+        size_t dash = range.find('-');
+        int first = std::stoi(range.substr(0, dash));
+        int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+        for (int cpu = first; cpu <= last; cpu++) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
\ No newline at end of file
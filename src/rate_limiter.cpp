@@ -0,0 +1,77 @@
+#include "rate_limiter.h"
+#include "cache_entry.h"
+#include "key_hash.h"
+#include <algorithm>
+
+/**
+ * 限流器构造函数
+ * @param rate 每秒允许的请求数
+ * @param burst 允许的突发请求数，不大于0时等于rate
+ * @param capacity 最多同时跟踪的键数量
+ */
+RateLimiter::RateLimiter(int rate, int burst, size_t capacity) : rejected_(0) {
+    interval_ = 1000000000LL / std::max(rate, 1);
+    tolerance_ = interval_ * (std::max(burst > 0 ? burst : rate, 1) - 1);
+
+    size_t buckets = 1;
+    while (buckets * kWays < capacity) {
+        buckets <<= 1;
+    }
+    bucket_mask_ = buckets - 1;
+    buckets_.reset(new Bucket[buckets]);
+}
+
+/**
+ * 尝试放行一个请求
+ * 理论到达时间超前当前时间不超过tolerance_时放行，并把它推后一个interval_；
+ * 桶空闲时理论到达时间落后于当前时间，按当前时间计算，相当于令牌已经补满
+ * @param key 限流键
+ * @param retry_after 输出参数，拒绝时为令牌恢复所需的等待时间
+ * @return 令牌充足时返回true
+ */
+bool RateLimiter::allow(const std::string& key, std::chrono::nanoseconds& retry_after) {
+    Slot& slot = slotOf(KeyHash::fingerprint(key));
+    int64_t now = CacheEntry::nowNanos();
+
+    int64_t tat = slot.tat.load(std::memory_order_relaxed);
+    while (true) {
+        int64_t start = std::max(tat, now);
+        if (start - now > tolerance_) {
+            retry_after = std::chrono::nanoseconds(start - now - tolerance_);
+            rejected_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        // 失败时tat被更新为其他线程写入的值，重新判断
+        if (slot.tat.compare_exchange_weak(tat, start + interval_, std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+}
+
+/**
+ * 找到键对应的条目
+ * 优先使用同一指纹的条目，否则接管理论到达时间最早（最久空闲）的条目。
+ * 4个条目都在被限流时，被接管的条目的理论到达时间仍在将来，接管成功后清零，
+ * 新键从满桶开始而不是继承被挤出的键欠下的令牌。两个线程同时接管同一个条目时，
+ * 失败的一方沿用胜出者的条目，两个键短暂共用一个令牌桶
+ * @param fingerprint 键的指纹
+ * @return 条目
+ */
+RateLimiter::Slot& RateLimiter::slotOf(uint64_t fingerprint) {
+    Bucket& bucket = buckets_[fingerprint & bucket_mask_];
+    Slot* victim = &bucket.slots[0];
+    for (size_t i = 0; i < kWays; i++) {
+        Slot& slot = bucket.slots[i];
+        if (slot.fingerprint.load(std::memory_order_relaxed) == fingerprint) {
+            return slot;
+        }
+        if (slot.tat.load(std::memory_order_relaxed) < victim->tat.load(std::memory_order_relaxed)) {
+            victim = &slot;
+        }
+    }
+    uint64_t previous = victim->fingerprint.load(std::memory_order_relaxed);
+    if (victim->fingerprint.compare_exchange_strong(previous, fingerprint, std::memory_order_relaxed)) {
+        victim->tat.store(0, std::memory_order_relaxed);
+    }
+    return *victim;
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+#include "ttl_cache.h"
+
+/**
+ * TTL缓存构造函数
+ * @param capacity 最多保存的条目数量
+ */
+TtlCache::TtlCache(size_t capacity) : capacity_(capacity > 0 ? capacity : 1) {}
+
+/**
+ * 读取条目
+ * 命中时把条目移动到链表头部；条目已过期时顺便删除
+ * @param key 缓存键
+ * @param value 输出参数，存储读取到的值
+ * @return 条目存在且未过期时返回true
+ */
+bool TtlCache::get(const std::string& key, std::string& value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+        return false;
+    }
+
+    if (it->second->expires_at <= std::chrono::steady_clock::now()) {
+        lru_.erase(it->second);
+        index_.erase(it);
+        return false;
+    }
+
+    lru_.splice(lru_.begin(), lru_, it->second);
+    value = it->second->value;
+    return true;
+}
+
+/**
+ * 写入条目
+ * 已存在时覆盖值并刷新过期时间；容量已满时淘汰最久未使用的条目
+ * @param key 缓存键
+ * @param value 缓存值
+ * @param ttl 存活时间
+ */
+void TtlCache::put(const std::string& key, const std::string& value, std::chrono::milliseconds ttl) {
+    auto expires_at = std::chrono::steady_clock::now() + ttl;
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        it->second->value = value;
+        it->second->expires_at = expires_at;
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return;
+    }
+
+    if (index_.size() >= capacity_) {
+        index_.erase(lru_.back().key);
+        lru_.pop_back();
+    }
+
+    lru_.push_front({key, value, expires_at});
+    index_[key] = lru_.begin();
+}
+
+/**
+ * 删除条目
+ * @param key 缓存键
+ * @return 条目是否存在
+ */
+bool TtlCache::erase(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+        return false;
+    }
+    lru_.erase(it->second);
+    index_.erase(it);
+    return true;
+}
+
+/**
+ * 当前条目数量
+ * @return 条目数量
+ */
+size_t TtlCache::size() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return index_.size();
+}
\ No newline at end of file